@@ -0,0 +1,52 @@
+#ifndef BENCH_BENCHFILE_H
+#define BENCH_BENCHFILE_H
+
+#include <db/DbFile.h>
+#include <db/HeapPageId.h>
+#include <atomic>
+
+namespace bench {
+    /**
+     * Page that only carries its id, used to measure the BufferPool without any I/O.
+     */
+    class BenchPage : public db::Page {
+        db::HeapPageId pid;
+    public:
+        explicit BenchPage(const db::HeapPageId &pid) : pid(pid) {}
+
+        const db::PageId &getId() const override { return pid; }
+
+        void *getPageData() const override { return nullptr; }
+    };
+
+    /**
+     * DbFile of BenchPages that counts how many pages the BufferPool reads.
+     */
+    class BenchFile : public db::DbFile {
+        int id;
+        db::TupleDesc td;
+    public:
+        std::atomic<long> reads = 0;
+
+        BenchFile(int id, const db::TupleDesc &td) : id(id), td(td) {}
+
+        db::Page *readPage(const db::PageId &pid, uint8_t *frame) override {
+            reads++;
+            return new BenchPage({pid.getTableId(), pid.pageNumber()});
+        }
+
+        void writePage(db::Page *p) override {}
+
+        std::vector<db::PageGuard> insertTuple(db::TransactionId tid, db::Tuple &t) override { return {}; }
+
+        std::vector<db::PageGuard> deleteTuple(db::TransactionId tid, db::Tuple &t) override { return {}; }
+
+        int getId() const override { return id; }
+
+        const db::TupleDesc &getTupleDesc() const override { return td; }
+
+        int getNumPages() const override { return 0; }
+    };
+}
+
+#endif
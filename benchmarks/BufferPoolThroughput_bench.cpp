@@ -0,0 +1,58 @@
+#include "BenchFile.h"
+#include <db/Database.h>
+#include <db/Utility.h>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+/**
+ * Multi-threaded getPage throughput. Every thread looks up random pages of a table that is
+ * slightly larger than the buffer pool, so most lookups are hits and some are misses.
+ * Reports lookups per second for a single latch and for a sharded buffer pool.
+ */
+
+namespace {
+    constexpr int POOL_PAGES = 4096;
+    constexpr int TABLE_PAGES = 4608;
+    constexpr int LOOKUPS_PER_THREAD = 200000;
+
+    double run(int numShards, int numThreads) {
+        db::Database::reset();
+        db::Database::resetBufferPool(POOL_PAGES, db::BufferPool::DEFAULT_POLICY, numShards);
+        db::BufferPool &bufferpool = db::Database::getBufferPool();
+        bench::BenchFile file(1, db::Utility::getTupleDesc(2));
+        db::Database::getCatalog().addTable(&file);
+
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < numThreads; t++) {
+            threads.emplace_back([&bufferpool, t] {
+                std::mt19937 gen(t);
+                std::uniform_int_distribution<int> dist(0, TABLE_PAGES - 1);
+                for (int i = 0; i < LOOKUPS_PER_THREAD; i++) {
+                    db::HeapPageId pid(1, dist(gen));
+                    bufferpool.getPage(&pid);
+                }
+            });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return numThreads * LOOKUPS_PER_THREAD / seconds;
+    }
+}
+
+int main() {
+    std::printf("pool=%d pages, table=%d pages, %d lookups per thread, %u hardware threads\n",
+                POOL_PAGES, TABLE_PAGES, LOOKUPS_PER_THREAD, std::thread::hardware_concurrency());
+    std::printf("%8s %8s %16s\n", "shards", "threads", "lookups/s");
+    for (int numShards: {1, 16}) {
+        for (int numThreads: {1, 2, 4, 8}) {
+            std::printf("%8d %8d %16.0f\n", numShards, numThreads, run(numShards, numThreads));
+        }
+    }
+    return 0;
+}
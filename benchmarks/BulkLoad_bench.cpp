@@ -0,0 +1,113 @@
+#include <db/BulkLoader.h>
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/IntField.h>
+#include <db/Utility.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Load rate of a table of three int fields, the schema of table.dat, with the BulkLoader
+ * from CSV and binary input, with BufferPool::insertTuple row by row, and the rate of a plain
+ * sequential write and fsync of as many pages for reference. Rates count the bytes of the
+ * pages written to the table.
+ */
+
+namespace {
+    constexpr long ROWS = 8000000;
+    constexpr long INSERT_ROWS = 500000;
+    const char *TABLE = "bulkload_bench.dat";
+
+    double seconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void removeTable() {
+        std::remove(TABLE);
+        std::remove((std::string(TABLE) + ".fsm").c_str());
+    }
+
+    void report(const char *method, long rows, int pages, double elapsed) {
+        double bytes = static_cast<double>(pages) * db::Database::getBufferPool().getPageSize();
+        printf("%-18s %10ld %8d %10.2f %12.0f %10.1f\n", method, rows, pages, elapsed, rows / elapsed,
+               bytes / elapsed / 1e6);
+    }
+
+    db::BulkLoadStats bulkLoad(const db::TupleDesc &td, const std::string &input, db::BulkFormat format) {
+        removeTable();
+        db::Database::reset();
+        db::HeapFile file(TABLE, td);
+        db::Database::getCatalog().addTable(&file);
+        db::BulkLoader loader(file, format);
+        return loader.load(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+    }
+}
+
+int main() {
+    db::TupleDesc td = db::Utility::getTupleDesc(3);
+    std::string csv;
+    std::string binary;
+    binary.reserve(ROWS * td.getSize());
+    for (long i = 0; i < ROWS; i++) {
+        int values[3] = {static_cast<int>(i), rand(), rand() % 1000};
+        csv += std::to_string(values[0]) + "," + std::to_string(values[1]) + "," + std::to_string(values[2]) + "\n";
+        binary.append(reinterpret_cast<const char *>(values), sizeof(values));
+    }
+    printf("%ld rows, csv %.0f MB, binary %.0f MB, %u threads\n", ROWS, csv.size() / 1e6, binary.size() / 1e6,
+           std::thread::hardware_concurrency());
+    printf("%-18s %10s %8s %10s %12s %10s\n", "method", "rows", "pages", "seconds", "rows/s", "MB/s");
+
+    auto start = std::chrono::steady_clock::now();
+    db::BulkLoadStats stats = bulkLoad(td, csv, db::BulkFormat::CSV);
+    report("bulk csv", stats.rows, stats.pages, seconds(start));
+
+    start = std::chrono::steady_clock::now();
+    stats = bulkLoad(td, binary, db::BulkFormat::BINARY);
+    report("bulk binary", stats.rows, stats.pages, seconds(start));
+
+    // the same pages written as is
+    int pages = stats.pages;
+    std::vector<uint8_t> page(db::Database::getBufferPool().getPageSize(), 0xFF);
+    removeTable();
+    start = std::chrono::steady_clock::now();
+    int fd = open(TABLE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    for (int i = 0; i < pages; i += 1024) {
+        std::vector<uint8_t> run(page.size() * std::min(1024, pages - i), 0xFF);
+        if (write(fd, run.data(), run.size()) != static_cast<ssize_t>(run.size())) {
+            perror("write");
+            return 1;
+        }
+    }
+    fsync(fd);
+    close(fd);
+    report("sequential write", ROWS, pages, seconds(start));
+
+    removeTable();
+    db::Database::reset();
+    db::HeapFile file(TABLE, td);
+    db::Database::getCatalog().addTable(&file);
+    db::BufferPool &bufferPool = db::Database::getBufferPool();
+    db::Tuple tuple(td);
+    start = std::chrono::steady_clock::now();
+    for (long i = 0; i < INSERT_ROWS;) {
+        db::TransactionId tid;
+        for (long end = i + 10000; i < end; i++) {
+            for (int f = 0; f < 3; f++) {
+                tuple.setField(f, new db::IntField(static_cast<int>(i)));
+            }
+            bufferPool.insertTuple(tid, file.getId(), &tuple);
+        }
+        bufferPool.transactionComplete(tid);
+    }
+    file.sync();
+    report("insertTuple", INSERT_ROWS, file.getNumPages(), seconds(start));
+    removeTable();
+    return 0;
+}
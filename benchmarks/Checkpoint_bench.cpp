@@ -0,0 +1,118 @@
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/HeapPageId.h>
+#include <db/Utility.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <random>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Latency of foreground lookups while the dirty pages of the pool are written, by
+ * flushAllPages and by an incremental checkpoint. Half of the pool is dirty; the foreground
+ * thread reads random pages of a second table larger than the pool, so most lookups are
+ * misses, which need the exclusive latch of their shard.
+ */
+
+namespace {
+    constexpr int POOL_PAGES = 4096;
+    constexpr int DIRTY_PAGES = 2048;
+    constexpr int READ_PAGES = 16384;
+    const char *DIRTY_FILE = "checkpoint_bench_dirty.dat";
+    const char *READ_FILE = "checkpoint_bench_read.dat";
+    const char *LOG_FILE = "checkpoint_bench.log";
+
+    void createFile(const char *name, int numPages) {
+        int fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        std::vector<char> page(db::Database::getBufferPool().getPageSize(), 0);
+        for (int i = 0; i < numPages; i++) {
+            if (write(fd, page.data(), page.size()) != static_cast<ssize_t>(page.size())) {
+                perror("write");
+                exit(1);
+            }
+        }
+        fsync(fd);
+        close(fd);
+    }
+
+    struct Result {
+        double writeMs;
+        long lookups;
+        double p50Us;
+        double p99Us;
+        double maxUs;
+    };
+
+    Result run(bool incremental) {
+        db::Database::reset();
+        db::Database::resetBufferPool(POOL_PAGES);
+        unlink(LOG_FILE);
+        db::TupleDesc td = db::Utility::getTupleDesc(2);
+        db::HeapFile dirtyFile(DIRTY_FILE, td);
+        db::HeapFile readFile(READ_FILE, td);
+        db::Database::getCatalog().addTable(&dirtyFile);
+        db::Database::getCatalog().addTable(&readFile);
+        db::BufferPool &bufferPool = db::Database::getBufferPool();
+        bufferPool.openLog(LOG_FILE);
+
+        db::TransactionId tid;
+        for (int i = 0; i < DIRTY_PAGES; i++) {
+            db::HeapPageId pid(dirtyFile.getId(), i);
+            bufferPool.getPage(tid, &pid, db::Permissions::READ_WRITE)->markDirty(tid);
+        }
+        bufferPool.transactionComplete(tid);
+
+        std::atomic<bool> writing{true};
+        std::vector<double> latencies;
+        std::thread foreground([&] {
+            std::mt19937 gen(42);
+            std::uniform_int_distribution<int> dist(0, READ_PAGES - 1);
+            while (writing.load(std::memory_order_relaxed)) {
+                db::HeapPageId pid(readFile.getId(), dist(gen));
+                auto start = std::chrono::steady_clock::now();
+                bufferPool.getPage(&pid);
+                latencies.push_back(
+                        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            }
+        });
+        auto start = std::chrono::steady_clock::now();
+        if (incremental) {
+            bufferPool.getCheckpointer().setDuration(1000);
+            bufferPool.getCheckpointer().checkpoint();
+        } else {
+            bufferPool.flushAllPages();
+            dirtyFile.sync();
+        }
+        double writeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        writing = false;
+        foreground.join();
+
+        std::sort(latencies.begin(), latencies.end());
+        Result result{writeMs, static_cast<long>(latencies.size()), latencies[latencies.size() / 2],
+                      latencies[latencies.size() * 99 / 100], latencies.back()};
+        db::Database::reset();
+        return result;
+    }
+}
+
+int main() {
+    createFile(DIRTY_FILE, DIRTY_PAGES);
+    createFile(READ_FILE, READ_PAGES);
+    printf("pool=%d pages, %d dirty, foreground reads a %d page table\n", POOL_PAGES, DIRTY_PAGES, READ_PAGES);
+    printf("%-14s %10s %10s %10s %10s %10s\n", "writer", "write ms", "lookups", "p50 us", "p99 us", "max us");
+    for (bool incremental: {false, true}) {
+        Result result = run(incremental);
+        printf("%-14s %10.1f %10ld %10.1f %10.1f %10.1f\n", incremental ? "checkpoint" : "flushAllPages",
+               result.writeMs, result.lookups, result.p50Us, result.p99Us, result.maxUs);
+    }
+    unlink(DIRTY_FILE);
+    unlink(READ_FILE);
+    unlink(LOG_FILE);
+    return 0;
+}
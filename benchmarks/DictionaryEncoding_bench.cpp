@@ -0,0 +1,221 @@
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/IntField.h>
+#include <db/PaxFile.h>
+#include <db/SeqScan.h>
+#include <db/StringField.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Size and query speed of a table (id int, country string, amount int) whose countries
+ * follow a Zipf distribution over NAMES values, stored in a HeapFile, in a PaxFile with
+ * inline strings and in a PaxFile with a StringDictionary. The queries run over pinned
+ * pages with the page accessors:
+ *   filter: SELECT COUNT(*) WHERE country = 'Peru'
+ *   group:  SELECT country, SUM(amount) GROUP BY country
+ * The dictionary file compares and groups the codes, the others the strings. A cold
+ * SeqScan of each file, which decodes every tuple, is timed as well.
+ */
+
+namespace {
+    constexpr int POOL_PAGES = 16384;
+    constexpr int ROWS = 200000;
+    constexpr int TXN_ROWS = 10000;
+    constexpr int NAMES = 40;
+    constexpr int RUNS = 5;
+    const char *NEEDLE = "Peru";
+
+    const char *COUNTRIES[NAMES] = {
+            "China", "India", "United States", "Indonesia", "Pakistan", "Nigeria", "Brazil", "Bangladesh",
+            "Russia", "Mexico", "Japan", "Ethiopia", "Philippines", "Egypt", "Vietnam", "Congo", "Turkey", "Iran",
+            "Germany", "Thailand", "United Kingdom", "France", "Tanzania", "South Africa", "Italy", "Kenya",
+            "Myanmar", "Colombia", "South Korea", "Uganda", "Sudan", "Spain", "Algeria", "Argentina", "Iraq",
+            "Afghanistan", "Poland", "Canada", "Morocco", "Peru"};
+
+    struct Result {
+        long count = 0;
+        long sum = 0;
+    };
+
+    template<typename File>
+    void load(File &file, const db::TupleDesc &td) {
+        std::vector<double> weights;
+        for (int i = 0; i < NAMES; i++) {
+            weights.push_back(1.0 / (i + 1));
+        }
+        std::mt19937 rng(42);
+        std::discrete_distribution<int> zipf(weights.begin(), weights.end());
+        db::BufferPool &bufferPool = db::Database::getBufferPool();
+        for (int row = 0; row < ROWS;) {
+            db::TransactionId tid;
+            for (int end = row + TXN_ROWS; row < end; row++) {
+                db::Tuple tuple(td);
+                tuple.setField(0, new db::IntField(row));
+                tuple.setField(1, new db::StringField(COUNTRIES[zipf(rng)]));
+                tuple.setField(2, new db::IntField(row % 100));
+                bufferPool.insertTuple(tid, file.getId(), &tuple);
+            }
+            bufferPool.transactionComplete(tid);
+        }
+        bufferPool.flushAllPages();
+    }
+
+    template<typename Page>
+    std::vector<db::PageGuard> fetchAll(const db::DbFile &file, std::vector<const Page *> &pages) {
+        std::vector<db::PageGuard> guards;
+        for (int p = 0; p < file.getNumPages(); p++) {
+            db::HeapPageId pid(file.getId(), p);
+            guards.push_back(db::Database::getBufferPool().fetchPage(&pid));
+            pages.push_back(guards.back().as<Page>());
+        }
+        return guards;
+    }
+
+    template<typename Page>
+    Result filterStrings(const std::vector<const Page *> &pages) {
+        Result result;
+        for (const Page *page: pages) {
+            for (auto it = page->begin(); it != page->end(); ++it) {
+                result.count += page->getString(it.getSlot(), 1) == NEEDLE;
+            }
+        }
+        return result;
+    }
+
+    template<typename Page>
+    Result groupStrings(const std::vector<const Page *> &pages) {
+        std::unordered_map<std::string_view, long> sums;
+        for (const Page *page: pages) {
+            for (auto it = page->begin(); it != page->end(); ++it) {
+                sums[page->getString(it.getSlot(), 1)] += page->getInt(it.getSlot(), 2);
+            }
+        }
+        Result result;
+        for (const auto &[country, sum]: sums) {
+            result.count++;
+            result.sum += sum;
+        }
+        return result;
+    }
+
+    Result filterCodes(const db::PaxFile &file, const std::vector<const db::PaxPage *> &pages) {
+        Result result;
+        // the constant is translated once, an unknown string matches nothing
+        int needle = file.getDictionary()->find(NEEDLE).value_or(-1);
+        for (const db::PaxPage *page: pages) {
+            const int *codes = page->getCodeColumn(1);
+            for (int slot = 0; slot < page->getNumSlots(); slot++) {
+                result.count += codes[slot] == needle;
+            }
+        }
+        return result;
+    }
+
+    Result groupCodes(const db::PaxFile &file, const std::vector<const db::PaxPage *> &pages) {
+        // codes are dense, the groups are an array; empty slots add 0 to group 0
+        std::vector<long> sums(file.getDictionary()->size() + 1);
+        for (const db::PaxPage *page: pages) {
+            const int *codes = page->getCodeColumn(1);
+            const int *amounts = page->getIntColumn(2);
+            for (int slot = 0; slot < page->getNumSlots(); slot++) {
+                sums[codes[slot]] += amounts[slot];
+            }
+        }
+        Result result;
+        for (size_t code = 1; code < sums.size(); code++) {
+            result.count++;
+            result.sum += sums[code];
+        }
+        return result;
+    }
+
+    Result coldScan(int tableId) {
+        db::Database::resetBufferPool(POOL_PAGES);
+        Result result;
+        db::SeqScan scan(tableId);
+        scan.open();
+        while (scan.hasNext()) {
+            result.count++;
+            result.sum += dynamic_cast<const db::IntField &>(scan.next().getField(2)).getValue();
+        }
+        return result;
+    }
+
+    void report(const char *name, const char *query, const std::function<Result()> &run) {
+        double best = 1e300;
+        Result result;
+        for (int i = 0; i < RUNS; i++) {
+            auto start = std::chrono::steady_clock::now();
+            result = run();
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                    .count());
+        }
+        printf("%-12s %-8s %10.2f %10ld %12ld\n", name, query, best, result.count, result.sum);
+    }
+
+    void removeFiles(const char *name) {
+        for (const char *suffix: {"", ".fsm", ".dict"}) {
+            std::remove((std::string(name) + suffix).c_str());
+        }
+    }
+}
+
+int main() {
+    const char *heapName = "dictionary_bench_heap.dat";
+    const char *inlineName = "dictionary_bench_inline.dat";
+    const char *dictName = "dictionary_bench_dict.dat";
+    for (const char *name: {heapName, inlineName, dictName}) {
+        removeFiles(name);
+    }
+    db::Database::resetBufferPool(POOL_PAGES);
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE, db::Types::INT_TYPE});
+    db::HeapFile heapFile(heapName, td);
+    db::PaxFile inlineFile(inlineName, td);
+    db::PaxFile dictFile(dictName, td, db::StringEncoding::DICTIONARY);
+    db::Database::getCatalog().addTable(&heapFile, "heap");
+    db::Database::getCatalog().addTable(&inlineFile, "inline");
+    db::Database::getCatalog().addTable(&dictFile, "dict");
+    load(heapFile, td);
+    load(inlineFile, td);
+    load(dictFile, td);
+
+    auto pageSize = static_cast<double>(db::Database::getBufferPool().getPageSize());
+    printf("%d rows, %d countries (Zipf)\n", ROWS, NAMES);
+    printf("%-12s %8s %10s\n", "file", "pages", "MiB");
+    printf("%-12s %8d %10.2f\n", "heap", heapFile.getNumPages(), heapFile.getNumPages() * pageSize / (1 << 20));
+    printf("%-12s %8d %10.2f\n", "pax inline", inlineFile.getNumPages(),
+           inlineFile.getNumPages() * pageSize / (1 << 20));
+    printf("%-12s %8d %10.2f (+%d strings)\n", "pax dict", dictFile.getNumPages(),
+           dictFile.getNumPages() * pageSize / (1 << 20), dictFile.getDictionary()->size());
+
+    printf("%-12s %-8s %10s %10s %12s\n", "file", "query", "ms", "count", "sum");
+    {
+        std::vector<const db::HeapPage *> heapPages;
+        std::vector<const db::PaxPage *> inlinePages;
+        std::vector<const db::PaxPage *> dictPages;
+        std::vector<db::PageGuard> heapGuards = fetchAll(heapFile, heapPages);
+        std::vector<db::PageGuard> inlineGuards = fetchAll(inlineFile, inlinePages);
+        std::vector<db::PageGuard> dictGuards = fetchAll(dictFile, dictPages);
+        report("heap", "filter", [&] { return filterStrings(heapPages); });
+        report("pax inline", "filter", [&] { return filterStrings(inlinePages); });
+        report("pax dict", "filter", [&] { return filterCodes(dictFile, dictPages); });
+        report("heap", "group", [&] { return groupStrings(heapPages); });
+        report("pax inline", "group", [&] { return groupStrings(inlinePages); });
+        report("pax dict", "group", [&] { return groupCodes(dictFile, dictPages); });
+    }
+    report("heap", "scan", [&] { return coldScan(heapFile.getId()); });
+    report("pax inline", "scan", [&] { return coldScan(inlineFile.getId()); });
+    report("pax dict", "scan", [&] { return coldScan(dictFile.getId()); });
+    for (const char *name: {heapName, inlineName, dictName}) {
+        removeFiles(name);
+    }
+    return 0;
+}
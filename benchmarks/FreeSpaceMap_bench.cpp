@@ -0,0 +1,57 @@
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/IntField.h>
+#include <db/Utility.h>
+#include <chrono>
+#include <cstdio>
+
+/**
+ * Insert throughput of a HeapFile as the table grows. Tuples are inserted in transactions
+ * of TXN_ROWS rows into a table that starts empty and ends 8 times larger than the buffer
+ * pool; the rate of every interval of REPORT_ROWS rows is printed. With the free space map
+ * an insert probes the page it is given, so the rate does not depend on the table size.
+ */
+
+namespace {
+    constexpr int POOL_PAGES = 512;
+    constexpr long TOTAL_ROWS = 2000000;
+    constexpr long REPORT_ROWS = 250000;
+    constexpr long TXN_ROWS = 10000;
+    const char *FILE_NAME = "freespacemap_bench.dat";
+}
+
+int main() {
+    std::remove(FILE_NAME);
+    std::remove((std::string(FILE_NAME) + ".fsm").c_str());
+    db::Database::resetBufferPool(POOL_PAGES);
+    db::BufferPool &bufferPool = db::Database::getBufferPool();
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    db::HeapFile file(FILE_NAME, td);
+    db::Database::getCatalog().addTable(&file);
+
+    printf("pool=%d pages, %ld rows in transactions of %ld\n", POOL_PAGES, TOTAL_ROWS, TXN_ROWS);
+    printf("%10s %8s %12s %8s\n", "rows", "pages", "rows/s", "misses");
+    auto start = std::chrono::steady_clock::now();
+    uint64_t misses = 0;
+    db::Tuple tuple(td);
+    for (long row = 0; row < TOTAL_ROWS;) {
+        db::TransactionId tid;
+        for (long end = row + TXN_ROWS; row < end; row++) {
+            tuple.setField(0, new db::IntField(static_cast<int>(row)));
+            tuple.setField(1, new db::IntField(0));
+            bufferPool.insertTuple(tid, file.getId(), &tuple);
+        }
+        bufferPool.transactionComplete(tid);
+        if (row % REPORT_ROWS == 0) {
+            auto now = std::chrono::steady_clock::now();
+            uint64_t total = bufferPool.getStats().getTableStats(file.getId()).misses;
+            printf("%10ld %8d %12.0f %8lu\n", row, file.getNumPages(),
+                   REPORT_ROWS / std::chrono::duration<double>(now - start).count(),
+                   static_cast<unsigned long>(total - misses));
+            start = now;
+            misses = total;
+        }
+    }
+    std::remove(FILE_NAME);
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/IntField.h>
+#include <db/Utility.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Commit throughput and latency with a write-ahead log, as the number of committing threads
+ * grows. Every thread runs small transactions, one insert and a commit, into its own table
+ * so they never wait for each other's locks, only for the log. Each configuration is run with
+ * the leader of a group syncing right away and with it waiting for more committers.
+ */
+
+namespace {
+    constexpr int TRANSACTIONS = 200;
+    const char *LOG_NAME = "group_commit_bench.log";
+
+    std::string fileName(int i) {
+        return "group_commit_bench" + std::to_string(i) + ".dat";
+    }
+
+    struct Result {
+        double commitsPerSecond;
+        double p99Us;
+        double commitsPerSync;
+    };
+
+    Result run(int numThreads, std::chrono::microseconds maxWait) {
+        db::Database::reset();
+        unlink(LOG_NAME);
+        db::TupleDesc td = db::Utility::getTupleDesc(2);
+        std::vector<std::unique_ptr<db::HeapFile>> files;
+        for (int i = 0; i < numThreads; i++) {
+            std::ofstream(fileName(i), std::ios::trunc);
+            files.push_back(std::make_unique<db::HeapFile>(fileName(i).c_str(), td));
+            db::Database::getCatalog().addTable(files.back().get());
+        }
+        db::BufferPool &bufferPool = db::Database::getBufferPool();
+        bufferPool.openLog(LOG_NAME);
+        bufferPool.getLog()->setGroupCommit(maxWait, numThreads);
+
+        std::vector<std::vector<double>> latencies(numThreads);
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numThreads; i++) {
+            threads.emplace_back([&, i] {
+                for (int j = 0; j < TRANSACTIONS; j++) {
+                    db::TransactionId tid;
+                    db::Tuple tuple(td);
+                    tuple.setField(0, new db::IntField(j));
+                    tuple.setField(1, new db::IntField(i));
+                    bufferPool.insertTuple(tid, files[i]->getId(), &tuple);
+                    auto commitStart = std::chrono::steady_clock::now();
+                    bufferPool.transactionComplete(tid);
+                    latencies[i].push_back(std::chrono::duration<double, std::micro>(
+                            std::chrono::steady_clock::now() - commitStart).count());
+                }
+            });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<double> all;
+        for (const auto &threadLatencies: latencies) {
+            all.insert(all.end(), threadLatencies.begin(), threadLatencies.end());
+        }
+        std::sort(all.begin(), all.end());
+        db::LogStats stats = bufferPool.getLog()->getStats();
+        Result result{static_cast<double>(all.size()) / seconds, all[all.size() * 99 / 100],
+                      static_cast<double>(stats.commits) / static_cast<double>(std::max(stats.syncs, 1L))};
+        db::Database::reset();
+        for (int i = 0; i < numThreads; i++) {
+            unlink(fileName(i).c_str());
+        }
+        unlink(LOG_NAME);
+        return result;
+    }
+}
+
+int main() {
+    printf("%d transactions per thread, one insert each\n", TRANSACTIONS);
+    printf("%-8s %-8s %12s %12s %14s\n", "threads", "wait us", "commits/s", "p99 us", "commits/sync");
+    for (int waitUs: {0, 200}) {
+        for (int numThreads: {1, 2, 4, 8, 16}) {
+            Result result = run(numThreads, std::chrono::microseconds(waitUs));
+            printf("%-8d %-8d %12.0f %12.1f %14.2f\n", numThreads, waitUs, result.commitsPerSecond, result.p99Us,
+                   result.commitsPerSync);
+        }
+    }
+    return 0;
+}
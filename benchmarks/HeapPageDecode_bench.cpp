@@ -0,0 +1,108 @@
+#include <db/Database.h>
+#include <db/HeapPage.h>
+#include <db/IntField.h>
+#include <db/SkeletonFile.h>
+#include <db/Utility.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+/**
+ * Cost of reading a HeapPage: creating the page from its image, then reading every tuple
+ * either decoded into Fields by the iterator or through the typed accessors. Pages are full
+ * of tuples of 2 and of 10 int columns. Allocations are counted by replacing operator new.
+ */
+
+namespace {
+    std::atomic<long> allocations{0};
+    constexpr int PAGES = 2000;
+
+    struct Result {
+        double loadUs;
+        double scanNs;
+        double allocsPerTuple;
+    };
+
+    /**
+     * @param mode 0: load only, 1: decode every tuple, 2: read column 0 with the accessor
+     */
+    Result run(int numFields, int mode) {
+        db::Database::reset();
+        db::TupleDesc td = db::Utility::getTupleDesc(numFields);
+        db::SkeletonFile file(1, td);
+        db::Database::getCatalog().addTable(&file);
+        std::vector<uint8_t> image(db::Database::getBufferPool().getPageSize());
+        for (size_t i = 0; i < image.size(); i++) {
+            image[i] = static_cast<uint8_t>(i * 31);
+        }
+        db::HeapPageId pid(1, 0);
+        {
+            // set every slot used
+            db::HeapPage probe(pid, image.data());
+            memset(image.data(), 0xFF, probe.getHeaderSize());
+        }
+
+        long tuples = 0;
+        long sum = 0;
+        double loadNs = 0;
+        long before = allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        for (int p = 0; p < PAGES; p++) {
+            auto loadStart = std::chrono::steady_clock::now();
+            db::HeapPage page(pid, image.data());
+            loadNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - loadStart).count();
+            if (mode == 0) {
+                continue;
+            }
+            for (auto it = page.begin(); it != page.end(); ++it) {
+                if (mode == 1) {
+                    sum += static_cast<const db::IntField &>((*it).getField(0)).getValue();
+                } else {
+                    sum += page.getInt(it.getSlot(), 0);
+                }
+                tuples++;
+            }
+        }
+        double totalNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        long allocs = allocations.load() - before;
+        if (sum == 42) {
+            printf("\n");
+        }
+        db::Database::reset();
+        return {loadNs / PAGES / 1000, tuples ? totalNs / tuples : 0,
+                tuples ? static_cast<double>(allocs) / tuples : static_cast<double>(allocs) / PAGES};
+    }
+}
+
+void *operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+int main() {
+    printf("%d pages of %d bytes per run\n", PAGES, db::Database::getBufferPool().getPageSize());
+    printf("%-8s %-10s %12s %14s %16s\n", "columns", "read", "load us", "ns/tuple", "allocs/tuple");
+    for (int numFields: {2, 10}) {
+        for (auto [name, mode]: {std::pair{"load", 0}, std::pair{"decode", 1}, std::pair{"accessor", 2}}) {
+            Result result = run(numFields, mode);
+            printf("%-8d %-10s %12.2f %14.1f %16.2f\n", numFields, name, result.loadUs, result.scanNs,
+                   result.allocsPerTuple);
+        }
+    }
+    return 0;
+}
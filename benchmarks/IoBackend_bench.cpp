@@ -0,0 +1,83 @@
+#include <db/IoBackend.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <numeric>
+#include <random>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Read IOPS of the I/O backends: every page of a 64 MiB file is read once, in file order
+ * and in random order. The POSIX backend reads one page at a time through the page cache,
+ * which is dropped before every run; the io_uring backend reads batches of QUEUE_DEPTH
+ * pages with O_DIRECT.
+ */
+
+namespace {
+    constexpr size_t PAGE_SIZE = 4096;
+    constexpr size_t NUM_PAGES = 16384;
+    constexpr size_t BATCH = db::UringIoBackend::QUEUE_DEPTH;
+    const char *FILE_NAME = "iobackend_bench.dat";
+
+    void createFile() {
+        int fd = open(FILE_NAME, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        std::vector<char> page(PAGE_SIZE, 1);
+        for (size_t i = 0; i < NUM_PAGES; i++) {
+            if (write(fd, page.data(), PAGE_SIZE) != PAGE_SIZE) {
+                perror("write");
+                exit(1);
+            }
+        }
+        fsync(fd);
+        close(fd);
+    }
+
+    double run(db::IoBackendType type, const std::vector<size_t> &order) {
+        auto backend = db::IoBackend::create(type);
+        int fd = open(FILE_NAME, O_RDONLY | backend->getOpenFlags());
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        auto *buffers = static_cast<uint8_t *>(std::aligned_alloc(PAGE_SIZE, BATCH * PAGE_SIZE));
+        size_t bytes = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t first = 0; first < order.size(); first += BATCH) {
+            std::vector<db::IoRequest> requests;
+            for (size_t i = first; i < std::min(first + BATCH, order.size()); i++) {
+                requests.push_back({buffers + (i - first) * PAGE_SIZE, PAGE_SIZE,
+                                    static_cast<off_t>(order[i] * PAGE_SIZE),
+                                    [&bytes](ssize_t n) { bytes += n > 0 ? n : 0; }});
+            }
+            backend->readBatch(fd, requests);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (bytes != order.size() * PAGE_SIZE) {
+            fprintf(stderr, "short read: %zu bytes\n", bytes);
+        }
+        std::free(buffers);
+        close(fd);
+        return order.size() / seconds;
+    }
+}
+
+int main() {
+    createFile();
+    std::vector<size_t> sequential(NUM_PAGES);
+    std::iota(sequential.begin(), sequential.end(), 0);
+    std::vector<size_t> random = sequential;
+    std::shuffle(random.begin(), random.end(), std::mt19937(42));
+
+    bool uring = dynamic_cast<db::UringIoBackend *>(db::IoBackend::create(db::IoBackendType::IO_URING).get());
+    printf("%zu pages of %zu bytes, io_uring batches of %zu%s\n", NUM_PAGES, PAGE_SIZE, BATCH,
+           uring ? "" : " (io_uring unavailable, POSIX fallback)");
+    printf("%-10s %15s %15s\n", "backend", "sequential IOPS", "random IOPS");
+    printf("%-10s %15.0f %15.0f\n", "pread", run(db::IoBackendType::POSIX, sequential),
+           run(db::IoBackendType::POSIX, random));
+    printf("%-10s %15.0f %15.0f\n", "io_uring", run(db::IoBackendType::IO_URING, sequential),
+           run(db::IoBackendType::IO_URING, random));
+    unlink(FILE_NAME);
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/Utility.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Startup and full-scan latency of a HeapFile read with pread and through a mapping. The
+ * table is 32 times larger than the buffer pool, so every page of the scan is a miss. Startup
+ * is the time from opening the file to the first tuple. Each mode is measured with the page
+ * cache dropped for the file (cold) and with the file already cached (warm).
+ */
+
+namespace {
+    constexpr int POOL_PAGES = 1024;
+    constexpr int TABLE_PAGES = 32768;
+    const char *FILE_NAME = "mmap_heapfile_bench.dat";
+
+    void createFile() {
+        int fd = open(FILE_NAME, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        // eight tuples per page
+        std::vector<char> page(db::Database::getBufferPool().getPageSize(), 0);
+        page[0] = static_cast<char>(0xFF);
+        for (int i = 0; i < TABLE_PAGES; i++) {
+            if (write(fd, page.data(), page.size()) != static_cast<ssize_t>(page.size())) {
+                perror("write");
+                exit(1);
+            }
+        }
+        fsync(fd);
+        close(fd);
+    }
+
+    void dropCache() {
+        int fd = open(FILE_NAME, O_RDONLY);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+
+    struct Latency {
+        double startup;
+        double scan;
+    };
+
+    Latency run(db::IoBackendType type, bool cold) {
+        db::Database::reset();
+        db::Database::resetBufferPool(POOL_PAGES);
+        db::TupleDesc td = db::Utility::getTupleDesc(2);
+        if (cold) {
+            dropCache();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        db::HeapFile file(FILE_NAME, td, type);
+        db::Database::getCatalog().addTable(&file);
+        auto it = file.begin();
+        auto first = std::chrono::steady_clock::now();
+        long tuples = 0;
+        for (auto end = file.end(); it != end; ++it) {
+            tuples++;
+        }
+        auto done = std::chrono::steady_clock::now();
+
+        if (tuples != 8L * TABLE_PAGES) {
+            fprintf(stderr, "scanned %ld tuples\n", tuples);
+        }
+        db::Database::reset();
+        return {std::chrono::duration<double, std::milli>(first - start).count(),
+                std::chrono::duration<double, std::milli>(done - start).count()};
+    }
+}
+
+int main() {
+    createFile();
+    printf("pool=%d pages, table=%d pages of %d bytes\n", POOL_PAGES, TABLE_PAGES, db::Database::getBufferPool().getPageSize());
+    printf("%-6s %-5s %12s %12s\n", "mode", "cache", "startup ms", "scan ms");
+    for (bool cold: {true, false}) {
+        for (auto [name, type]: {std::pair{"pread", db::IoBackendType::POSIX},
+                                 std::pair{"mmap", db::IoBackendType::MMAP}}) {
+            Latency latency = run(type, cold);
+            printf("%-6s %-5s %12.3f %12.1f\n", name, cold ? "cold" : "warm", latency.startup, latency.scan);
+        }
+    }
+    unlink(FILE_NAME);
+    return 0;
+}
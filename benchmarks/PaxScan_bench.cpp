@@ -0,0 +1,155 @@
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/IntField.h>
+#include <db/PaxFile.h>
+#include <db/SeqScan.h>
+#include <db/Utility.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Scan of one int field of a table of 10 int fields, stored in a HeapFile and in a PaxFile:
+ * SELECT COUNT(*), SUM(f3) WHERE f3 > THRESHOLD, with the whole table resident. Each layout
+ * is read through a SeqScan, which decodes every tuple, and through the page accessors of
+ * pinned pages: the typed accessor of a HeapPage strides over whole tuples, the minipage of
+ * a PaxPage is a contiguous array.
+ */
+
+namespace {
+    constexpr int POOL_PAGES = 8192;
+    constexpr int ROWS = 300000;
+    constexpr int TXN_ROWS = 10000;
+    constexpr int FIELDS = 10;
+    constexpr int FIELD = 3;
+    constexpr int THRESHOLD = 500;
+    constexpr int RUNS = 5;
+
+    struct Result {
+        long count = 0;
+        long sum = 0;
+    };
+
+    template<typename File>
+    void load(File &file, const db::TupleDesc &td) {
+        db::BufferPool &bufferPool = db::Database::getBufferPool();
+        for (int row = 0; row < ROWS;) {
+            db::TransactionId tid;
+            for (int end = row + TXN_ROWS; row < end; row++) {
+                db::Tuple tuple(td);
+                for (int i = 0; i < FIELDS; i++) {
+                    tuple.setField(i, new db::IntField((row + i) % 1000));
+                }
+                bufferPool.insertTuple(tid, file.getId(), &tuple);
+            }
+            bufferPool.transactionComplete(tid);
+        }
+    }
+
+    Result seqScan(int tableId) {
+        Result result;
+        db::SeqScan scan(tableId);
+        scan.open();
+        while (scan.hasNext()) {
+            int value = dynamic_cast<const db::IntField &>(scan.next().getField(FIELD)).getValue();
+            if (value > THRESHOLD) {
+                result.count++;
+                result.sum += value;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @return the pages of file, pinned, so the accessor scans only measure the pages themselves
+     */
+    template<typename Page>
+    std::vector<db::PageGuard> fetchAll(const db::DbFile &file, std::vector<const Page *> &pages) {
+        std::vector<db::PageGuard> guards;
+        for (int p = 0; p < file.getNumPages(); p++) {
+            db::HeapPageId pid(file.getId(), p);
+            guards.push_back(db::Database::getBufferPool().fetchPage(&pid));
+            pages.push_back(guards.back().as<Page>());
+        }
+        return guards;
+    }
+
+    Result heapAccessor(const std::vector<const db::HeapPage *> &pages) {
+        Result result;
+        for (const db::HeapPage *page: pages) {
+            for (auto it = page->begin(); it != page->end(); ++it) {
+                int value = page->getInt(it.getSlot(), FIELD);
+                if (value > THRESHOLD) {
+                    result.count++;
+                    result.sum += value;
+                }
+            }
+        }
+        return result;
+    }
+
+    Result paxColumn(const std::vector<const db::PaxPage *> &pages) {
+        Result result;
+        for (const db::PaxPage *page: pages) {
+            // empty slots are 0, below the threshold, so the bitmap need not be read
+            const int *values = page->getIntColumn(FIELD);
+            for (int slot = 0; slot < page->getNumSlots(); slot++) {
+                bool match = values[slot] > THRESHOLD;
+                result.count += match;
+                result.sum += match ? values[slot] : 0;
+            }
+        }
+        return result;
+    }
+
+    void report(const char *name, const std::function<Result()> &query) {
+        double best = 1e300;
+        Result result;
+        for (int i = 0; i < RUNS; i++) {
+            auto start = std::chrono::steady_clock::now();
+            result = query();
+            best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+                    .count());
+        }
+        printf("%-16s %10.2f %10.1f %10ld %14ld\n", name, best / ROWS, best / 1e6, result.count, result.sum);
+    }
+}
+
+int main() {
+    const char *heapName = "pax_bench_heap.dat";
+    const char *paxName = "pax_bench_pax.dat";
+    for (const char *name: {heapName, paxName}) {
+        std::remove(name);
+        std::remove((std::string(name) + ".fsm").c_str());
+    }
+    db::Database::resetBufferPool(POOL_PAGES);
+    db::TupleDesc td = db::Utility::getTupleDesc(FIELDS);
+    db::HeapFile heapFile(heapName, td);
+    db::PaxFile paxFile(paxName, td);
+    db::Database::getCatalog().addTable(&heapFile, "heap");
+    db::Database::getCatalog().addTable(&paxFile, "pax");
+    load(heapFile, td);
+    load(paxFile, td);
+
+    printf("%d rows of %d int fields, %d heap pages, %d pax pages, all resident\n", ROWS, FIELDS,
+           heapFile.getNumPages(), paxFile.getNumPages());
+    printf("%-16s %10s %10s %10s %14s\n", "scan", "ns/tuple", "ms", "count", "sum");
+    report("heap seqscan", [&] { return seqScan(heapFile.getId()); });
+    report("pax seqscan", [&] { return seqScan(paxFile.getId()); });
+    {
+        std::vector<const db::HeapPage *> heapPages;
+        std::vector<const db::PaxPage *> paxPages;
+        std::vector<db::PageGuard> heapGuards = fetchAll(heapFile, heapPages);
+        std::vector<db::PageGuard> paxGuards = fetchAll(paxFile, paxPages);
+        report("heap accessor", [&] { return heapAccessor(heapPages); });
+        report("pax minipage", [&] { return paxColumn(paxPages); });
+    }
+    for (const char *name: {heapName, paxName}) {
+        std::remove(name);
+        std::remove((std::string(name) + ".fsm").c_str());
+    }
+    return 0;
+}
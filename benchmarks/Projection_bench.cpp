@@ -0,0 +1,103 @@
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/IntField.h>
+#include <db/SeqScan.h>
+#include <db/Utility.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <string>
+#include <vector>
+
+/**
+ * SeqScan of a table of 20 int fields stored in a HeapFile, returning the first k fields
+ * for growing k, and every field without a projection. Pages are decoded by the first scan
+ * that reads them, so every run starts from a fresh pool whose pages are read and pinned
+ * before the clock starts: the time is that of decoding and copying tuples only.
+ */
+
+namespace {
+    constexpr int POOL_PAGES = 8192;
+    constexpr int ROWS = 200000;
+    constexpr int TXN_ROWS = 10000;
+    constexpr int FIELDS = 20;
+    constexpr int RUNS = 5;
+    constexpr const char *FNAME = "projection_bench.dat";
+
+    void load(db::HeapFile &file, const db::TupleDesc &td) {
+        db::BufferPool &bufferPool = db::Database::getBufferPool();
+        for (int row = 0; row < ROWS;) {
+            db::TransactionId tid;
+            for (int end = row + TXN_ROWS; row < end; row++) {
+                db::Tuple tuple(td);
+                for (int i = 0; i < FIELDS; i++) {
+                    tuple.setField(i, new db::IntField(row + i));
+                }
+                bufferPool.insertTuple(tid, file.getId(), &tuple);
+            }
+            bufferPool.transactionComplete(tid);
+        }
+        bufferPool.flushAllPages();
+    }
+
+    /**
+     * @return the pages of file, read into a fresh pool and pinned
+     */
+    std::vector<db::PageGuard> fetchAll(const db::HeapFile &file) {
+        db::Database::resetBufferPool(POOL_PAGES);
+        std::vector<db::PageGuard> guards;
+        for (int p = 0; p < file.getNumPages(); p++) {
+            db::HeapPageId pid(file.getId(), p);
+            guards.push_back(db::Database::getBufferPool().fetchPage(&pid));
+        }
+        return guards;
+    }
+
+    /**
+     * @param width number of fields returned, 0 for a scan without projection
+     */
+    void report(const db::HeapFile &file, int width) {
+        double best = 1e300;
+        long sum = 0;
+        for (int i = 0; i < RUNS; i++) {
+            std::vector<db::PageGuard> guards = fetchAll(file);
+            sum = 0;
+            auto start = std::chrono::steady_clock::now();
+            db::SeqScan seqScan(file.getId());
+            if (width > 0) {
+                std::vector<int> columns(width);
+                std::iota(columns.begin(), columns.end(), 0);
+                seqScan.setProjection(columns);
+            }
+            seqScan.open();
+            while (seqScan.hasNext()) {
+                sum += dynamic_cast<const db::IntField &>(seqScan.next().getField(0)).getValue();
+            }
+            best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+                    .count());
+        }
+        std::string name = width > 0 ? std::to_string(width) : "all (none)";
+        printf("%-12s %10.1f %10.1f %s\n", name.c_str(), best / ROWS, best / 1e6,
+               sum == static_cast<long>(ROWS - 1) * ROWS / 2 ? "" : "WRONG");
+    }
+}
+
+int main() {
+    std::remove(FNAME);
+    std::remove((std::string(FNAME) + ".fsm").c_str());
+    db::Database::resetBufferPool(POOL_PAGES);
+    db::TupleDesc td = db::Utility::getTupleDesc(FIELDS);
+    db::HeapFile file(FNAME, td);
+    db::Database::getCatalog().addTable(&file);
+    load(file, td);
+
+    printf("%d rows of %d int fields, %d pages, pinned, decoded by the scan\n", ROWS, FIELDS, file.getNumPages());
+    printf("%-12s %10s %10s\n", "projected", "ns/tuple", "ms");
+    for (int width: {1, 2, 5, 10, 20, 0}) {
+        report(file, width);
+    }
+    std::remove(FNAME);
+    std::remove((std::string(FNAME) + ".fsm").c_str());
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "BenchFile.h"
+#include <db/Database.h>
+#include <db/HeapPageId.h>
+#include <db/Utility.h>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+/**
+ * Mixed workload: a report scans a large table while point lookups keep hitting a small
+ * set of hot pages (think B+ tree roots and upper levels). Reports the hit rate of the
+ * point lookups and of all accesses for every replacement policy.
+ */
+
+namespace {
+    constexpr int POOL_PAGES = 256;
+    constexpr int HOT_PAGES = 128;
+    constexpr int SCAN_PAGES = 20000;
+    constexpr int LOOKUPS_PER_SCAN_PAGE = 2;
+
+    const char *name(db::ReplacementPolicyType type) {
+        switch (type) {
+            case db::ReplacementPolicyType::CLOCK:
+                return "CLOCK";
+            case db::ReplacementPolicyType::LRU_K:
+                return "LRU-2";
+            case db::ReplacementPolicyType::TWO_Q:
+                return "2Q";
+        }
+        return "?";
+    }
+
+    void run(db::ReplacementPolicyType type) {
+        db::Database::reset();
+        db::Database::resetBufferPool(POOL_PAGES, type);
+        db::BufferPool &bufferpool = db::Database::getBufferPool();
+        bench::BenchFile hot(1, db::Utility::getTupleDesc(2));
+        bench::BenchFile scan(2, db::Utility::getTupleDesc(2));
+        db::Database::getCatalog().addTable(&hot);
+        db::Database::getCatalog().addTable(&scan);
+
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> dist(0, HOT_PAGES - 1);
+
+        // warm up the hot set
+        for (int i = 0; i < 4 * HOT_PAGES; i++) {
+            db::HeapPageId pid(1, dist(gen));
+            bufferpool.getPage(&pid);
+        }
+        hot.reads = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        long lookups = 0;
+        for (int p = 0; p < SCAN_PAGES; p++) {
+            db::HeapPageId spid(2, p);
+            bufferpool.getPage(&spid);
+            for (int i = 0; i < LOOKUPS_PER_SCAN_PAGE; i++) {
+                db::HeapPageId pid(1, dist(gen));
+                bufferpool.getPage(&pid);
+                lookups++;
+            }
+        }
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        long accesses = lookups + SCAN_PAGES;
+        double lookupHitRate = 100.0 * (lookups - hot.reads) / lookups;
+        double totalHitRate = 100.0 * (accesses - hot.reads - scan.reads) / accesses;
+        std::printf("%-6s %14.2f%% %14.2f%% %10.1f ms\n", name(type), lookupHitRate, totalHitRate, elapsed);
+    }
+}
+
+int main() {
+    std::printf("pool=%d pages, hot set=%d pages, scan=%d pages, %d lookups per scanned page\n",
+                POOL_PAGES, HOT_PAGES, SCAN_PAGES, LOOKUPS_PER_SCAN_PAGE);
+    std::printf("%-6s %15s %15s %13s\n", "policy", "lookup hits", "total hits", "time");
+    for (auto type: {db::ReplacementPolicyType::CLOCK, db::ReplacementPolicyType::LRU_K,
+                     db::ReplacementPolicyType::TWO_Q}) {
+        run(type);
+    }
+    return 0;
+}
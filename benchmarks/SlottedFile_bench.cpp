@@ -0,0 +1,76 @@
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/IntField.h>
+#include <db/SeqScan.h>
+#include <db/SlottedFile.h>
+#include <db/StringField.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+/**
+ * Size and scan time of an (int, string) table of short names, stored in a HeapFile and
+ * in a SlottedFile. Both are loaded through the BufferPool and flushed, then scanned with
+ * a SeqScan from a cold pool, which reads every page of the file.
+ */
+
+namespace {
+    constexpr int POOL_PAGES = 512;
+    constexpr int ROWS = 200000;
+    constexpr int TXN_ROWS = 10000;
+    constexpr int SCANS = 5;
+
+    template<typename File>
+    void run(const char *name, const char *fname, const db::TupleDesc &td) {
+        std::remove(fname);
+        std::remove((std::string(fname) + ".fsm").c_str());
+        db::Database::resetBufferPool(POOL_PAGES);
+        db::BufferPool &bufferPool = db::Database::getBufferPool();
+        File file(fname, td);
+        db::Database::getCatalog().addTable(&file);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int row = 0; row < ROWS;) {
+            db::TransactionId tid;
+            for (int end = row + TXN_ROWS; row < end; row++) {
+                db::Tuple tuple(td);
+                tuple.setField(0, new db::IntField(row));
+                tuple.setField(1, new db::StringField(("name" + std::to_string(row % 1000)).c_str()));
+                bufferPool.insertTuple(tid, file.getId(), &tuple);
+            }
+            bufferPool.transactionComplete(tid);
+        }
+        bufferPool.flushAllPages();
+        double load = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double scan = 0;
+        long sum = 0;
+        uint64_t misses = 0;
+        for (int i = 0; i < SCANS; i++) {
+            db::Database::resetBufferPool(POOL_PAGES);
+            start = std::chrono::steady_clock::now();
+            db::SeqScan seqScan(file.getId());
+            seqScan.open();
+            while (seqScan.hasNext()) {
+                sum += dynamic_cast<const db::IntField &>(seqScan.next().getField(0)).getValue();
+            }
+            scan += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            misses += db::Database::getBufferPool().getStats().getTableStats(file.getId()).misses;
+        }
+        printf("%-8s %8d %10.1f %12.0f %10.1f %8lu %s\n", name, file.getNumPages(),
+               file.getNumPages() * static_cast<double>(db::Database::getBufferPool().getPageSize()) / (1 << 20), ROWS / load,
+               scan / SCANS * 1e3, static_cast<unsigned long>(misses / SCANS),
+               sum == static_cast<long>(ROWS - 1) * ROWS / 2 * SCANS ? "" : "WRONG");
+        std::remove(fname);
+        std::remove((std::string(fname) + ".fsm").c_str());
+    }
+}
+
+int main() {
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE});
+    printf("%d rows (int, name of 5-7 characters), pool=%d pages\n", ROWS, POOL_PAGES);
+    printf("%-8s %8s %10s %12s %10s %8s\n", "format", "pages", "MiB", "load rows/s", "scan ms", "misses");
+    run<db::HeapFile>("heap", "slotted_bench_heap.dat", td);
+    run<db::SlottedFile>("slotted", "slotted_bench_slotted.dat", td);
+    return 0;
+}
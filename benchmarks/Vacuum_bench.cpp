@@ -0,0 +1,110 @@
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/HeapPage.h>
+#include <db/IntField.h>
+#include <db/SeqScan.h>
+#include <db/Utility.h>
+#include <db/Vacuum.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Scan time of a HeapFile of (int, int) rows of which most were deleted, before and after
+ * a Vacuum. The deletes leave every page almost empty, so a scan reads all the pages of the
+ * load for a tenth of the rows until the vacuum moves them to the first pages.
+ */
+
+namespace {
+    constexpr int POOL_PAGES = 512;
+    constexpr int ROWS = 1000000;
+    constexpr int TXN_ROWS = 10000;
+    /** One row in KEEP survives the deletes */
+    constexpr int KEEP = 10;
+    constexpr int SCANS = 5;
+    constexpr const char *FNAME = "vacuum_bench.dat";
+
+    int getKey(const db::Tuple &tuple) {
+        return dynamic_cast<const db::IntField &>(tuple.getField(0)).getValue();
+    }
+
+    void load(db::HeapFile &file, const db::TupleDesc &td) {
+        db::BufferPool &bufferPool = db::Database::getBufferPool();
+        for (int row = 0; row < ROWS;) {
+            db::TransactionId tid;
+            for (int end = row + TXN_ROWS; row < end; row++) {
+                db::Tuple tuple(td);
+                tuple.setField(0, new db::IntField(row));
+                tuple.setField(1, new db::IntField(row));
+                bufferPool.insertTuple(tid, file.getId(), &tuple);
+            }
+            bufferPool.transactionComplete(tid);
+        }
+    }
+
+    void deleteRows(db::HeapFile &file) {
+        db::BufferPool &bufferPool = db::Database::getBufferPool();
+        for (int pgNo = 0; pgNo < file.getNumPages(); pgNo++) {
+            db::TransactionId tid;
+            db::HeapPageId pid(file.getId(), pgNo);
+            auto *page = dynamic_cast<db::HeapPage *>(bufferPool.getPage(tid, &pid, db::Permissions::READ_WRITE));
+            std::vector<db::Tuple> deleted;
+            for (auto it = page->begin(); it != page->end(); ++it) {
+                if (getKey(*it) % KEEP != 0) {
+                    deleted.push_back(*it);
+                }
+            }
+            for (db::Tuple &tuple: deleted) {
+                bufferPool.deleteTuple(tid, &tuple);
+            }
+            bufferPool.transactionComplete(tid);
+        }
+    }
+
+    void scan(const char *name, db::HeapFile &file) {
+        double total = 0;
+        long rows = 0;
+        uint64_t misses = 0;
+        for (int i = 0; i < SCANS; i++) {
+            db::Database::getBufferPool().flushAllPages();
+            db::Database::resetBufferPool(POOL_PAGES);
+            auto start = std::chrono::steady_clock::now();
+            db::SeqScan seqScan(file.getId());
+            seqScan.open();
+            while (seqScan.hasNext()) {
+                getKey(seqScan.next());
+                rows++;
+            }
+            total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            misses += db::Database::getBufferPool().getStats().getTableStats(file.getId()).misses;
+        }
+        printf("%-8s %8d %10ld %10.1f %8lu %s\n", name, file.getNumPages(), rows / SCANS, total / SCANS * 1e3,
+               static_cast<unsigned long>(misses / SCANS), rows / SCANS == ROWS / KEEP ? "" : "WRONG");
+    }
+}
+
+int main() {
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    std::remove(FNAME);
+    std::remove((std::string(FNAME) + ".fsm").c_str());
+    db::Database::resetBufferPool(POOL_PAGES);
+    db::HeapFile file(FNAME, td);
+    db::Database::getCatalog().addTable(&file);
+    load(file, td);
+    deleteRows(file);
+
+    printf("%d rows (int, int), %d deleted, pool=%d pages\n", ROWS, ROWS - ROWS / KEEP, POOL_PAGES);
+    printf("%-8s %8s %10s %10s %8s\n", "file", "pages", "rows", "scan ms", "misses");
+    scan("before", file);
+    db::Database::resetBufferPool(POOL_PAGES);
+    auto start = std::chrono::steady_clock::now();
+    db::VacuumStats stats = db::Vacuum(file).run();
+    double vacuum = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    scan("after", file);
+    printf("vacuum: %.1f ms, %ld rows moved, %d -> %d pages\n", vacuum * 1e3, stats.tuplesMoved, stats.pagesBefore,
+           stats.pagesAfter);
+    std::remove(FNAME);
+    std::remove((std::string(FNAME) + ".fsm").c_str());
+    return 0;
+}
@@ -3,12 +3,64 @@
 #include <db/BufferPool.h>
 #include <db/BTreeHeaderPage.h>
 #include <cassert>
+#include <memory>
+#include <unordered_set>
+#include <utility>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <vector>
 
 using namespace db;
 
+namespace {
+    /** Pins of the pages fetched by the insertion or deletion running on this thread */
+    thread_local std::vector<PageGuard> *operationPins = nullptr;
+
+    /**
+     * Keeps every page fetched by a B+ tree operation pinned until the operation returns, so
+     * that the pages it passes around, e.g. to splitLeafPage, cannot be evicted meanwhile.
+     * Nested scopes share the pins of the outermost one.
+     */
+    class PinScope {
+        std::vector<PageGuard> pins;
+        bool outermost;
+
+    public:
+        PinScope() : outermost(operationPins == nullptr) {
+            if (outermost) {
+                operationPins = &pins;
+            }
+        }
+
+        PinScope(const PinScope &) = delete;
+
+        ~PinScope() {
+            if (outermost) {
+                operationPins = nullptr;
+            }
+        }
+    };
+
+    /**
+     * Move one pin of each page of dirtypages out of the pins of the operation, for the
+     * BufferPool to hold until it marked the pages dirty.
+     */
+    std::vector<PageGuard> takeDirtyPins(const PagesMap &dirtypages) {
+        std::unordered_set<const Page *> wanted;
+        for (const auto &pair: dirtypages) {
+            wanted.insert(pair.second);
+        }
+        std::vector<PageGuard> dirty;
+        for (PageGuard &guard: *operationPins) {
+            if (wanted.erase(guard.get()) > 0) {
+                dirty.push_back(std::move(guard));
+            }
+        }
+        return dirty;
+    }
+}
+
 BTreeLeafPage *BTreeFile::findLeafPage(TransactionId tid, PagesMap &dirtypages, BTreePageId *pid, Permissions perm,
                                        const Field *f) {
     if (pid->getType() == BTreePageType::LEAF) {
@@ -471,40 +523,51 @@ int BTreeFile::getId() const { return tableid; }
 
 const TupleDesc &BTreeFile::getTupleDesc() const { return td; }
 
-Page *BTreeFile::readPage(const PageId &pid) {
+Page *BTreeFile::readPage(const PageId &pid, uint8_t *frame) {
     const auto *id = dynamic_cast<const BTreePageId *>(&pid);
     if(id->getType() == BTreePageType::ROOT_PTR) {
-        auto *pageBuf = new uint8_t[BTreeRootPtrPage::getPageSize()];
-        auto retval = pread(fd, pageBuf, BTreeRootPtrPage::getPageSize(), 0);
+        auto retval = pread(fd, frame, BTreeRootPtrPage::getPageSize(), 0);
         assert(retval != -1);
         assert(retval == BTreeRootPtrPage::getPageSize());
-        return new BTreeRootPtrPage(id, pageBuf);
+        return new BTreeRootPtrPage(id, frame);
     }
 
-    auto *pageBuf = new uint8_t[Database::getBufferPool().getPageSize()];
     off_t offset = BTreeRootPtrPage::getPageSize() + (id->pageNumber()-1) * Database::getBufferPool().getPageSize();
-    auto retval = pread(fd, pageBuf, Database::getBufferPool().getPageSize(), offset);
+    auto retval = pread(fd, frame, Database::getBufferPool().getPageSize(), offset);
     assert(retval != -1);
     assert(retval == Database::getBufferPool().getPageSize());
     if(id->getType() == BTreePageType::INTERNAL) {
-        return new BTreeInternalPage(*id, pageBuf, keyField);
+        return new BTreeInternalPage(*id, frame, keyField);
     }
     if(id->getType() == BTreePageType::LEAF) {
-        return new BTreeLeafPage(*id, pageBuf, keyField);
+        return new BTreeLeafPage(*id, frame, keyField);
     }
     // BTreePageType::HEADER
-    return new BTreeHeaderPage(id, pageBuf);
+    return new BTreeHeaderPage(id, frame);
 }
 
 void BTreeFile::writePage(Page *page) {
-    const auto *id = dynamic_cast<const BTreePageId *>(&page->getId());
+    auto data = static_cast<uint8_t *>(page->getPageData());
+    writePageData(page->getId(), data);
+    delete[] data;
+}
 
-    auto data = page->getPageData();
-    if(id->getType() == BTreePageType::ROOT_PTR) {
-        pwrite(fd, data, BTreeRootPtrPage::getPageSize(), 0);
-    } else {
-        off_t offset = BTreeRootPtrPage::getPageSize() + (page->getId().pageNumber()-1) * Database::getBufferPool().getPageSize();
-        pwrite(fd, data, Database::getBufferPool().getPageSize(), offset);
+void BTreeFile::writePageData(const PageId &pid, const void *data) {
+    const auto *id = dynamic_cast<const BTreePageId *>(&pid);
+    size_t len = BTreeRootPtrPage::getPageSize();
+    off_t offset = 0;
+    if (id->getType() != BTreePageType::ROOT_PTR) {
+        len = Database::getBufferPool().getPageSize();
+        offset = BTreeRootPtrPage::getPageSize() + (pid.pageNumber()-1) * Database::getBufferPool().getPageSize();
+    }
+    if (pwrite(fd, data, len, offset) != static_cast<ssize_t>(len)) {
+        throw std::runtime_error("write");
+    }
+}
+
+void BTreeFile::sync() {
+    if (fsync(fd) == -1) {
+        throw std::runtime_error("fsync");
     }
 }
 
@@ -530,7 +593,14 @@ Page *BTreeFile::getPage(TransactionId tid, PagesMap &dirtypages, const BTreePag
         return it->second;
     }
     else {
-        Page *p = Database::getBufferPool().getPage(pid);
+        Page *p;
+        if (operationPins != nullptr) {
+            PageGuard guard = Database::getBufferPool().fetchPage(tid, pid, perm);
+            p = guard.get();
+            operationPins->push_back(std::move(guard));
+        } else {
+            p = Database::getBufferPool().getPage(tid, pid, perm);
+        }
         if (perm == Permissions::READ_WRITE) {
             dirtypages[pid] = p;
         }
@@ -538,7 +608,8 @@ Page *BTreeFile::getPage(TransactionId tid, PagesMap &dirtypages, const BTreePag
     }
 }
 
-std::vector<Page *> BTreeFile::insertTuple(TransactionId tid, Tuple &t) {
+std::vector<PageGuard> BTreeFile::insertTuple(TransactionId tid, Tuple &t) {
+    PinScope pinScope;
     PagesMap dirtypages;
 
     // get a read lock on the root pointer page and use it to locate the root page
@@ -564,14 +635,11 @@ std::vector<Page *> BTreeFile::insertTuple(TransactionId tid, Tuple &t) {
     // insert the tuple into the leaf page
     leafPage->insertTuple(&t);
 
-    std::vector<Page *>dirtyPagesArr;
-    for (const auto& pair : dirtypages) {
-        dirtyPagesArr.push_back(pair.second);
-    }
-    return dirtyPagesArr;
+    return takeDirtyPins(dirtypages);
 }
 
-std::vector<Page *> BTreeFile::deleteTuple(TransactionId tid, Tuple &t) {
+std::vector<PageGuard> BTreeFile::deleteTuple(TransactionId tid, Tuple &t) {
+    PinScope pinScope;
     PagesMap dirtypages;
 
     auto *pageId = new BTreePageId(tableid, t.getRecordId()->getPageId()->pageNumber(), BTreePageType::LEAF);
@@ -585,11 +653,7 @@ std::vector<Page *> BTreeFile::deleteTuple(TransactionId tid, Tuple &t) {
         handleMinOccupancyPage(tid, dirtypages, page);
     }
 
-    std::vector<Page *> dirtyPagesArr;
-    for (const auto& pair : dirtypages) {
-        dirtyPagesArr.push_back(pair.second);
-    }
-    return dirtyPagesArr;
+    return takeDirtyPins(dirtypages);
 }
 
 BTreeRootPtrPage *BTreeFile::getRootPtrPage(TransactionId tid, PagesMap &dirtypages) {
@@ -667,14 +731,19 @@ BTreeFileIterator::BTreeFileIterator(TransactionId tid, IndexPredicate *pred, BT
         current_leaf = nullptr;
         return;
     }
-    auto *rootPtr = dynamic_cast<BTreeRootPtrPage *>(Database::getBufferPool().getPage(
-            BTreeRootPtrPage::getId(file->getId())));
+    // the pages of the descent stay pinned until the first leaf is
+    PinScope pinScope;
+    PageGuard rootPtrGuard = Database::getBufferPool().fetchPage(tid, BTreeRootPtrPage::getId(file->getId()),
+                                                                 Permissions::READ_ONLY);
+    auto *rootPtr = rootPtrGuard.as<BTreeRootPtrPage>();
     BTreePageId *root = rootPtr->getRootId();
     if (pred && (pred->getOp() == Predicate::Op::EQUALS || pred->getOp() == Predicate::Op::GREATER_THAN || pred->getOp() == Predicate::Op::GREATER_THAN_OR_EQ)) {
         current_leaf = file->findLeafPage(tid, root, Permissions::READ_ONLY, pred->getField());
     } else {
         current_leaf = file->findLeafPage(tid, root, Permissions::READ_ONLY, nullptr);
     }
+    guard = Database::getBufferPool().fetchPage(&current_leaf->getId());
+    current_leaf = guard.as<BTreeLeafPage>();
     it = current_leaf->begin();
 }
 
@@ -700,9 +769,13 @@ BTreeFileIterator &BTreeFileIterator::operator++() {
     auto next_id = current_leaf->getRightSiblingId();
     if (next_id == nullptr) {
         current_leaf = nullptr;
+        guard.release();
         return *this;
     }
-    current_leaf = (BTreeLeafPage*) Database::getBufferPool().getPage(next_id);
+    guard = Database::getBufferPool().fetchPage(tid, next_id, Permissions::READ_ONLY);
+    current_leaf = guard.as<BTreeLeafPage>();
+    std::unique_ptr<BTreePageId> following(current_leaf->getRightSiblingId());
+    readAhead.accessLeaf(following.get());
     it = current_leaf->begin();
     return *this;
 }
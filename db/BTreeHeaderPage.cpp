@@ -24,6 +24,10 @@ BTreeHeaderPage::BTreeHeaderPage(const BTreePageId *id, uint8_t *data) {
     memcpy(header, int_data + 2, header_size);
 }
 
+BTreeHeaderPage::~BTreeHeaderPage() {
+    delete[] header;
+}
+
 void BTreeHeaderPage::init() {
     memset(header, 0xFF, getHeaderSize());
 }
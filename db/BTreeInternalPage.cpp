@@ -192,6 +192,12 @@ BTreeInternalPage::BTreeInternalPage(const BTreePageId &id, uint8_t *data, int k
     childCategory = BTreePageType::LEAF;
 }
 
+BTreeInternalPage::~BTreeInternalPage() {
+    delete[] children;
+    delete[] keys;
+    delete[] header;
+}
+
 int BTreeInternalPage::getMaxEntries() const {
     size_t keySize = Types::getLen(td.getFieldType(keyField));
     // extraBits are: parent pointer, child page category, extra child pointer (node with m entries has m+1 pointers to children), 1 bit for extra header
@@ -2,6 +2,7 @@
 #include <db/Database.h>
 #include <db/Catalog.h>
 #include <db/BufferPool.h>
+#include <db/SlotBitmap.h>
 #include <cassert>
 
 using namespace db;
@@ -18,17 +19,9 @@ bool BTreeLeafPageIterator::operator!=(const BTreeLeafPageIterator &other) const
 
 BTreeLeafPageIterator &BTreeLeafPageIterator::operator++() {
     if (reverse) {
-        while (--index >= 0) {
-            if (page->isSlotUsed(index)) {
-                break;
-            }
-        }
+        index = SlotBitmap::prev(page->header, page->numSlots, index - 1);
     } else {
-        while (++index < page->numSlots) {
-            if (page->isSlotUsed(index)) {
-                break;
-            }
-        }
+        index = SlotBitmap::next(page->header, page->numSlots, index + 1, true);
     }
     return *this;
 }
@@ -64,13 +57,9 @@ void BTreeLeafPage::moveRecord(int from, int to) {
 }
 
 void BTreeLeafPage::markSlotUsed(int i, bool value) {
-    int headerbit = i % 8;
-    int headerbyte = (i - headerbit) / 8;
-
-    if (value)
-        header[headerbyte] |= 1 << headerbit;
-    else
-        header[headerbyte] &= (0xFF ^ (1 << headerbit));
+    if (SlotBitmap::assign(header, i, value)) {
+        numUsed += value ? 1 : -1;
+    }
 }
 
 BTreeLeafPage::BTreeLeafPage(const BTreePageId &id, uint8_t *data, int key) : BTreePage(id, key) {
@@ -84,20 +73,23 @@ BTreeLeafPage::BTreeLeafPage(const BTreePageId &id, uint8_t *data, int key) : BT
     header = new uint8_t[header_size];
     memcpy(header, int_data + 3, header_size);
     memcpy(header, int_data + 3, header_size);
+    numUsed = SlotBitmap::count(header, numSlots);
     size_t offset = 3 * sizeof(int) + header_size;
 
     tuples = new Tuple[numSlots];
     readTuples(data + offset);
 }
 
+BTreeLeafPage::~BTreeLeafPage() {
+    delete[] tuples;
+    delete[] header;
+}
+
 void BTreeLeafPage::readTuples(uint8_t *data) {
-    size_t offset = 0;
     size_t tuple_size = td.getSize();
-    for (int slot = 0; slot < numSlots; slot++) {
-        if (isSlotUsed(slot)) {
-            readTuple(tuples + slot, data + offset, slot);
-        }
-        offset += tuple_size;
+    for (int slot = SlotBitmap::next(header, numSlots, 0, true); slot < numSlots;
+         slot = SlotBitmap::next(header, numSlots, slot + 1, true)) {
+        readTuple(tuples + slot, data + slot * tuple_size, slot);
     }
 }
 
@@ -123,26 +115,19 @@ void BTreeLeafPage::insertTuple(Tuple *t) {
     assert(t->getTupleDesc() == td);
 
     // find the first empty slot
-    int emptySlot = -1;
-    for (int i = 0; i < numSlots; i++) {
-        if (!isSlotUsed(i)) {
-            emptySlot = i;
-            break;
-        }
-    }
+    int emptySlot = SlotBitmap::next(header, numSlots, 0, false);
 
     // called addTuple on page with no empty slots.
-    assert(emptySlot != -1);
+    assert(emptySlot != numSlots);
 
     // find the last key less than or equal to the key being inserted
     int lessOrEqKey = -1;
     const Field &key = t->getField(keyField);
-    for (int i = 0; i < numSlots; i++) {
-        if (isSlotUsed(i)) {
-            if (!tuples[i].getField(keyField).compare(Predicate::Op::LESS_THAN_OR_EQ, &key))
-                break;
-            lessOrEqKey = i;
-        }
+    for (int i = SlotBitmap::next(header, numSlots, 0, true); i < numSlots;
+         i = SlotBitmap::next(header, numSlots, i + 1, true)) {
+        if (!tuples[i].getField(keyField).compare(Predicate::Op::LESS_THAN_OR_EQ, &key))
+            break;
+        lessOrEqKey = i;
     }
 
     // shift records back or forward to fill empty slot and make room for new record
@@ -210,28 +195,15 @@ int BTreeLeafPage::getNumTuples() {
 }
 
 int BTreeLeafPage::getNumEmptySlots() const {
-    int cnt = 0;
-    for (int i = 0; i < numSlots; i++)
-        if (!isSlotUsed(i))
-            cnt++;
-    return cnt;
+    return numSlots - numUsed;
 }
 
 bool BTreeLeafPage::isSlotUsed(int i) const {
-    int headerbit = i % 8;
-    int headerbyte = (i - headerbit) / 8;
-    return (header[headerbyte] & (1 << headerbit)) != 0;
+    return SlotBitmap::test(header, i);
 }
 
 BTreeLeafPageIterator BTreeLeafPage::begin() {
-    int index = 0;
-    while (index < numSlots) {
-        if (isSlotUsed(index)) {
-            break;
-        }
-        index++;
-    }
-    return {index, this};
+    return {SlotBitmap::next(header, numSlots, 0, true), this};
 }
 
 BTreeLeafPageIterator BTreeLeafPage::end() {
@@ -239,14 +211,7 @@ BTreeLeafPageIterator BTreeLeafPage::end() {
 }
 
 BTreeLeafPageIterator BTreeLeafPage::rbegin() {
-    int index = numSlots - 1;
-    while (index >= 0) {
-        if (isSlotUsed(index)) {
-            break;
-        }
-        index--;
-    }
-    return {index, this, true};
+    return {SlotBitmap::prev(header, numSlots, numSlots - 1), this, true};
 }
 
 BTreeLeafPageIterator BTreeLeafPage::rend() {
@@ -0,0 +1,76 @@
+#include <db/BackgroundWriter.h>
+#include <db/BufferPool.h>
+#include <algorithm>
+#include <chrono>
+
+using namespace db;
+
+BackgroundWriter::BackgroundWriter(BufferPool &bufferPool) : bufferPool(bufferPool) {}
+
+BackgroundWriter::~BackgroundWriter() {
+    {
+        std::lock_guard lock(latch);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void BackgroundWriter::setCleanTarget(double share) {
+    cleanTarget.store(std::clamp(share, 0.0, 1.0), std::memory_order_relaxed);
+    std::lock_guard lock(latch);
+    if (share > 0 && !worker.joinable() && !stopping) {
+        worker = std::thread(&BackgroundWriter::run, this);
+    }
+}
+
+double BackgroundWriter::getCleanTarget() const {
+    return cleanTarget.load(std::memory_order_relaxed);
+}
+
+void BackgroundWriter::setInterval(int ms) {
+    intervalMs.store(std::max(ms, 1), std::memory_order_relaxed);
+}
+
+void BackgroundWriter::recordEvictionFlush() {
+    evictionFlushes.fetch_add(1, std::memory_order_relaxed);
+    if (cleanTarget.load(std::memory_order_relaxed) > 0) {
+        {
+            std::lock_guard lock(latch);
+            wakeup = true;
+        }
+        cv.notify_one();
+    }
+}
+
+void BackgroundWriter::run() {
+    std::unique_lock lock(latch);
+    while (true) {
+        auto interval = std::chrono::milliseconds(intervalMs.load(std::memory_order_relaxed));
+        cv.wait_for(lock, interval, [this] { return stopping || wakeup; });
+        if (stopping) {
+            return;
+        }
+        wakeup = false;
+        lock.unlock();
+
+        auto numPages = static_cast<size_t>(bufferPool.getNumPages());
+        auto maxDirty = numPages - static_cast<size_t>(getCleanTarget() * numPages);
+        size_t dirty = bufferPool.countDirtyPages();
+        if (dirty > maxDirty) {
+            try {
+                pagesWritten.fetch_add(static_cast<long>(bufferPool.flushDirtyPages(dirty - maxDirty)),
+                                       std::memory_order_relaxed);
+            } catch (const std::exception &) {
+                // the pages stay dirty and are retried on the next round
+            }
+        }
+        lock.lock();
+    }
+}
+
+BackgroundWriterStats BackgroundWriter::getStats() const {
+    return {pagesWritten.load(std::memory_order_relaxed), evictionFlushes.load(std::memory_order_relaxed)};
+}
@@ -1,85 +1,802 @@
 #include <db/BufferPool.h>
 #include <db/Database.h>
+#include <db/BTreeRootPtrPage.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
 
 using namespace db;
 
+namespace {
+    /**
+     * Sort pages by (table, page number), the order the files write them in.
+     */
+    void sortByPosition(std::vector<Page *> &pages) {
+        std::sort(pages.begin(), pages.end(), [](const Page *a, const Page *b) {
+            int tableA = a->getId().getTableId();
+            int tableB = b->getId().getTableId();
+            return tableA != tableB ? tableA < tableB : a->getId().pageNumber() < b->getId().pageNumber();
+        });
+    }
+}
+
+//
+// BufferPool::Shard
+//
+
+BufferPool::Shard::Shard(size_t firstFrame, size_t numFrames, ReplacementPolicyType policyType)
+        : firstFrame(firstFrame), frames(numFrames, nullptr), policy(ReplacementPolicy::create(policyType, numFrames)),
+          prefetched(new std::atomic<bool>[numFrames]()) {
+    for (size_t i = numFrames; i > 0; i--) {
+        freeFrames.push_back(i - 1);
+    }
+}
+
+BufferPool::Shard::~Shard() {
+    for (Page *page: frames) {
+        delete page;
+    }
+}
+
+bool BufferPool::Shard::recordHit(size_t frame) {
+    size_t i = numAccesses.fetch_add(1, std::memory_order_relaxed);
+    if (i < ACCESS_BUFFER_SIZE) {
+        accesses[i].store(frame, std::memory_order_relaxed);
+    }
+    return i + 1 >= ACCESS_BUFFER_SIZE;
+}
+
+void BufferPool::Shard::drainAccesses() {
+    size_t n = std::min(numAccesses.load(std::memory_order_relaxed), ACCESS_BUFFER_SIZE);
+    for (size_t i = 0; i < n; i++) {
+        size_t frame = accesses[i].load(std::memory_order_relaxed);
+        // the page may have been evicted since it was hit
+        if (frames[frame] != nullptr) {
+            policy->recordAccess(frame);
+        }
+    }
+    numAccesses.store(0, std::memory_order_relaxed);
+}
+
+//
+// BufferPool
+//
+
+BufferPool::BufferPool(int numPages, ReplacementPolicyType policyType, int numShards, bool hugePages)
+        : numPages(numPages), arena(numPages, PAGE_SIZE, hugePages), writer(*this), checkpointer(*this), prefetcher(*this) {
+    size_t firstFrame = 0;
+    for (int i = 0; i < numShards; i++) {
+        size_t numFrames = numPages / numShards + (i < numPages % numShards ? 1 : 0);
+        shards.push_back(std::make_unique<Shard>(firstFrame, numFrames, policyType));
+        latchOrder.push_back(shards.back().get());
+        firstFrame += numFrames;
+    }
+    std::sort(latchOrder.begin(), latchOrder.end());
+}
+
+void BufferPool::setPageSize(int newPageSize) {
+    if (newPageSize > static_cast<int>(arena.getFrameSize())) {
+        throw std::runtime_error("Page size larger than the frames");
+    }
+    pageSize = newPageSize;
+}
+
+BufferPool::Shard &BufferPool::getShard(const PageId *pid) const {
+    // consecutive pages of a table should land in different shards
+    size_t h = hasher{}(pid) * 0x9E3779B97F4A7C15ull;
+    return *shards[(h >> 32) % shards.size()];
+}
+
+size_t BufferPool::allocateFrame(Shard &shard) {
+    {
+        std::lock_guard lock(shard.releasedLatch);
+        shard.freeFrames.insert(shard.freeFrames.end(), shard.releasedFrames.begin(), shard.releasedFrames.end());
+        shard.releasedFrames.clear();
+    }
+    if (shard.freeFrames.empty()) {
+        evictPage(shard);
+    }
+    if (shard.freeFrames.empty()) {
+        throw std::runtime_error("No frame can be evicted");
+    }
+    size_t frame = shard.freeFrames.back();
+    shard.freeFrames.pop_back();
+    return frame;
+}
+
+uint8_t *BufferPool::getFrameData(const Shard &shard, size_t frame) const {
+    return arena.getFrame(shard.firstFrame + frame);
+}
+
+void BufferPool::installPage(Shard &shard, size_t frame, Page *page) {
+    const PageId *pid = &page->getId();
+    shard.frames[frame] = page;
+    shard.frameIds[pid] = frame;
+    shard.pages[pid] = page;
+    page->dirtyIndex = &dirtyIndex;
+    page->frame = shard.firstFrame + frame;
+    if (std::optional<TransactionId> tid = page->isDirty()) {
+        // dirtied before it was cached, by an insert or delete
+        dirtyIndex.add(*tid, page->frame, pid->getTableId());
+    }
+    shard.policy->recordAccess(frame);
+    shard.policy->setEvictable(frame, true);
+}
+
+void BufferPool::removePage(Shard &shard, size_t frame) {
+    Page *page = shard.frames[frame];
+    const PageId *pid = &page->getId();
+    releasePrefetched(shard, frame);
+    shard.pages.erase(pid);
+    shard.frameIds.erase(pid);
+    shard.frames[frame] = nullptr;
+    // pins are only taken under the latch, so a page without pins can no longer get any
+    if (page->pinState.fetch_or(Page::REMOVED, std::memory_order_acq_rel) == 0) {
+        delete page;
+        shard.freeFrames.push_back(frame);
+    }
+}
+
+Page *BufferPool::readPage(Shard &shard, const PageId *pid) {
+    size_t frame = allocateFrame(shard);
+    Page *page;
+    auto start = std::chrono::steady_clock::now();
+    try {
+        page = Database::getCatalog().getDatabaseFile(pid->getTableId())->readPage(*pid, getFrameData(shard, frame));
+    } catch (...) {
+        shard.freeFrames.push_back(frame);
+        throw;
+    }
+    stats.recordRead(*pid, std::chrono::steady_clock::now() - start);
+    installPage(shard, frame, page);
+    return page;
+}
+
+void BufferPool::readPages(const std::vector<const PageId *> &pids, bool prefetch,
+                           const std::function<void(Page *)> &callback) {
+    std::unordered_set<Shard *> involved;
+    for (auto pid: pids) {
+        involved.insert(&getShard(pid));
+    }
+    std::vector<std::unique_lock<std::shared_mutex>> locks;
+    for (Shard *shard: latchOrder) {
+        if (involved.count(shard)) {
+            locks.emplace_back(shard->latch);
+            shard->drainAccesses();
+        }
+    }
+
+    struct Batch {
+        std::vector<const PageId *> pids;
+        std::vector<uint8_t *> frames;
+        std::vector<std::pair<Shard *, size_t>> slots;
+        std::vector<bool> installed;
+    };
+    std::unordered_map<int, Batch> batches;
+    try {
+        std::unordered_set<const PageId *, hasher, equals> seen;
+        for (auto pid: pids) {
+            if (!seen.insert(pid).second) {
+                continue;
+            }
+            Shard &shard = getShard(pid);
+            auto it = shard.frameIds.find(pid);
+            if (it != shard.frameIds.end()) {
+                if (!prefetch && !takePrefetched(shard, it->second)) {
+                    shard.policy->recordAccess(it->second);
+                }
+                if (!prefetch) {
+                    stats.recordHit(*pid);
+                }
+                callback(shard.frames[it->second]);
+                continue;
+            }
+            size_t frame = allocateFrame(shard);
+            Batch &batch = batches[pid->getTableId()];
+            batch.pids.push_back(pid);
+            batch.frames.push_back(getFrameData(shard, frame));
+            batch.slots.emplace_back(&shard, frame);
+            batch.installed.push_back(false);
+        }
+        for (auto &[tableId, batch]: batches) {
+            auto start = std::chrono::steady_clock::now();
+            Database::getCatalog().getDatabaseFile(tableId)->readPages(
+                    batch.pids, batch.frames, [&, &batch = batch](size_t i, Page *page) {
+                        auto [shard, frame] = batch.slots[i];
+                        // the latency of a page is the time until its read completed
+                        stats.recordRead(page->getId(), std::chrono::steady_clock::now() - start);
+                        if (!prefetch) {
+                            stats.recordMiss(page->getId());
+                        }
+                        installPage(*shard, frame, page);
+                        batch.installed[i] = true;
+                        if (prefetch) {
+                            shard->prefetched[frame] = true;
+                            prefetcher.recordLoad();
+                        }
+                        callback(page);
+                    });
+        }
+    } catch (...) {
+        for (auto &[tableId, batch]: batches) {
+            for (size_t i = 0; i < batch.slots.size(); i++) {
+                if (!batch.installed[i]) {
+                    batch.slots[i].first->freeFrames.push_back(batch.slots[i].second);
+                }
+            }
+        }
+        throw;
+    }
+}
+
+void BufferPool::cachePage(Shard &shard, Page *page) {
+    if (page->pinState.load(std::memory_order_relaxed) & Page::REMOVED) {
+        // reinstalling it would bring back a stale version the pool no longer owns
+        throw std::runtime_error("Page was removed from the buffer pool");
+    }
+    auto it = shard.frameIds.find(&page->getId());
+    if (it == shard.frameIds.end()) {
+        installPage(shard, allocateFrame(shard), page);
+        return;
+    }
+    size_t frame = it->second;
+    if (shard.frames[frame] == page) {
+        shard.policy->recordAccess(frame);
+        return;
+    }
+    // replace the resident version, which may still be pinned and keep its frame
+    shard.policy->remove(frame);
+    removePage(shard, frame);
+    installPage(shard, allocateFrame(shard), page);
+}
+
+bool BufferPool::evictPage(Shard &shard) {
+    shard.drainAccesses();
+    std::vector<size_t> pinned;
+    auto frame = shard.policy->evict();
+    // pins are taken under the shared latch, so they are checked here rather than through
+    // setEvictable, which needs the exclusive latch
+    while (frame && shard.frames[*frame]->pinState.load(std::memory_order_relaxed) > 0) {
+        pinned.push_back(*frame);
+        frame = shard.policy->evict();
+    }
+    for (size_t skipped: pinned) {
+        // the policy forgot their history, they are in use so they count as just accessed
+        shard.policy->recordAccess(skipped);
+        shard.policy->setEvictable(skipped, true);
+    }
+    if (!frame) {
+        return false;
+    }
+    Page *victim = shard.frames[*frame];
+    bool dirty = victim->isDirty().has_value();
+    if (dirty) {
+        writer.recordEvictionFlush();
+    }
+    try {
+        flushPage(shard, &victim->getId());
+    } catch (...) {
+        // the page stays resident and dirty, and evictable once the write can succeed
+        shard.policy->recordAccess(*frame);
+        shard.policy->setEvictable(*frame, true);
+        throw;
+    }
+    stats.recordEviction(victim->getId(), dirty);
+    removePage(shard, *frame);
+    return true;
+}
+
 void BufferPool::evictPage() {
-    auto it = pages.begin();
-    if (it != pages.end()) {
-        flushPage(it->first);
-        pages.erase(it);
+    size_t first = nextEvictShard.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < shards.size(); i++) {
+        Shard &shard = *shards[(first + i) % shards.size()];
+        std::unique_lock lock(shard.latch);
+        if (evictPage(shard)) {
+            return;
+        }
     }
 }
 
 void BufferPool::flushAllPages() {
-    for (const auto &item: pages) {
-        flushPage(item.first);
+    flushDirtyPages([](const Page *) { return true; }, SIZE_MAX);
+}
+
+size_t BufferPool::flushDirtyPages(size_t limit) {
+    return flushDirtyPages([](const Page *) { return true; }, limit);
+}
+
+size_t BufferPool::flushDirtyPages(const std::function<bool(const Page *)> &filter, size_t limit) {
+    std::vector<std::shared_lock<std::shared_mutex>> locks;
+    for (Shard *shard: latchOrder) {
+        locks.emplace_back(shard->latch);
+    }
+    std::vector<Page *> dirty;
+    for (Shard *shard: latchOrder) {
+        for (const auto &item: shard->pages) {
+            if (item.second->isDirty().has_value() && filter(item.second)) {
+                dirty.push_back(item.second);
+            }
+        }
+    }
+    sortByPosition(dirty);
+    dirty.resize(std::min(dirty.size(), limit));
+    writeDirtyPages(dirty);
+    return dirty.size();
+}
+
+void BufferPool::writeDirtyPages(std::vector<Page *> &dirty) {
+    // updates wait from the log record of a page until its write, so the page written is the
+    // page logged; concurrent writers latch the sorted pages in the same order
+    std::vector<std::unique_lock<std::mutex>> updateLocks;
+    for (Page *page: dirty) {
+        updateLocks.emplace_back(page->getUpdateLatch());
+    }
+    // a concurrent writer may have written some of them meanwhile
+    dirty.erase(std::remove_if(dirty.begin(), dirty.end(), [](const Page *page) {
+        return !page->isDirty().has_value();
+    }), dirty.end());
+    if (log && !dirty.empty()) {
+        uint64_t maxLsn = 0;
+        for (Page *page: dirty) {
+            Shard &shard = getShard(&page->getId());
+            logPage(shard, shard.frameIds.at(&page->getId()));
+            maxLsn = std::max(maxLsn, page->getLsn());
+        }
+        log->flush(maxLsn);
+    }
+
+    size_t first = 0;
+    while (first < dirty.size()) {
+        int tableId = dirty[first]->getId().getTableId();
+        size_t last = first;
+        std::vector<std::optional<TransactionId>> dirtiedBy;
+        while (last < dirty.size() && dirty[last]->getId().getTableId() == tableId) {
+            dirtiedBy.push_back(dirty[last]->isDirty());
+            dirty[last]->markDirty(std::nullopt);
+            last++;
+        }
+        DbFile *file = Database::getCatalog().getDatabaseFile(tableId);
+        std::vector<Page *> pages;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            for (size_t i = first; i < last; i++) {
+                Page *page = dirty[i];
+                if (log && page->getImage() == nullptr) {
+                    // the frame holds the image that was just logged
+                    Shard &shard = getShard(&page->getId());
+                    file->writePageData(page->getId(), getFrameData(shard, shard.frameIds.at(&page->getId())));
+                } else {
+                    pages.push_back(page);
+                }
+            }
+            if (!pages.empty()) {
+                file->writePages(pages);
+            }
+        } catch (...) {
+            // any page of the run may not have reached the disk, they stay dirty to be retried
+            for (size_t i = first; i < last; i++) {
+                dirty[i]->markDirty(dirtiedBy[i - first]);
+            }
+            throw;
+        }
+        auto latency = (std::chrono::steady_clock::now() - start) / (last - first);
+        for (size_t i = first; i < last; i++) {
+            stats.recordWrite(dirty[i]->getId(), latency);
+        }
+        first = last;
+    }
+}
+
+std::vector<SnapshotPage> BufferPool::snapshotDirtyPages(uint64_t &redoLsn) {
+    std::vector<std::unique_lock<std::shared_mutex>> locks;
+    for (Shard *shard: latchOrder) {
+        locks.emplace_back(shard->latch);
+    }
+    redoLsn = log ? log->getNextLsn() : 0;
+    std::vector<SnapshotPage> dirty;
+    for (Shard *shard: latchOrder) {
+        for (const auto &item: shard->pages) {
+            if (item.second->isDirty().has_value()) {
+                dirty.push_back({item.first->getTableId(), item.first->pageNumber(), item.second->frame});
+            }
+        }
+    }
+    std::sort(dirty.begin(), dirty.end(), [](const SnapshotPage &a, const SnapshotPage &b) {
+        return std::make_pair(a.tableId, a.pageNo) < std::make_pair(b.tableId, b.pageNo);
+    });
+    return dirty;
+}
+
+size_t BufferPool::flushSnapshotPages(const std::vector<SnapshotPage> &pages) {
+    std::vector<size_t> frames;
+    for (const SnapshotPage &page: pages) {
+        frames.push_back(page.frame);
+    }
+    // the frame may hold another page since, which is left to its own writers
+    return flushFrames(getDirtyFrames(frames), [&pages](size_t i, const Page *page) {
+        return page->getId().getTableId() == pages[i].tableId && page->getId().pageNumber() == pages[i].pageNo;
+    });
+}
+
+size_t BufferPool::countDirtyPages() const {
+    size_t dirty = 0;
+    for (auto &shard: shards) {
+        std::shared_lock lock(shard->latch);
+        for (const auto &item: shard->pages) {
+            dirty += item.second->isDirty().has_value();
+        }
+    }
+    return dirty;
+}
+
+void BufferPool::discardPage(Shard &shard, const PageId *pid) {
+    shard.drainAccesses();
+    auto it = shard.frameIds.find(pid);
+    if (it != shard.frameIds.end()) {
+        size_t frame = it->second;
+        shard.policy->remove(frame);
+        removePage(shard, frame);
     }
 }
 
 void BufferPool::discardPage(const PageId *pid) {
-    auto it = pages.find(pid);
-    if (it != pages.end()) {
-        pages.erase(it);
+    Shard &shard = getShard(pid);
+    std::unique_lock lock(shard.latch);
+    discardPage(shard, pid);
+}
+
+bool BufferPool::takePrefetched(Shard &shard, size_t frame) {
+    // the relaxed load keeps the common case from writing to the shared flag
+    if (shard.prefetched[frame].load(std::memory_order_relaxed) && shard.prefetched[frame].exchange(false)) {
+        prefetcher.recordHit();
+        return true;
+    }
+    return false;
+}
+
+void BufferPool::releasePrefetched(Shard &shard, size_t frame) {
+    if (shard.prefetched[frame].exchange(false)) {
+        prefetcher.recordWasted();
+    }
+}
+
+void BufferPool::logPage(Shard &shard, size_t frame) {
+    Page *page = shard.frames[frame];
+    std::optional<TransactionId> tid = page->isDirty();
+    if (!tid.has_value()) {
+        return;
+    }
+    const PageId &pid = page->getId();
+    size_t imageSize = BufferPoolStats::categoryOf(pid) == PageCategory::ROOT_PTR
+                       ? BTreeRootPtrPage::getPageSize() : pageSize;
+    if (const uint8_t *after = page->getImage()) {
+        // updated in place, the page keeps the sectors it overwrote
+        std::vector<uint8_t> before(imageSize);
+        if (page->takeBeforeImage(before.data())) {
+            page->setLsn(log->logUpdate(*tid, pid, before.data(), after, imageSize));
+        }
+        return;
+    }
+    uint8_t *image = getFrameData(shard, frame);
+    auto *data = static_cast<uint8_t *>(page->getPageData());
+    std::lock_guard lock(imageLatch);
+    if (memcmp(image, data, imageSize) != 0) {
+        page->setLsn(log->logUpdate(*tid, pid, image, data, imageSize));
+        memcpy(image, data, imageSize);
+    }
+    delete[] data;
+}
+
+void BufferPool::flushPage(Shard &shard, const PageId *pid) {
+    auto it = shard.pages.find(pid);
+    if (it != shard.pages.end() && it->second->isDirty().has_value()) {
+        // write-ahead: the records describing the page are durable before the page
+        std::vector<Page *> dirty{it->second};
+        writeDirtyPages(dirty);
     }
 }
 
 void BufferPool::flushPage(const PageId *pid) {
-    auto it = pages.find(pid);
-    if (it != pages.end() && it->second->isDirty().has_value()) {
-        it->second->markDirty(std::nullopt);
-        Database::getCatalog().getDatabaseFile(pid->getTableId())->writePage(it->second);
+    Shard &shard = getShard(pid);
+    std::unique_lock lock(shard.latch);
+    flushPage(shard, pid);
+}
+
+std::vector<std::pair<BufferPool::Shard *, size_t>> BufferPool::getDirtyFrames(const std::vector<size_t> &dirtied) {
+    std::vector<std::pair<Shard *, size_t>> frames;
+    for (size_t frame: dirtied) {
+        // shards are created in frame order
+        auto it = std::upper_bound(shards.begin(), shards.end(), frame,
+                                   [](size_t f, const auto &shard) { return f < shard->firstFrame; });
+        Shard *shard = std::prev(it)->get();
+        frames.emplace_back(shard, frame - shard->firstFrame);
     }
+    return frames;
 }
 
-void BufferPool::flushPages(const TransactionId &tid) {
-    for (const auto &item: pages) {
-        if (item.second->isDirty() == tid) {
-            flushPage(item.first);
+size_t BufferPool::flushFrames(const std::vector<std::pair<Shard *, size_t>> &frames,
+                               const std::function<bool(size_t, const Page *)> &filter) {
+    std::vector<Shard *> involved;
+    for (auto [shard, frame]: frames) {
+        involved.push_back(shard);
+    }
+    std::sort(involved.begin(), involved.end());
+    involved.erase(std::unique(involved.begin(), involved.end()), involved.end());
+    std::vector<std::shared_lock<std::shared_mutex>> locks;
+    for (Shard *shard: involved) {
+        locks.emplace_back(shard->latch);
+    }
+    std::vector<Page *> dirty;
+    for (size_t i = 0; i < frames.size(); i++) {
+        Page *page = frames[i].first->frames[frames[i].second];
+        if (page != nullptr && page->isDirty().has_value() && filter(i, page)) {
+            dirty.push_back(page);
         }
     }
+    sortByPosition(dirty);
+    writeDirtyPages(dirty);
+    return dirty.size();
+}
+
+void BufferPool::flushPages(const TransactionId &tid) {
+    flushFrames(getDirtyFrames(dirtyIndex.get(tid)), [&tid](size_t, const Page *page) {
+        return page->isDirty() == tid;
+    });
 }
 
 void BufferPool::insertTuple(const TransactionId &tid, int tableId, Tuple *t) {
     auto f = Database::getCatalog().getDatabaseFile(tableId);
-    auto dirtypages = f->insertTuple(tid, *t);
-    for (auto page: dirtypages) {
+    // the guards keep the pages resident until they are marked dirty and cached
+    std::vector<PageGuard> dirtypages = f->insertTuple(tid, *t);
+    for (PageGuard &page: dirtypages) {
         page->markDirty(tid);
-        const PageId *pid = &page->getId();
-        if (pages.size() >= numPages && pages.find(pid) == pages.end()) {
-            evictPage();
-        }
-        pages[pid] = page;
+        Shard &shard = getShard(&page->getId());
+        std::unique_lock lock(shard.latch);
+        cachePage(shard, page.get());
     }
 }
 
 void BufferPool::deleteTuple(const TransactionId &tid, Tuple *t) {
     int tableId = t->getRecordId()->getPageId()->getTableId();
     auto f = Database::getCatalog().getDatabaseFile(tableId);
-    auto dirtypages = f->insertTuple(tid, *t);
-    for (auto page: dirtypages) {
+    std::vector<PageGuard> dirtypages = f->deleteTuple(tid, *t);
+    for (PageGuard &page: dirtypages) {
         page->markDirty(tid);
-        const PageId *pid = &page->getId();
-        if (pages.size() >= numPages && pages.find(pid) == pages.end()) {
-            evictPage();
-        }
-        pages[pid] = page;
+        Shard &shard = getShard(&page->getId());
+        std::unique_lock lock(shard.latch);
+        cachePage(shard, page.get());
     }
 }
 
 Page *BufferPool::getPage(const PageId *pid) {
-    auto it = pages.find(pid);
-    if (it != pages.end()) {
-        return it->second;
+    return getPage(pid, false);
+}
+
+Page *BufferPool::getPage(const PageId *pid, bool pin) {
+    Shard &shard = getShard(pid);
+    Page *page = nullptr;
+    bool drain = false;
+    {
+        std::shared_lock lock(shard.latch);
+        auto it = shard.frameIds.find(pid);
+        if (it != shard.frameIds.end()) {
+            page = shard.frames[it->second];
+            if (pin) {
+                // evictions need the exclusive latch, the page cannot leave before it is pinned
+                page->pinState.fetch_add(1, std::memory_order_relaxed);
+            }
+            // the prefetcher already recorded the first access
+            drain = !takePrefetched(shard, it->second) && shard.recordHit(it->second);
+        }
+    }
+    if (page != nullptr) {
+        stats.recordHit(*pid);
+        if (drain) {
+            // only drain if nobody else holds the latch, hits never wait for the exclusive latch
+            std::unique_lock lock(shard.latch, std::try_to_lock);
+            if (lock.owns_lock()) {
+                shard.drainAccesses();
+            }
+        }
+        return page;
     }
-    if (pages.size() >= numPages) {
-        evictPage();
+
+    std::unique_lock lock(shard.latch);
+    shard.drainAccesses();
+    // another thread may have read the page while the latch was released
+    auto it = shard.frameIds.find(pid);
+    if (it != shard.frameIds.end()) {
+        if (!takePrefetched(shard, it->second)) {
+            shard.policy->recordAccess(it->second);
+        }
+        page = shard.frames[it->second];
+        if (pin) {
+            page->pinState.fetch_add(1, std::memory_order_relaxed);
+        }
+        stats.recordHit(*pid);
+        return page;
+    }
+    stats.recordMiss(*pid);
+    page = readPage(shard, pid);
+    if (pin) {
+        page->pinState.fetch_add(1, std::memory_order_relaxed);
     }
-    Page *page = Database::getCatalog().getDatabaseFile(pid->getTableId())->readPage(*pid);
-    pages[pid] = page;
     return page;
 }
 
-const PagesMap &BufferPool::getPages() const { return pages; }
+PageGuard BufferPool::fetchPage(const TransactionId &tid, const PageId *pid, Permissions perm) {
+    lockManager.acquire(tid, *pid, perm == Permissions::READ_WRITE ? LockMode::EXCLUSIVE : LockMode::SHARED);
+    return fetchPage(pid);
+}
+
+PageGuard BufferPool::tryFetchPage(const TransactionId &tid, const PageId *pid, Permissions perm) {
+    if (!lockManager.tryAcquire(tid, *pid, perm == Permissions::READ_WRITE ? LockMode::EXCLUSIVE : LockMode::SHARED)) {
+        return {};
+    }
+    return fetchPage(pid);
+}
+
+PageGuard BufferPool::fetchPage(const PageId *pid) {
+    return {*this, getPage(pid, true)};
+}
+
+Page *BufferPool::pinPage(const PageId *pid) {
+    return getPage(pid, true);
+}
+
+void BufferPool::unpinPage(const Page *page) {
+    if (!releasePin(page)) {
+        throw std::runtime_error("Page is not pinned");
+    }
+}
+
+bool BufferPool::releasePin(const Page *page) noexcept {
+    auto *unpinned = const_cast<Page *>(page);
+    if (unpinned->pinState.load(std::memory_order_acquire) == 1) {
+        // still pinned, an unpinned page may be evicted at once. A reader pinning the page
+        // meanwhile only finds what the page decodes from now on.
+        unpinned->reclaim();
+    }
+    uint32_t state = unpinned->pinState.fetch_sub(1, std::memory_order_acq_rel);
+    if ((state & ~Page::REMOVED) == 0) {
+        unpinned->pinState.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (state == (Page::REMOVED | 1)) {
+        // the page left the pool while it was pinned, nobody else can reach it anymore
+        Shard &shard = getShard(&page->getId());
+        size_t frame = page->frame - shard.firstFrame;
+        delete page;
+        std::lock_guard lock(shard.releasedLatch);
+        shard.releasedFrames.push_back(frame);
+    }
+    return true;
+}
+
+void BufferPool::retainPin(Page *page) noexcept {
+    page->pinState.fetch_add(1, std::memory_order_relaxed);
+}
+
+int BufferPool::getPinCount(const PageId *pid) {
+    Shard &shard = getShard(pid);
+    std::shared_lock lock(shard.latch);
+    auto it = shard.frameIds.find(pid);
+    return it == shard.frameIds.end() ? 0 : static_cast<int>(shard.frames[it->second]->pinState.load(
+            std::memory_order_relaxed));
+}
+
+void BufferPool::getPages(const std::vector<const PageId *> &pids, const std::function<void(Page *)> &callback) {
+    readPages(pids, false, callback);
+}
+
+void BufferPool::prefetchPages(const std::vector<const PageId *> &pids) {
+    readPages(pids, true, [](Page *) {});
+}
+
+PageGuard BufferPool::prefetchPage(const PageId *pid) {
+    Shard &shard = getShard(pid);
+    std::unique_lock lock(shard.latch);
+    shard.drainAccesses();
+    auto it = shard.frameIds.find(pid);
+    Page *page;
+    if (it != shard.frameIds.end()) {
+        page = shard.frames[it->second];
+    } else {
+        page = readPage(shard, pid);
+        shard.prefetched[shard.frameIds[&page->getId()]] = true;
+        prefetcher.recordLoad();
+    }
+    page->pinState.fetch_add(1, std::memory_order_relaxed);
+    return {*this, page};
+}
+
+Page *BufferPool::getPage(const TransactionId &tid, const PageId *pid, Permissions perm) {
+    lockManager.acquire(tid, *pid, perm == Permissions::READ_WRITE ? LockMode::EXCLUSIVE : LockMode::SHARED);
+    return getPage(pid);
+}
+
+void BufferPool::unsafeReleasePage(const TransactionId &tid, const PageId *pid) {
+    lockManager.release(tid, *pid);
+}
+
+bool BufferPool::holdsLock(const TransactionId &tid, const PageId *pid) {
+    return lockManager.holdsLock(tid, *pid);
+}
+
+void BufferPool::transactionComplete(const TransactionId &tid, bool commit) {
+    // only the frames the transaction dirtied are visited, not the whole pool
+    std::unordered_set<int> tables;
+    std::vector<std::pair<Shard *, size_t>> frames = getDirtyFrames(dirtyIndex.take(tid, tables));
+    if (commit && !log) {
+        // without a log the pages themselves are the commit record, including the pages
+        // written before the commit, whose tables may not have been synced since
+        flushFrames(frames, [&tid](size_t, const Page *page) { return page->isDirty() == tid; });
+        for (int tableId: tables) {
+            Database::getCatalog().getDatabaseFile(tableId)->sync();
+        }
+    } else if (commit) {
+        // no-force: the pages stay dirty, only the log is forced
+        for (auto [shard, frame]: frames) {
+            std::unique_lock lock(shard->latch);
+            Page *page = shard->frames[frame];
+            if (page != nullptr && page->isDirty() == tid) {
+                std::lock_guard updateLock(page->getUpdateLatch());
+                logPage(*shard, frame);
+            }
+        }
+        log->commit(tid);
+    } else {
+        for (auto [shard, frame]: frames) {
+            std::unique_lock lock(shard->latch);
+            Page *page = shard->frames[frame];
+            if (page == nullptr || page->isDirty() != tid) {
+                continue;
+            }
+            if (log) {
+                // the rollback restores the image the page had before the transaction,
+                // which may only be in the frame if an earlier commit was not flushed yet
+                std::lock_guard updateLock(page->getUpdateLatch());
+                logPage(*shard, frame);
+            }
+            discardPage(*shard, &page->getId());
+        }
+        if (log) {
+            // a read-ahead may have brought back a page while it was being restored
+            for (const auto &pid: log->abort(tid)) {
+                discardPage(pid.get());
+            }
+        }
+    }
+    lockManager.releaseAll(tid);
+}
+
+void BufferPool::openLog(const std::string &path) {
+    flushAllPages();
+    for (auto &shard: shards) {
+        std::unique_lock lock(shard->latch);
+        std::vector<const PageId *> resident;
+        for (const auto &item: shard->pages) {
+            resident.push_back(item.first);
+        }
+        for (auto pid: resident) {
+            discardPage(*shard, pid);
+        }
+    }
+    auto newLog = std::make_unique<LogManager>(path);
+    newLog->recover();
+    log = std::move(newLog);
+}
+
+PagesMap BufferPool::getPages() const {
+    PagesMap pages;
+    for (auto &shard: shards) {
+        std::shared_lock lock(shard->latch);
+        pages.insert(shard->pages.begin(), shard->pages.end());
+    }
+    return pages;
+}
 
 const int &BufferPool::getNumPages() const { return numPages; }
@@ -0,0 +1,232 @@
+#include <db/BufferPoolStats.h>
+#include <db/BTreePageId.h>
+#include <db/HeapPageId.h>
+#include <sstream>
+#include <typeinfo>
+
+using namespace db;
+
+namespace {
+    std::atomic<uint64_t> nextId{1};
+
+    uint64_t keyOf(int tableId, PageCategory category) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(tableId)) << 8 | static_cast<uint64_t>(category);
+    }
+
+    void writeHistogram(std::ostringstream &out, const LatencyHistogram &histogram) {
+        out << "{\"count\":" << histogram.count << ",\"totalNs\":" << histogram.totalNs
+            << ",\"p50Ns\":" << histogram.percentileNs(0.5) << ",\"p99Ns\":" << histogram.percentileNs(0.99)
+            << ",\"buckets\":[";
+        for (int i = 0; i < LatencyHistogram::BUCKETS; i++) {
+            out << (i ? "," : "") << histogram.buckets[i];
+        }
+        out << "]}";
+    }
+}
+
+const char *db::toString(PageCategory category) {
+    switch (category) {
+        case PageCategory::HEAP:
+            return "heap";
+        case PageCategory::ROOT_PTR:
+            return "root_ptr";
+        case PageCategory::INTERNAL:
+            return "internal";
+        case PageCategory::LEAF:
+            return "leaf";
+        case PageCategory::HEADER:
+            return "header";
+        default:
+            return "other";
+    }
+}
+
+//
+// LatencyHistogram
+//
+
+int LatencyHistogram::bucketOf(uint64_t ns) {
+    int bucket = ns == 0 ? 0 : 63 - __builtin_clzll(ns);
+    return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+uint64_t LatencyHistogram::percentileNs(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+    auto rank = static_cast<uint64_t>(p * static_cast<double>(count - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return (uint64_t{1} << (i + 1)) - 1;
+        }
+    }
+    return (uint64_t{1} << BUCKETS) - 1;
+}
+
+//
+// PageStats
+//
+
+PageStats &PageStats::operator+=(const PageStats &other) {
+    hits += other.hits;
+    misses += other.misses;
+    evictions += other.evictions;
+    dirtyEvictions += other.dirtyEvictions;
+    flushes += other.flushes;
+    for (auto [mine, theirs]: {std::pair{&reads, &other.reads}, std::pair{&writes, &other.writes}}) {
+        for (int i = 0; i < LatencyHistogram::BUCKETS; i++) {
+            mine->buckets[i] += theirs->buckets[i];
+        }
+        mine->count += theirs->count;
+        mine->totalNs += theirs->totalNs;
+    }
+    return *this;
+}
+
+//
+// BufferPoolStats
+//
+
+BufferPoolStats::BufferPoolStats() : id(nextId.fetch_add(1)) {}
+
+BufferPoolStats::Local &BufferPoolStats::local() {
+    thread_local Local local;
+    return local;
+}
+
+PageCategory BufferPoolStats::categoryOf(const PageId &pid) {
+    if (typeid(pid) == typeid(HeapPageId)) {
+        return PageCategory::HEAP;
+    }
+    if (typeid(pid) == typeid(BTreePageId)) {
+        switch (static_cast<const BTreePageId &>(pid).getType()) {
+            case BTreePageType::ROOT_PTR:
+                return PageCategory::ROOT_PTR;
+            case BTreePageType::INTERNAL:
+                return PageCategory::INTERNAL;
+            case BTreePageType::LEAF:
+                return PageCategory::LEAF;
+            case BTreePageType::HEADER:
+                return PageCategory::HEADER;
+        }
+    }
+    return PageCategory::OTHER;
+}
+
+BufferPoolStats::Cell &BufferPoolStats::cell(const PageId &pid) {
+    Local &local = BufferPoolStats::local();
+    if (local.owner != id) {
+        // first record of this thread into this pool
+        local.owner = id;
+        local.slot = std::make_shared<Slot>();
+        local.lastKey = UINT64_MAX;
+        std::lock_guard lock(latch);
+        slots.push_back(local.slot);
+    }
+    uint64_t key = keyOf(pid.getTableId(), categoryOf(pid));
+    if (key == local.lastKey) {
+        return *local.lastCell;
+    }
+    // only this thread inserts into its slot, so it can look up without the latch
+    auto it = local.slot->cells.find(key);
+    if (it == local.slot->cells.end()) {
+        std::lock_guard lock(local.slot->latch);
+        it = local.slot->cells.emplace(key, std::make_unique<Cell>()).first;
+    }
+    local.lastKey = key;
+    local.lastCell = it->second.get();
+    return *local.lastCell;
+}
+
+void BufferPoolStats::add(const PageId &pid, int counter, uint64_t n) {
+    std::atomic<uint64_t> &value = cell(pid)[counter];
+    // the calling thread is the only writer, no read-modify-write needed
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+void BufferPoolStats::addLatency(const PageId &pid, int histogram, std::chrono::nanoseconds latency) {
+    Cell &values = cell(pid);
+    auto ns = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0));
+    for (auto [counter, n]: {std::pair{histogram + LatencyHistogram::bucketOf(ns), uint64_t{1}},
+                             std::pair{histogram + LatencyHistogram::BUCKETS, uint64_t{1}},
+                             std::pair{histogram + LatencyHistogram::BUCKETS + 1, ns}}) {
+        values[counter].store(values[counter].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+}
+
+void BufferPoolStats::recordEviction(const PageId &pid, bool dirty) {
+    add(pid, EVICTIONS);
+    if (dirty) {
+        add(pid, DIRTY_EVICTIONS);
+    }
+}
+
+void BufferPoolStats::recordWrite(const PageId &pid, std::chrono::nanoseconds latency) {
+    add(pid, FLUSHES);
+    addLatency(pid, WRITES, latency);
+}
+
+std::map<std::pair<int, PageCategory>, PageStats> BufferPoolStats::getStats() const {
+    std::map<std::pair<int, PageCategory>, PageStats> stats;
+    std::lock_guard lock(latch);
+    for (const auto &slot: slots) {
+        std::lock_guard slotLock(slot->latch);
+        for (const auto &[key, values]: slot->cells) {
+            PageStats cellStats;
+            auto get = [&values = *values](int counter) { return values[counter].load(std::memory_order_relaxed); };
+            cellStats.hits = get(HITS);
+            cellStats.misses = get(MISSES);
+            cellStats.evictions = get(EVICTIONS);
+            cellStats.dirtyEvictions = get(DIRTY_EVICTIONS);
+            cellStats.flushes = get(FLUSHES);
+            for (auto [histogram, first]: {std::pair{&cellStats.reads, READS}, std::pair{&cellStats.writes, WRITES}}) {
+                for (int i = 0; i < LatencyHistogram::BUCKETS; i++) {
+                    histogram->buckets[i] = get(first + i);
+                }
+                histogram->count = get(first + LatencyHistogram::BUCKETS);
+                histogram->totalNs = get(first + LatencyHistogram::BUCKETS + 1);
+            }
+            auto tableId = static_cast<int>(static_cast<uint32_t>(key >> 8));
+            stats[{tableId, static_cast<PageCategory>(key & 0xFF)}] += cellStats;
+        }
+    }
+    return stats;
+}
+
+PageStats BufferPoolStats::getTableStats(int tableId) const {
+    PageStats total;
+    for (const auto &[key, stats]: getStats()) {
+        if (key.first == tableId) {
+            total += stats;
+        }
+    }
+    return total;
+}
+
+PageStats BufferPoolStats::getTotals() const {
+    PageStats total;
+    for (const auto &[key, stats]: getStats()) {
+        total += stats;
+    }
+    return total;
+}
+
+std::string BufferPoolStats::toJson() const {
+    std::ostringstream out;
+    out << "[";
+    bool first = true;
+    for (const auto &[key, stats]: getStats()) {
+        out << (first ? "" : ",") << "{\"table\":" << key.first << ",\"type\":\"" << toString(key.second)
+            << "\",\"hits\":" << stats.hits << ",\"misses\":" << stats.misses << ",\"evictions\":" << stats.evictions
+            << ",\"dirtyEvictions\":" << stats.dirtyEvictions << ",\"flushes\":" << stats.flushes << ",\"reads\":";
+        writeHistogram(out, stats.reads);
+        out << ",\"writes\":";
+        writeHistogram(out, stats.writes);
+        out << "}";
+        first = false;
+    }
+    out << "]";
+    return out.str();
+}
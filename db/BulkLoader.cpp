@@ -0,0 +1,295 @@
+#include <db/BulkLoader.h>
+#include <db/Database.h>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace db;
+
+namespace {
+    /**
+     * Layout of the pages of a table, as HeapPage reads them.
+     */
+    struct PageLayout {
+        size_t pageSize;
+        size_t tupleSize;
+        size_t numSlots;
+        size_t headerSize;
+        std::vector<Types::Type> types;
+
+        explicit PageLayout(const TupleDesc &td)
+                : pageSize(Database::getBufferPool().getPageSize()), tupleSize(td.getSize()),
+                  numSlots(pageSize * 8 / (tupleSize * 8 + 1)), headerSize(pageSize - tupleSize * numSlots) {
+            for (const auto &item: td) {
+                types.push_back(item.fieldType);
+            }
+        }
+    };
+
+    /**
+     * Page images filled one tuple at a time.
+     */
+    class PageBuilder {
+        const PageLayout *layout;
+        std::vector<uint8_t> pages;
+        size_t numPages = 0;
+        /** Slot of the next tuple in the last page */
+        size_t slot = 0;
+
+    public:
+        long rows = 0;
+
+        explicit PageBuilder(const PageLayout &layout) : layout(&layout) {}
+
+        /**
+         * @return the bytes of the next tuple, zeroed, with its slot marked used
+         */
+        uint8_t *nextTuple() {
+            if (slot == 0) {
+                numPages++;
+                pages.resize(numPages * layout->pageSize);
+            }
+            uint8_t *page = pages.data() + (numPages - 1) * layout->pageSize;
+            page[slot >> 3] |= 1 << (slot & 7);
+            uint8_t *tuple = page + layout->headerSize + slot * layout->tupleSize;
+            slot = (slot + 1) % layout->numSlots;
+            rows++;
+            return tuple;
+        }
+
+        /**
+         * Append n tuples laid out back to back, a run of slots at a time.
+         */
+        void appendTuples(const uint8_t *tuples, size_t n) {
+            while (n > 0) {
+                if (slot == 0) {
+                    numPages++;
+                    pages.resize(numPages * layout->pageSize);
+                }
+                uint8_t *page = pages.data() + (numPages - 1) * layout->pageSize;
+                size_t run = std::min(n, layout->numSlots - slot);
+                memcpy(page + layout->headerSize + slot * layout->tupleSize, tuples, run * layout->tupleSize);
+                for (size_t i = slot; i < slot + run; i++) {
+                    page[i >> 3] |= 1 << (i & 7);
+                }
+                tuples += run * layout->tupleSize;
+                n -= run;
+                rows += static_cast<long>(run);
+                slot = (slot + run) % layout->numSlots;
+            }
+        }
+
+        void reserve(size_t numPages) { pages.reserve(numPages * layout->pageSize); }
+
+        const uint8_t *data() const { return pages.data(); }
+
+        size_t getNumPages() const { return numPages; }
+
+        size_t getFullPages() const { return slot == 0 ? numPages : numPages - 1; }
+
+        /**
+         * @return the number of tuples in the last page if it is not full, 0 otherwise
+         */
+        size_t getPartialTuples() const { return slot; }
+
+        const uint8_t *getPartialTuple(size_t i) const {
+            return pages.data() + (numPages - 1) * layout->pageSize + layout->headerSize + i * layout->tupleSize;
+        }
+
+        /**
+         * Forget the full pages, keeping the last page if it is not full.
+         */
+        void dropFullPages() {
+            size_t full = getFullPages();
+            if (full == 0) {
+                return;
+            }
+            if (slot != 0) {
+                memmove(pages.data(), pages.data() + full * layout->pageSize, layout->pageSize);
+            }
+            numPages -= full;
+            pages.resize(numPages * layout->pageSize);
+        }
+    };
+
+    [[noreturn]] void malformed(size_t offset) {
+        throw std::runtime_error("malformed row at offset " + std::to_string(offset));
+    }
+
+    /**
+     * Parse the CSV rows in [first, last) of data, which starts and ends on a row boundary.
+     */
+    PageBuilder parseCsv(const PageLayout &layout, const uint8_t *data, size_t first, size_t last) {
+        PageBuilder builder(layout);
+        auto *p = reinterpret_cast<const char *>(data) + first;
+        auto *end = reinterpret_cast<const char *>(data) + last;
+        while (p < end) {
+            auto *lineEnd = static_cast<const char *>(memchr(p, '\n', end - p));
+            auto *next = lineEnd ? lineEnd + 1 : end;
+            if (!lineEnd) {
+                lineEnd = end;
+            }
+            if (lineEnd > p && lineEnd[-1] == '\r') {
+                lineEnd--;
+            }
+            if (lineEnd == p) {
+                p = next;
+                continue;
+            }
+            size_t offset = p - reinterpret_cast<const char *>(data);
+            uint8_t *tuple = builder.nextTuple();
+            for (size_t i = 0; i < layout.types.size(); i++) {
+                if (i > 0) {
+                    if (p == lineEnd || *p != ',') {
+                        malformed(offset);
+                    }
+                    p++;
+                }
+                if (layout.types[i] == Types::INT_TYPE) {
+                    int value;
+                    auto [ptr, ec] = std::from_chars(p, lineEnd, value);
+                    if (ec != std::errc()) {
+                        malformed(offset);
+                    }
+                    memcpy(tuple, &value, sizeof(int));
+                    p = ptr;
+                } else {
+                    const char *value = p;
+                    if (p < lineEnd && *p == '"') {
+                        value = ++p;
+                        p = static_cast<const char *>(memchr(p, '"', lineEnd - p));
+                        if (!p) {
+                            malformed(offset);
+                        }
+                    } else {
+                        p = std::find(p, lineEnd, ',');
+                    }
+                    // truncated like StringField does
+                    int len = static_cast<int>(std::min<size_t>(p - value, Types::STRING_LEN - 1));
+                    memcpy(tuple, &len, sizeof(int));
+                    memcpy(tuple + sizeof(int), value, len);
+                    if (p < lineEnd && *p == '"') {
+                        p++;
+                    }
+                }
+                tuple += Types::getLen(layout.types[i]);
+            }
+            if (p != lineEnd) {
+                malformed(offset);
+            }
+            p = next;
+        }
+        return builder;
+    }
+
+    PageBuilder parseBinary(const PageLayout &layout, const uint8_t *data, size_t first, size_t last) {
+        PageBuilder builder(layout);
+        size_t rows = (last - first) / layout.tupleSize;
+        builder.reserve((rows + layout.numSlots - 1) / layout.numSlots);
+        builder.appendTuples(data + first, rows);
+        return builder;
+    }
+}
+
+BulkLoader::BulkLoader(HeapFile &file, BulkFormat format, int threads) : file(file), format(format) {
+    this->threads = threads > 0 ? threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+void BulkLoader::setChunkSize(size_t bytes) {
+    chunkSize = std::max<size_t>(bytes, 1);
+}
+
+BulkLoadStats BulkLoader::load(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error("open");
+    }
+    struct stat st{};
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        throw std::runtime_error("fstat");
+    }
+    auto size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        close(fd);
+        return {0, 0};
+    }
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("mmap");
+    }
+    madvise(addr, size, MADV_SEQUENTIAL);
+    try {
+        BulkLoadStats stats = load(static_cast<const uint8_t *>(addr), size);
+        munmap(addr, size);
+        return stats;
+    } catch (...) {
+        munmap(addr, size);
+        throw;
+    }
+}
+
+BulkLoadStats BulkLoader::load(const uint8_t *data, size_t size) {
+    PageLayout layout(file.getTupleDesc());
+    if (format == BulkFormat::BINARY && size % layout.tupleSize != 0) {
+        throw std::runtime_error("binary input is not a whole number of rows");
+    }
+
+    // chunks are parsed by up to threads workers and appended in input order
+    std::deque<std::future<PageBuilder>> parsing;
+    size_t next = 0;
+    auto startChunk = [&]() {
+        if (next == size) {
+            return;
+        }
+        size_t first = next;
+        size_t last;
+        if (format == BulkFormat::CSV) {
+            last = std::min(first + chunkSize, size);
+            auto *newline = static_cast<const uint8_t *>(memchr(data + last - 1, '\n', size - last + 1));
+            last = newline ? newline - data + 1 : size;
+            parsing.push_back(std::async(std::launch::async, parseCsv, std::cref(layout), data, first, last));
+        } else {
+            // whole pages, so that only the last chunk leaves a partial page
+            size_t pageRows = layout.numSlots * layout.tupleSize;
+            last = std::min(first + std::max<size_t>(chunkSize / pageRows, 1) * pageRows, size);
+            parsing.push_back(std::async(std::launch::async, parseBinary, std::cref(layout), data, first, last));
+        }
+        next = last;
+    };
+    for (int i = 0; i < threads; i++) {
+        startChunk();
+    }
+
+    BulkLoadStats stats{0, 0};
+    // the rows left over by the chunks
+    PageBuilder tail(layout);
+    while (!parsing.empty()) {
+        PageBuilder chunk = parsing.front().get();
+        parsing.pop_front();
+        startChunk();
+        file.appendPages(chunk.data(), static_cast<int>(chunk.getFullPages()));
+        for (size_t i = 0; i < chunk.getPartialTuples(); i++) {
+            memcpy(tail.nextTuple(), chunk.getPartialTuple(i), layout.tupleSize);
+        }
+        file.appendPages(tail.data(), static_cast<int>(tail.getFullPages()));
+        stats.rows += chunk.rows;
+        stats.pages += static_cast<int>(chunk.getFullPages() + tail.getFullPages());
+        tail.dropFullPages();
+    }
+    file.appendPages(tail.data(), static_cast<int>(tail.getNumPages()));
+    stats.pages += static_cast<int>(tail.getNumPages());
+    file.sync();
+    return stats;
+}
@@ -0,0 +1,120 @@
+#include <db/Checkpointer.h>
+#include <db/BufferPool.h>
+#include <db/Database.h>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+using namespace db;
+
+Checkpointer::Checkpointer(BufferPool &bufferPool) : bufferPool(bufferPool) {}
+
+Checkpointer::~Checkpointer() {
+    {
+        std::lock_guard lock(latch);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void Checkpointer::setDuration(int ms) {
+    durationMs.store(std::max(ms, 0), std::memory_order_relaxed);
+}
+
+void Checkpointer::setMaxRate(int pages) {
+    maxPagesPerSecond.store(std::max(pages, 0), std::memory_order_relaxed);
+}
+
+void Checkpointer::setBatchSize(int pages) {
+    batchPages.store(std::max(pages, 1), std::memory_order_relaxed);
+}
+
+void Checkpointer::setPeriod(int ms) {
+    {
+        std::lock_guard lock(latch);
+        period = std::chrono::milliseconds(std::max(ms, 0));
+        if (ms > 0 && !worker.joinable() && !stopping) {
+            worker = std::thread(&Checkpointer::run, this);
+        }
+    }
+    cv.notify_all();
+}
+
+bool Checkpointer::sleepUntil(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock lock(latch);
+    return !cv.wait_until(lock, deadline, [this] { return stopping; });
+}
+
+bool Checkpointer::checkpoint() {
+    LogManager *log = bufferPool.getLog();
+    if (log == nullptr) {
+        throw std::runtime_error("Checkpoints require a write-ahead log");
+    }
+    std::lock_guard runningLock(running);
+    uint64_t redoLsn;
+    std::vector<SnapshotPage> pages = bufferPool.snapshotDirtyPages(redoLsn);
+
+    // pages per second that spreads the writes over the duration, within the rate limit
+    double rate = static_cast<double>(pages.size()) * 1000 / std::max(durationMs.load(std::memory_order_relaxed), 1);
+    if (int limit = maxPagesPerSecond.load(std::memory_order_relaxed); limit > 0) {
+        rate = std::min(rate, static_cast<double>(limit));
+    }
+    auto batch = static_cast<size_t>(batchPages.load(std::memory_order_relaxed));
+    auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < pages.size(); first += batch) {
+        size_t last = std::min(first + batch, pages.size());
+        if (first > 0) {
+            auto due = std::chrono::duration<double>(static_cast<double>(first) / rate);
+            if (!sleepUntil(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(due))) {
+                return false;
+            }
+        }
+        // the pages written since the snapshot are clean and skipped
+        std::vector<SnapshotPage> slice(pages.begin() + first, pages.begin() + last);
+        size_t written = bufferPool.flushSnapshotPages(slice);
+        pagesWritten.fetch_add(static_cast<long>(written), std::memory_order_relaxed);
+    }
+
+    std::unordered_set<int> tables;
+    std::vector<std::pair<int, int>> ids;
+    for (const SnapshotPage &page: pages) {
+        tables.insert(page.tableId);
+        ids.emplace_back(page.tableId, page.pageNo);
+    }
+    for (int tableId: tables) {
+        Database::getCatalog().getDatabaseFile(tableId)->sync();
+    }
+    log->checkpoint(redoLsn, ids);
+    lastRedoLsn.store(redoLsn, std::memory_order_relaxed);
+    checkpoints.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void Checkpointer::run() {
+    std::unique_lock lock(latch);
+    while (true) {
+        cv.wait_for(lock, period, [this] { return stopping; });
+        if (stopping) {
+            return;
+        }
+        if (period.count() == 0) {
+            cv.wait(lock, [this] { return stopping || period.count() > 0; });
+            continue;
+        }
+        lock.unlock();
+        try {
+            checkpoint();
+        } catch (const std::exception &) {
+            // retried on the next period
+        }
+        lock.lock();
+    }
+}
+
+CheckpointerStats Checkpointer::getStats() const {
+    return {checkpoints.load(std::memory_order_relaxed), pagesWritten.load(std::memory_order_relaxed),
+            lastRedoLsn.load(std::memory_order_relaxed)};
+}
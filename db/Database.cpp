@@ -9,14 +9,15 @@ BufferPool &Database::getBufferPool() { return bufferpool; }
 
 Catalog &Database::getCatalog() { return catalog; }
 
-void Database::resetBufferPool(int pages) {
+void Database::resetBufferPool(int pages, ReplacementPolicyType policyType, int numShards, bool hugePages) {
     bufferpool.~BufferPool();
-    new(&bufferpool) BufferPool(pages);
+    new(&bufferpool) BufferPool(pages, policyType, numShards, hugePages);
 }
 
 void Database::reset() {
-    catalog.~Catalog();
+    // stop the prefetcher before the files it reads go away
     bufferpool.~BufferPool();
+    catalog.~Catalog();
     new(&catalog) Catalog;
     new(&bufferpool) BufferPool(BufferPool::DEFAULT_PAGES);
 }
@@ -0,0 +1,32 @@
+#include <db/DirtyPageIndex.h>
+
+using namespace db;
+
+void DirtyPageIndex::add(const TransactionId &tid, size_t frame, int tableId) {
+    std::lock_guard lock(latch);
+    Entry &entry = entries[tid];
+    entry.frames.insert(frame);
+    entry.tables.insert(tableId);
+}
+
+std::vector<size_t> DirtyPageIndex::get(const TransactionId &tid) {
+    std::lock_guard lock(latch);
+    auto it = entries.find(tid);
+    if (it == entries.end()) {
+        return {};
+    }
+    return {it->second.frames.begin(), it->second.frames.end()};
+}
+
+std::vector<size_t> DirtyPageIndex::take(const TransactionId &tid, std::unordered_set<int> &tables) {
+    std::lock_guard lock(latch);
+    auto it = entries.find(tid);
+    if (it == entries.end()) {
+        tables.clear();
+        return {};
+    }
+    std::vector<size_t> taken(it->second.frames.begin(), it->second.frames.end());
+    tables = std::move(it->second.tables);
+    entries.erase(it);
+    return taken;
+}
@@ -0,0 +1,37 @@
+#include <db/FrameArena.h>
+#include <algorithm>
+#include <stdexcept>
+#include <sys/mman.h>
+
+using namespace db;
+
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+FrameArena::FrameArena(size_t numFrames, size_t frameSize, bool useHugePages)
+        : frameSize((frameSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT), numFrames(numFrames) {
+    length = std::max<size_t>(this->frameSize * numFrames, ALIGNMENT);
+    void *p = MAP_FAILED;
+    if (useHugePages) {
+        size_t hugeLength = (length + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        p = mmap(nullptr, hugeLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            length = hugeLength;
+            hugePages = true;
+        }
+    }
+    if (p == MAP_FAILED) {
+        // the frames are touched up front so the pool does not fault while reading pages
+        p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("mmap");
+        }
+        if (useHugePages) {
+            madvise(p, length, MADV_HUGEPAGE);
+        }
+    }
+    base = static_cast<uint8_t *>(p);
+}
+
+FrameArena::~FrameArena() {
+    munmap(base, length);
+}
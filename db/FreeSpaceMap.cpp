@@ -0,0 +1,125 @@
+#include <db/FreeSpaceMap.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace db;
+
+namespace {
+    struct Header {
+        char magic[8];
+        int64_t heapModificationTime;
+        int32_t numPages;
+        int32_t reserved;
+    };
+}
+
+FreeSpaceMap::FreeSpaceMap(const std::string &path, int heapFd, int numPages) : heapFd(heapFd), numPages(0) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1) {
+        throw std::runtime_error("open");
+    }
+    Header header{};
+    if (pread(fd, &header, sizeof(header), 0) == sizeof(header) && memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+        header.heapModificationTime == getModificationTime(heapFd) && header.numPages <= numPages) {
+        words.resize((header.numPages + 63) / 64);
+        auto size = static_cast<ssize_t>(words.size() * sizeof(uint64_t));
+        if (pread(fd, words.data(), size, sizeof(header)) == size) {
+            this->numPages = header.numPages;
+        } else {
+            words.clear();
+        }
+    }
+    // pages the saved map does not cover, or all of them, are checked by the inserts
+    setAll(this->numPages, numPages);
+}
+
+FreeSpaceMap::~FreeSpaceMap() {
+    close(fd);
+}
+
+int64_t FreeSpaceMap::getModificationTime(int fd) {
+    struct stat st{};
+    if (fstat(fd, &st) == -1) {
+        throw std::runtime_error("fstat");
+    }
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+void FreeSpaceMap::setAll(int from, int to) {
+    for (int pgNo = from; pgNo < to; pgNo++) {
+        update(pgNo, true);
+    }
+}
+
+int FreeSpaceMap::find(int pgNo) {
+    std::lock_guard lock(latch);
+    size_t word = std::max(firstWord, static_cast<size_t>(pgNo) / 64);
+    // the bits of the pages before pgNo are ignored
+    uint64_t mask = word == static_cast<size_t>(pgNo) / 64 ? ~uint64_t{0} << (pgNo % 64) : ~uint64_t{0};
+    for (; word < words.size(); word++, mask = ~uint64_t{0}) {
+        if (uint64_t bits = words[word] & mask) {
+            return static_cast<int>(word * 64 + __builtin_ctzll(bits));
+        }
+        if (word == firstWord && words[word] == 0) {
+            firstWord++;
+        }
+    }
+    return -1;
+}
+
+void FreeSpaceMap::update(int pgNo, bool free) {
+    std::lock_guard lock(latch);
+    auto word = static_cast<size_t>(pgNo) / 64;
+    uint64_t bit = uint64_t{1} << (pgNo % 64);
+    if (pgNo >= numPages) {
+        numPages = pgNo + 1;
+        words.resize((numPages + 63) / 64);
+        dirty = true;
+    }
+    if (((words[word] & bit) != 0) == free) {
+        return;
+    }
+    if (free) {
+        words[word] |= bit;
+        firstWord = std::min(firstWord, word);
+    } else {
+        words[word] &= ~bit;
+    }
+    dirty = true;
+}
+
+void FreeSpaceMap::truncate(int numPages) {
+    std::lock_guard lock(latch);
+    if (numPages >= this->numPages) {
+        return;
+    }
+    this->numPages = numPages;
+    words.resize((numPages + 63) / 64);
+    if (numPages % 64 != 0) {
+        words.back() &= (uint64_t{1} << (numPages % 64)) - 1;
+    }
+    firstWord = std::min(firstWord, words.size());
+    dirty = true;
+}
+
+void FreeSpaceMap::save(bool force) {
+    std::lock_guard lock(latch);
+    if (!dirty && !force) {
+        return;
+    }
+    Header header{};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.heapModificationTime = getModificationTime(heapFd);
+    header.numPages = numPages;
+    auto size = static_cast<ssize_t>(words.size() * sizeof(uint64_t));
+    if (pwrite(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        pwrite(fd, words.data(), size, sizeof(header)) != size ||
+        ftruncate(fd, static_cast<off_t>(sizeof(header)) + size) == -1) {
+        throw std::runtime_error("write");
+    }
+    dirty = false;
+}
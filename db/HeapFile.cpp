@@ -4,37 +4,154 @@
 #include <db/HeapPage.h>
 #include <db/BufferPool.h>
 #include <db/Database.h>
+#include <algorithm>
+#include <climits>
+#include <mutex>
 #include <unistd.h>
 
 using namespace db;
 
-std::vector<Page *> HeapFile::insertTuple(TransactionId tid, Tuple &t) {
-    BufferPool &bufferPool = Database::getBufferPool();
-    HeapPage *page = nullptr;
-    for (int i = 0; i < numPages; i++) {
-        auto *pid = new HeapPageId(tableid, i);
-        auto *currPage = dynamic_cast<HeapPage *>(bufferPool.getPage(pid));
-        if (currPage->getNumEmptySlots() > 0) {
-            page = dynamic_cast<HeapPage *>(bufferPool.getPage(pid));
-            break;
+Page *HeapFile::createPage(const HeapPageId &pid, uint8_t *frame) {
+    return new HeapPage(pid, frame);
+}
+
+void *HeapFile::createEmptyPageData() const {
+    return HeapPage::createEmptyPageData();
+}
+
+bool HeapFile::hasRoom(const Page *page, const Tuple &) const {
+    return isFree(page);
+}
+
+bool HeapFile::isFree(const Page *page) const {
+    return dynamic_cast<const HeapPage *>(page)->getNumEmptySlots() > 0;
+}
+
+void HeapFile::insertInto(Page *page, Tuple &t) {
+    dynamic_cast<HeapPage *>(page)->insertTuple(&t);
+}
+
+void HeapFile::deleteFrom(Page *page, Tuple &t) {
+    dynamic_cast<HeapPage *>(page)->deleteTuple(&t);
+}
+
+void HeapFile::writePage(Page *p) {
+    writePages({p});
+}
+
+void HeapFile::setSectorWrites(bool enable) {
+    // a backend that only writes whole blocks would reject the sectors
+    sectorWrites.store(enable && io->getAlignment() <= HeapPage::SECTOR_SIZE, std::memory_order_relaxed);
+}
+
+void HeapFile::writeSectors(HeapPage *page) {
+    auto page_size = static_cast<size_t>(Database::getBufferPool().getPageSize());
+    std::vector<bool> sectors = page->takeUnwrittenSectors();
+    const uint8_t *image = page->getImage();
+    off_t base = static_cast<off_t>(page->getId().pageNumber()) * page_size;
+    size_t first = 0;
+    while (first < sectors.size()) {
+        if (!sectors[first]) {
+            first++;
+            continue;
+        }
+        size_t last = first;
+        while (last < sectors.size() && sectors[last]) {
+            last++;
         }
+        size_t start = first * HeapPage::SECTOR_SIZE;
+        size_t len = std::min(last * HeapPage::SECTOR_SIZE, page_size) - start;
+        if (io->write(fd, image + start, len, base + static_cast<off_t>(start)) != static_cast<ssize_t>(len)) {
+            page->restoreUnwrittenSectors(sectors);
+            throw std::runtime_error("write");
+        }
+        first = last;
     }
-    if (page == nullptr) {
-        page = new HeapPage(HeapPageId(tableid, numPages), static_cast<uint8_t *>(HeapPage::createEmptyPageData()));
-        numPages++;
+}
+
+void HeapFile::writePages(const std::vector<Page *> &pages) {
+    auto page_size = Database::getBufferPool().getPageSize();
+    if (sectorWrites.load(std::memory_order_relaxed)) {
+        for (Page *page: pages) {
+            writeSectors(dynamic_cast<HeapPage *>(page));
+        }
+        return;
+    }
+    size_t first = 0;
+    while (first < pages.size()) {
+        // extend the run while the next page follows the previous one on disk
+        size_t last = first + 1;
+        while (last < pages.size() && last - first < IOV_MAX &&
+               pages[last]->getId().pageNumber() == pages[last - 1]->getId().pageNumber() + 1) {
+            last++;
+        }
+        std::vector<iovec> iov;
+        std::vector<std::vector<bool>> sectors;
+        size_t len = 0;
+        for (size_t i = first; i < last; i++) {
+            // the image is written as is, the whole page is written so the sectors are clean
+            auto *page = dynamic_cast<HeapPage *>(pages[i]);
+            sectors.push_back(page->takeUnwrittenSectors());
+            iov.push_back({const_cast<uint8_t *>(page->getImage()), static_cast<size_t>(page_size)});
+            len += page_size;
+        }
+        if (io->writev(fd, iov.data(), static_cast<int>(iov.size()), pages[first]->getId().pageNumber() * page_size) !=
+            static_cast<ssize_t>(len)) {
+            for (size_t i = first; i < last; i++) {
+                dynamic_cast<HeapPage *>(pages[i])->restoreUnwrittenSectors(sectors[i - first]);
+            }
+            throw std::runtime_error("writev");
+        }
+        first = last;
     }
-    page->insertTuple(&t);
-    return {page};
 }
 
-std::vector<Page *> HeapFile::deleteTuple(TransactionId tid, Tuple &t) {
-    auto *page = dynamic_cast<HeapPage *>(Database::getBufferPool().getPage(t.getRecordId()->getPageId()));
-    page->deleteTuple(&t);
-    return {page};
+void HeapFile::appendPages(const uint8_t *pages, int count) {
+    if (count == 0) {
+        return;
+    }
+    auto page_size = static_cast<size_t>(Database::getBufferPool().getPageSize());
+    size_t len = count * page_size;
+    std::lock_guard lock(sizeLatch);
+    auto offset = static_cast<off_t>(numPages) * static_cast<off_t>(page_size);
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = io->write(fd, pages + done, len - done, offset + static_cast<off_t>(done));
+        if (n <= 0) {
+            throw std::runtime_error("write");
+        }
+        done += n;
+    }
+    int numSlots = static_cast<int>(page_size * 8 / (td.getSize() * 8 + 1));
+    for (int i = 0; i < count; i++) {
+        const uint8_t *header = pages + i * page_size;
+        int used = 0;
+        for (int j = 0; j < (numSlots + 7) / 8; j++) {
+            used += __builtin_popcount(header[j]);
+        }
+        freeSpace->update(numPages + i, used < numSlots);
+    }
+    numPages += count;
 }
 
-void HeapFile::writePage(Page *p) {
-    auto data = p->getPageData();
-    auto offset = p->getId().pageNumber() * Database::getBufferPool().getPageSize();
-    pwrite(fd, data, Database::getBufferPool().getPageSize(), offset);
+bool HeapFile::truncate(int from, int to) {
+    if (mapping != nullptr) {
+        throw std::runtime_error("Cannot truncate a mapped file");
+    }
+    std::lock_guard lock(sizeLatch);
+    if (to != numPages || from >= to) {
+        return false;
+    }
+    // readers still holding a removed page keep it, a page read past the end is empty
+    for (int pgNo = from; pgNo < to; pgNo++) {
+        HeapPageId hpid(tableid, pgNo);
+        Database::getBufferPool().discardPage(&hpid);
+    }
+    auto page_size = static_cast<off_t>(Database::getBufferPool().getPageSize());
+    if (ftruncate(fd, from * page_size) == -1) {
+        throw std::runtime_error("ftruncate");
+    }
+    numPages = from;
+    freeSpace->truncate(from);
+    return true;
 }
@@ -4,7 +4,11 @@
 #include <db/Page.h>
 #include <db/PageId.h>
 #include <db/HeapPage.h>
+#include <algorithm>
 #include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
@@ -15,99 +19,87 @@ using namespace db;
 // HeapFile
 //
 
-HeapFile::HeapFile(const char *fname, const TupleDesc &td) : td(td) {
-    tableid = std::hash<std::string>{}(fname);
-    fd = open(fname, O_RDWR | O_CREAT, 0644);
-    if (fd == -1) {
-        throw std::runtime_error("open");
-    }
-    struct stat st{};
-    if (fstat(fd, &st) == -1) {
-        throw std::runtime_error("fstat");
+HeapFile::HeapFile(const char *fname, const TupleDesc &td, IoBackendType ioBackend)
+        : PagedFile(fname, td, ioBackend) {
+    if (ioBackend == IoBackendType::MMAP) {
+        size_t size = static_cast<size_t>(numPages) * Database::getBufferPool().getPageSize();
+        if (size > 0) {
+            void *addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (addr == MAP_FAILED) {
+                throw std::runtime_error("mmap");
+            }
+            mapping = static_cast<uint8_t *>(addr);
+            mappedSize = size;
+        }
     }
-    numPages = st.st_size / Database::getBufferPool().getPageSize();
 }
 
-int HeapFile::getId() const {
-    return tableid;
+HeapFile::~HeapFile() {
+    if (mapping != nullptr) {
+        munmap(mapping, mappedSize);
+    }
 }
 
-const TupleDesc &HeapFile::getTupleDesc() const {
-    return td;
+uint8_t *HeapFile::getMappedPage(int pgNo) const {
+    size_t page_size = Database::getBufferPool().getPageSize();
+    size_t offset = static_cast<size_t>(pgNo) * page_size;
+    if (mapping == nullptr || offset + page_size > mappedSize) {
+        return nullptr;
+    }
+    return mapping + offset;
 }
 
-Page *HeapFile::readPage(const PageId &pid) {
-    auto page_size = Database::getBufferPool().getPageSize();
-    uint8_t *data = new uint8_t[page_size];
+Page *HeapFile::readPage(const PageId &pid, uint8_t *frame) {
     const HeapPageId *hpid = dynamic_cast<const HeapPageId *>(&pid);
-    pread(fd, data, page_size, hpid->pageNumber() * page_size);
-    HeapPage *page = new HeapPage(*hpid, data);
-    return page;
+    if (uint8_t *mapped = getMappedPage(hpid->pageNumber())) {
+        // writes go through pwrite, which updates the same page cache pages the mapping shows.
+        // The page only copies itself to the frame if it is updated.
+        return new HeapPage(*hpid, mapped, frame);
+    }
+    return PagedFile::readPage(pid, frame);
 }
 
-int HeapFile::getNumPages() const {
-    return numPages;
+void HeapFile::readPages(const std::vector<const PageId *> &pids, const std::vector<uint8_t *> &frames,
+                         const std::function<void(size_t, Page *)> &callback) {
+    auto page_size = Database::getBufferPool().getPageSize();
+    std::vector<IoRequest> requests;
+    requests.reserve(pids.size());
+    for (size_t i = 0; i < pids.size(); i++) {
+        const HeapPageId *hpid = dynamic_cast<const HeapPageId *>(pids[i]);
+        if (uint8_t *mapped = getMappedPage(hpid->pageNumber())) {
+            callback(i, new HeapPage(*hpid, mapped, frames[i]));
+            continue;
+        }
+        uint8_t *frame = frames[i];
+        requests.push_back({frame, static_cast<size_t>(page_size), static_cast<off_t>(hpid->pageNumber()) * page_size,
+                            [&callback, hpid, frame, page_size, i](ssize_t n) {
+                                if (n < 0) {
+                                    errno = static_cast<int>(-n);
+                                    n = -1;
+                                }
+                                checkRead(n, frame, page_size);
+                                callback(i, new HeapPage(*hpid, frame));
+                            }});
+    }
+    io->readBatch(fd, requests);
 }
 
 HeapFileIterator HeapFile::begin() const {
-    return *new HeapFileIterator(getId(), getNumPages());
+    return scan(0, getNumPages()).begin();
 }
 
 HeapFileIterator HeapFile::end() const {
-    return {getId(), getNumPages(), true};
+    return scan(0, getNumPages()).end();
 }
 
-//
-// HeapFileIterator
-//
-
-HeapFileIterator::HeapFileIterator(int tableid, int numPages, bool end) : hpid(tableid, 0) {
-    this->numPages = numPages;
-    this->end = end;
-    int pid;
-    if (end) {
-        pid = numPages;
-    } else {
-        pid = 0;
-    }
-    hpid = {tableid, pid};
-    if (end) {
-    } else {
-        auto p = Database::getBufferPool().getPage(&hpid);
-        page = dynamic_cast<HeapPage *>(p);
-        if (!page) {
-            throw std::runtime_error("dynamic_cast");
+HeapFileRange HeapFile::scan(int pageLo, int pageHi) const {
+    pageHi = std::min(pageHi, getNumPages());
+    if (mapping != nullptr && pageLo < pageHi) {
+        size_t pageSize = Database::getBufferPool().getPageSize();
+        size_t length = std::min(mappedSize, pageHi * pageSize) - std::min(mappedSize, pageLo * pageSize);
+        if (length > 0) {
+            madvise(mapping + pageLo * pageSize, length, MADV_SEQUENTIAL);
         }
-        auto hpit = page->begin();
-        it = new HeapPageIterator(hpit);
-    }
-}
-
-bool HeapFileIterator::operator!=(const HeapFileIterator &other) const {
-    return hpid != other.hpid || end != other.end;
-}
-
-Tuple &HeapFileIterator::operator*() const {
-    return *(*it);
-}
-
-HeapFileIterator &HeapFileIterator::operator++() {
-    ++(*it);
-    if (*it != page->end()) {
-        return *this;
-    }
-    delete it;
-    hpid = {hpid.getTableId(), hpid.pageNumber() + 1};
-    if (hpid.pageNumber() >= numPages) {
-        end = true;
-        return *this;
-    }
-    auto p = Database::getBufferPool().getPage(&hpid);
-    page = dynamic_cast<HeapPage *>(p);
-    if (!page) {
-        throw std::runtime_error("dynamic_cast");
     }
-    auto hpit = page->begin();
-    it = new HeapPageIterator(hpit);
-    return *this;
+    return {getId(), pageLo, pageHi};
 }
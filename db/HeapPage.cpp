@@ -1,14 +1,15 @@
 #include <db/HeapPage.h>
+#include <db/Database.h>
+#include <db/SlotBitmap.h>
+#include <cstring>
+#include <utility>
 
 using namespace db;
 
 void HeapPage::markSlotUsed(int i, bool value) {
-    int headerbyte = i >> 3;
-    int headerbit = i & 0b111;
-    if (value)
-        header[headerbyte] |= 1 << headerbit;
-    else
-        header[headerbyte] &= (0xFF ^ (1 << headerbit));
+    if (SlotBitmap::assign(image, i, value)) {
+        numUsed += value ? 1 : -1;
+    }
 }
 
 void HeapPage::deleteTuple(Tuple *t) {
@@ -19,7 +20,12 @@ void HeapPage::deleteTuple(Tuple *t) {
     if (!isSlotUsed(tupleNumber)) {
         throw std::runtime_error("Empty slot");
     }
+    size_t offset = headerSize + tupleNumber * tupleSize;
+    beginUpdate(tupleNumber >> 3, 1);
+    beginUpdate(offset, tupleSize);
     markSlotUsed(tupleNumber, false);
+    // empty slots are zeroed on disk
+    memset(image + offset, 0, tupleSize);
 }
 
 void HeapPage::insertTuple(Tuple *t) {
@@ -30,11 +36,42 @@ void HeapPage::insertTuple(Tuple *t) {
         throw std::runtime_error("Wrong tuple description");
     }
 
-    int slotIndex = 0;
-    while (isSlotUsed(slotIndex)) {
-        slotIndex++;
-    }
+    int slotIndex = SlotBitmap::next(image, numSlots, 0, false);
+    size_t offset = headerSize + slotIndex * tupleSize;
+    beginUpdate(slotIndex >> 3, 1);
+    beginUpdate(offset, tupleSize);
     markSlotUsed(slotIndex, true);
+    uint8_t *data = image + offset;
+    for (int i = 0; i < td.numFields(); i++) {
+        t->getField(i).serialize(data + offsets[i]);
+    }
     t->setRecordId(new RecordId(&pid, slotIndex));
-    tuples[slotIndex] = *t;
+    std::lock_guard lock(latch);
+    // what was decoded from the slot before a delete is kept for its readers until reclaim
+    if (decoded[slotIndex]) {
+        retiredTuples.push_back(std::move(decoded[slotIndex]));
+    }
+    if (!decodedFields.empty()) {
+        for (int i = 0; i < td.numFields(); i++) {
+            const Field *&f = decodedFields[slotIndex * td.numFields() + i];
+            if (f != nullptr) {
+                retiredFields.push_back(f);
+                f = nullptr;
+            }
+        }
+    }
+}
+
+void HeapPage::reclaim() {
+    std::lock_guard lock(latch);
+    for (const Field *f: retiredFields) {
+        delete f;
+    }
+    retiredFields.clear();
+    retiredTuples.clear();
+}
+
+size_t HeapPage::getNumRetired() const {
+    std::lock_guard lock(latch);
+    return retiredTuples.size() + retiredFields.size();
 }
@@ -1,14 +1,14 @@
 #include <db/HeapPage.h>
 #include <db/Database.h>
+#include <db/SlotBitmap.h>
+#include <algorithm>
 
 using namespace db;
 
 HeapPageIterator::HeapPageIterator(int i, const HeapPage *page) {
     this->slot = i;
     this->page = page;
-    while (slot < page->numSlots && !page->isSlotUsed(slot)) {
-        slot++;
-    }
+    this->slot = SlotBitmap::next(page->image, page->numSlots, i, true);
 }
 
 bool HeapPageIterator::operator!=(const HeapPageIterator &other) const {
@@ -16,33 +16,43 @@ bool HeapPageIterator::operator!=(const HeapPageIterator &other) const {
 }
 
 HeapPageIterator &HeapPageIterator::operator++() {
-    do {
-        slot++;
-    } while (slot < page->numSlots && !page->isSlotUsed(slot));
+    slot = SlotBitmap::next(page->image, page->numSlots, slot + 1, true);
     return *this;
 }
 
 Tuple &HeapPageIterator::operator*() const {
-    return page->tuples[slot];
+    // tuples are only handed out as const by the page, they are never updated in place
+    return const_cast<Tuple &>(page->getTuple(slot));
 }
 
-HeapPage::HeapPage(const HeapPageId &id, uint8_t *data) : pid(id) {
+HeapPage::HeapPage(const HeapPageId &id, uint8_t *data, uint8_t *frame)
+        : pid(id), image(data), frame(frame ? frame : data), pageSize(Database::getBufferPool().getPageSize()) {
     this->td = Database::getCatalog().getTupleDesc(id.getTableId());
     this->numSlots = getNumTuples();
+    numUsed = SlotBitmap::count(image, numSlots);
+    headerSize = getHeaderSize();
+    tupleSize = td.getSize();
+    size_t offset = 0;
+    for (const auto &item: td) {
+        offsets.push_back(offset);
+        offset += Types::getLen(item.fieldType);
+    }
+    decoded.resize(numSlots);
+    recordIds.resize(numSlots);
+    size_t numSectors = (pageSize + SECTOR_SIZE - 1) / SECTOR_SIZE;
+    beforeSectors.resize(numSectors);
+    unwrittenSectors.resize(numSectors);
+}
 
-    // Allocate and read the header slots of this page
-    size_t header_size = getHeaderSize();
-    header = new uint8_t[header_size];
-    memcpy(header, data, header_size);
-    size_t offset = header_size;
-
-    tuples = new Tuple[numSlots];
-    size_t tuple_size = td.getSize();
-    for (int slot = 0; slot < numSlots; slot++) {
-        if (isSlotUsed(slot)) {
-            readTuple(tuples + slot, data + offset, slot);
-        }
-        offset += tuple_size;
+HeapPage::~HeapPage() {
+    for (const Field *f: retiredFields) {
+        delete f;
+    }
+    for (const Field *f: decodedFields) {
+        delete f;
+    }
+    for (const RecordId *rid: recordIds) {
+        delete rid;
     }
 }
 
@@ -58,42 +68,106 @@ const PageId &HeapPage::getId() const {
     return pid;
 }
 
-void HeapPage::readTuple(Tuple *t, uint8_t *data, int slotId) {
-    new(t) Tuple(td, new RecordId(&pid, slotId));
-    int i = 0;
-    for (const auto &item: td) {
-        Types::Type type = item.fieldType;
-        const Field *f = Types::parse(data, type);
-        data += Types::getLen(type);
-        t->setField(i, f);
-        i++;
+const Tuple &HeapPage::getTuple(int slot) const {
+    std::lock_guard lock(latch);
+    if (decoded[slot]) {
+        return *decoded[slot];
+    }
+    decoded[slot] = std::make_unique<Tuple>(td);
+    Tuple &t = *decoded[slot];
+    t.setRecordId(getRecordId(slot));
+    for (int i = 0; i < td.numFields(); i++) {
+        t.setField(i, decodeField(slot, i));
     }
+    return t;
 }
 
-void *HeapPage::getPageData() const {
-    auto *data = (uint8_t *) createEmptyPageData();
-    size_t header_size = getHeaderSize();
-
-    // Create the header of the page
-    memcpy(data, header, header_size);
-    size_t offset = header_size;
-    // Create the tuples
-    for (int i = 0; i < numSlots; i++) {
-        const Tuple &tuple = tuples[i];
-        // Empty slot
-        if (!isSlotUsed(i)) {
-            memset(data + offset, 0, td.getSize());
-            offset += td.getSize();
-        } else {
-            // Non-empty slot
-            for (int j = 0; j < td.numFields(); j++) {
-                const Field &f = tuple.getField(j);
-                f.serialize(data + offset);
-                offset += Types::getLen(f.getType());
-            }
+Tuple HeapPage::projectTuple(int slot, const std::vector<int> &columns, const TupleDesc &projected) const {
+    Tuple t(projected);
+    std::lock_guard lock(latch);
+    t.setRecordId(getRecordId(slot));
+    for (size_t i = 0; i < columns.size(); i++) {
+        t.setField(static_cast<int>(i), decodeField(slot, columns[i]));
+    }
+    return t;
+}
+
+const Field *HeapPage::decodeField(int slot, int i) const {
+    if (decodedFields.empty()) {
+        decodedFields.resize(numSlots * td.numFields());
+    }
+    const Field *&f = decodedFields[slot * td.numFields() + i];
+    if (f == nullptr) {
+        // Types::parse does not modify the data, it only takes it as non-const
+        f = Types::parse(const_cast<uint8_t *>(getTupleData(slot)) + offsets[i], td.getFieldType(i));
+    }
+    return f;
+}
+
+const RecordId *HeapPage::getRecordId(int slot) const {
+    if (recordIds[slot] == nullptr) {
+        recordIds[slot] = new RecordId(&pid, slot);
+    }
+    return recordIds[slot];
+}
+
+std::string_view HeapPage::getString(int slot, int i) const {
+    const uint8_t *data = getTupleData(slot) + offsets[i];
+    int len;
+    memcpy(&len, data, sizeof(len));
+    len = std::clamp(len, 0, static_cast<int>(Types::STRING_LEN));
+    return {reinterpret_cast<const char *>(data + sizeof(len)), static_cast<size_t>(len)};
+}
+
+void HeapPage::beginUpdate(size_t offset, size_t len) {
+    std::lock_guard lock(latch);
+    if (image != frame) {
+        // the mapping is read-only
+        memcpy(frame, image, pageSize);
+        image = frame;
+    }
+    for (size_t sector = offset / SECTOR_SIZE; sector <= (offset + len - 1) / SECTOR_SIZE; sector++) {
+        if (beforeSectors[sector].empty()) {
+            size_t start = sector * SECTOR_SIZE;
+            beforeSectors[sector].assign(image + start, image + std::min(start + SECTOR_SIZE, pageSize));
         }
+        unwrittenSectors[sector] = true;
     }
+}
 
+bool HeapPage::takeBeforeImage(uint8_t *before) {
+    std::lock_guard lock(latch);
+    bool updated = false;
+    memcpy(before, image, pageSize);
+    for (size_t sector = 0; sector < beforeSectors.size(); sector++) {
+        if (!beforeSectors[sector].empty()) {
+            memcpy(before + sector * SECTOR_SIZE, beforeSectors[sector].data(), beforeSectors[sector].size());
+            beforeSectors[sector].clear();
+            updated = true;
+        }
+    }
+    return updated;
+}
+
+std::vector<bool> HeapPage::takeUnwrittenSectors() {
+    std::lock_guard lock(latch);
+    std::vector<bool> sectors(unwrittenSectors.size());
+    sectors.swap(unwrittenSectors);
+    return sectors;
+}
+
+void HeapPage::restoreUnwrittenSectors(const std::vector<bool> &sectors) {
+    std::lock_guard lock(latch);
+    for (size_t sector = 0; sector < sectors.size(); sector++) {
+        if (sectors[sector]) {
+            unwrittenSectors[sector] = true;
+        }
+    }
+}
+
+void *HeapPage::getPageData() const {
+    auto *data = new uint8_t[pageSize];
+    memcpy(data, image, pageSize);
     return data;
 }
 
@@ -103,16 +177,11 @@ void *HeapPage::createEmptyPageData() {
 }
 
 int HeapPage::getNumEmptySlots() const {
-    int cnt = 0;
-    for (int i = 0; i < numSlots; i++)
-        if (!isSlotUsed(i)) cnt++;
-    return cnt;
+    return numSlots - numUsed;
 }
 
 bool HeapPage::isSlotUsed(int i) const {
-    int headerbyte = i >> 3;
-    int headerbit = i & 0b111;
-    return (header[headerbyte] >> headerbit & 1) != 0;
+    return SlotBitmap::test(image, i);
 }
 
 HeapPageIterator HeapPage::begin() const {
@@ -0,0 +1,340 @@
+#include <db/IoBackend.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace db;
+
+std::unique_ptr<IoBackend> IoBackend::create(IoBackendType type) {
+    switch (type) {
+        case IoBackendType::POSIX:
+        case IoBackendType::MMAP:
+            return std::make_unique<PosixIoBackend>();
+        case IoBackendType::IO_URING:
+            try {
+                return std::make_unique<UringIoBackend>();
+            } catch (const std::runtime_error &) {
+                // e.g. an old kernel, or io_uring disabled by a seccomp filter
+                return std::make_unique<PosixIoBackend>();
+            }
+        default:
+            throw std::invalid_argument("unexpected I/O backend");
+    }
+}
+
+//
+// PosixIoBackend
+//
+
+ssize_t PosixIoBackend::read(int fd, void *buf, size_t len, off_t offset) {
+    return pread(fd, buf, len, offset);
+}
+
+ssize_t PosixIoBackend::write(int fd, const void *buf, size_t len, off_t offset) {
+    return pwrite(fd, buf, len, offset);
+}
+
+ssize_t PosixIoBackend::writev(int fd, const iovec *iov, int iovcnt, off_t offset) {
+    return pwritev(fd, iov, iovcnt, offset);
+}
+
+void PosixIoBackend::readBatch(int fd, std::vector<IoRequest> &requests) {
+    for (auto &request: requests) {
+        ssize_t n = pread(fd, request.buf, request.len, request.offset);
+        request.callback(n < 0 ? -errno : n);
+    }
+}
+
+//
+// UringIoBackend
+//
+
+/**
+ * The rings shared with the kernel, see io_uring_setup(2).
+ */
+struct UringIoBackend::Ring {
+    int fd = -1;
+    void *sqPtr = MAP_FAILED;
+    size_t sqLen = 0;
+    void *cqPtr = MAP_FAILED;
+    size_t cqLen = 0;
+    io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+    size_t sqesLen = 0;
+    unsigned entries = 0;
+
+    unsigned *sqTail = nullptr;
+    unsigned *sqMask = nullptr;
+    unsigned *sqArray = nullptr;
+    unsigned *cqHead = nullptr;
+    unsigned *cqTail = nullptr;
+    unsigned *cqMask = nullptr;
+    io_uring_cqe *cqes = nullptr;
+
+    Ring() {
+        io_uring_params params{};
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params));
+        if (fd < 0) {
+            throw std::runtime_error("io_uring_setup");
+        }
+        entries = params.sq_entries;
+        sqLen = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqLen = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) {
+            sqLen = cqLen = std::max(sqLen, cqLen);
+        }
+        sqPtr = mmap(nullptr, sqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqPtr == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("mmap");
+        }
+        cqPtr = single ? sqPtr : mmap(nullptr, cqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                      IORING_OFF_CQ_RING);
+        sqesLen = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqesPtr = mmap(nullptr, sqesLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                             IORING_OFF_SQES);
+        sqes = static_cast<io_uring_sqe *>(sqesPtr);
+        if (cqPtr == MAP_FAILED || sqesPtr == MAP_FAILED) {
+            release();
+            throw std::runtime_error("mmap");
+        }
+
+        auto *sq = static_cast<uint8_t *>(sqPtr);
+        sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        auto *cq = static_cast<uint8_t *>(cqPtr);
+        cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    }
+
+    ~Ring() {
+        release();
+    }
+
+    void release() {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqesLen);
+        }
+        if (cqPtr != MAP_FAILED && cqPtr != sqPtr) {
+            munmap(cqPtr, cqLen);
+        }
+        if (sqPtr != MAP_FAILED) {
+            munmap(sqPtr, sqLen);
+        }
+        close(fd);
+    }
+};
+
+static bool isAligned(const void *buf, size_t len, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(buf) % alignment == 0 && len % alignment == 0;
+}
+
+static size_t alignUp(size_t len, size_t alignment) {
+    return (len + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Copy the bytes [skip, skip + len) of a read of n bytes into bounce out to buf.
+ * @return the number of bytes copied, or n if the read failed
+ */
+static ssize_t copyOut(void *buf, size_t len, const void *bounce, size_t skip, ssize_t n) {
+    if (n < 0) {
+        return n;
+    }
+    size_t copied = static_cast<size_t>(n) > skip ? std::min(static_cast<size_t>(n) - skip, len) : 0;
+    memcpy(buf, static_cast<const uint8_t *>(bounce) + skip, copied);
+    return static_cast<ssize_t>(copied);
+}
+
+UringIoBackend::UringIoBackend() : ring(std::make_unique<Ring>()) {}
+
+UringIoBackend::~UringIoBackend() = default;
+
+int UringIoBackend::getOpenFlags() const {
+    return O_DIRECT;
+}
+
+ssize_t UringIoBackend::read(int fd, void *buf, size_t len, off_t offset) {
+    if (isAligned(buf, len, ALIGNMENT) && offset % ALIGNMENT == 0) {
+        return pread(fd, buf, len, offset);
+    }
+    // the aligned blocks around the range are read, then the range is copied out
+    size_t skip = offset % ALIGNMENT;
+    size_t alignedLen = alignUp(skip + len, ALIGNMENT);
+    void *bounce = std::aligned_alloc(ALIGNMENT, alignedLen);
+    if (bounce == nullptr) {
+        errno = ENOMEM;
+        return -1;
+    }
+    ssize_t n = copyOut(buf, len, bounce, skip, pread(fd, bounce, alignedLen, offset - static_cast<off_t>(skip)));
+    std::free(bounce);
+    return n;
+}
+
+ssize_t UringIoBackend::write(int fd, const void *buf, size_t len, off_t offset) {
+    if (len % ALIGNMENT != 0 || offset % ALIGNMENT != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (isAligned(buf, len, ALIGNMENT)) {
+        return pwrite(fd, buf, len, offset);
+    }
+    void *bounce = std::aligned_alloc(ALIGNMENT, len);
+    if (bounce == nullptr) {
+        errno = ENOMEM;
+        return -1;
+    }
+    memcpy(bounce, buf, len);
+    ssize_t n = pwrite(fd, bounce, len, offset);
+    std::free(bounce);
+    return n;
+}
+
+ssize_t UringIoBackend::writev(int fd, const iovec *iov, int iovcnt, off_t offset) {
+    size_t len = 0;
+    bool aligned = true;
+    for (int i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len;
+        aligned = aligned && isAligned(iov[i].iov_base, iov[i].iov_len, ALIGNMENT);
+    }
+    if (len % ALIGNMENT != 0 || offset % ALIGNMENT != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (aligned) {
+        return pwritev(fd, iov, iovcnt, offset);
+    }
+    // gather everything in a single aligned buffer
+    auto *bounce = static_cast<uint8_t *>(std::aligned_alloc(ALIGNMENT, len));
+    if (bounce == nullptr) {
+        errno = ENOMEM;
+        return -1;
+    }
+    size_t copied = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        memcpy(bounce + copied, iov[i].iov_base, iov[i].iov_len);
+        copied += iov[i].iov_len;
+    }
+    ssize_t n = pwrite(fd, bounce, len, offset);
+    std::free(bounce);
+    return n;
+}
+
+void UringIoBackend::submit(std::vector<IoRequest> &requests, size_t first, size_t last, int fd) {
+    unsigned tail = *ring->sqTail;
+    for (size_t i = first; i < last; i++) {
+        unsigned index = tail & *ring->sqMask;
+        io_uring_sqe *sqe = &ring->sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(requests[i].buf);
+        sqe->len = requests[i].len;
+        sqe->off = requests[i].offset;
+        sqe->user_data = i;
+        ring->sqArray[index] = index;
+        tail++;
+    }
+    // the kernel must see the entries before the new tail
+    __atomic_store_n(ring->sqTail, tail, __ATOMIC_RELEASE);
+
+    auto toSubmit = static_cast<unsigned>(last - first);
+    size_t pending = last - first;
+    // the completion queue must be consumed even if a callback throws
+    std::exception_ptr error;
+    while (pending > 0) {
+        long ret = syscall(__NR_io_uring_enter, ring->fd, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // the reads the kernel took still write into the buffers, the others must not be
+            // submitted with the next batch
+            drain(pending - toSubmit);
+            ring.reset();
+            ring = std::make_unique<Ring>();
+            throw std::runtime_error("io_uring_enter");
+        }
+        toSubmit -= static_cast<unsigned>(ret);
+        unsigned head = *ring->cqHead;
+        unsigned cqTail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        while (head != cqTail) {
+            io_uring_cqe *cqe = &ring->cqes[head & *ring->cqMask];
+            try {
+                requests[cqe->user_data].callback(cqe->res);
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            head++;
+            pending--;
+        }
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void UringIoBackend::drain(size_t inflight) {
+    while (inflight > 0) {
+        if (syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+            return;
+        }
+        unsigned head = *ring->cqHead;
+        unsigned cqTail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        for (; head != cqTail && inflight > 0; head++) {
+            inflight--;
+        }
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    }
+}
+
+void UringIoBackend::readBatch(int fd, std::vector<IoRequest> &requests) {
+    // unaligned requests are read into bounce buffers covering their aligned blocks, and
+    // copied out on completion
+    std::vector<std::unique_ptr<void, decltype(&std::free)>> bounces;
+    for (auto &request: requests) {
+        if (isAligned(request.buf, request.len, ALIGNMENT) && request.offset % ALIGNMENT == 0) {
+            continue;
+        }
+        size_t skip = request.offset % ALIGNMENT;
+        size_t alignedLen = alignUp(skip + request.len, ALIGNMENT);
+        void *bounce = std::aligned_alloc(ALIGNMENT, alignedLen);
+        if (bounce == nullptr) {
+            throw std::runtime_error("aligned_alloc");
+        }
+        bounces.emplace_back(bounce, &std::free);
+        request.callback = [buf = request.buf, len = request.len, bounce, skip, callback = std::move(request.callback)](
+                ssize_t n) {
+            callback(copyOut(buf, len, bounce, skip, n));
+        };
+        request.buf = bounce;
+        request.len = alignedLen;
+        request.offset -= static_cast<off_t>(skip);
+    }
+
+    std::lock_guard lock(latch);
+    if (!ring) {
+        for (auto &request: requests) {
+            ssize_t n = pread(fd, request.buf, request.len, request.offset);
+            request.callback(n < 0 ? -errno : n);
+        }
+        return;
+    }
+    for (size_t first = 0; first < requests.size(); first += ring->entries) {
+        submit(requests, first, std::min<size_t>(first + ring->entries, requests.size()), fd);
+    }
+}
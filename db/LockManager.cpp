@@ -0,0 +1,215 @@
+#include <db/LockManager.h>
+#include <algorithm>
+
+using namespace db;
+
+LockManager::Shard &LockManager::getShard(const Key &key) {
+    return shards[KeyHash{}(key) % NUM_SHARDS];
+}
+
+LockManager::HeldShard &LockManager::getHeldShard(int tid) {
+    return heldShards[static_cast<unsigned>(tid) % NUM_SHARDS];
+}
+
+bool LockManager::canGrant(const LockQueue &queue, int tid, LockMode mode, bool upgrade) {
+    if (upgrade) {
+        return queue.granted.size() == 1;
+    }
+    if (queue.upgrading != -1 || queue.waiting.front().first != tid) {
+        return false;
+    }
+    if (mode == LockMode::EXCLUSIVE) {
+        return queue.granted.empty();
+    }
+    return std::none_of(queue.granted.begin(), queue.granted.end(), [](const auto &item) {
+        return item.second == LockMode::EXCLUSIVE;
+    });
+}
+
+std::vector<int> LockManager::getBlockers(const LockQueue &queue, int tid, LockMode mode, bool upgrade) {
+    std::vector<int> blockers;
+    for (const auto &[holder, holderMode]: queue.granted) {
+        if (holder != tid && (upgrade || mode == LockMode::EXCLUSIVE || holderMode == LockMode::EXCLUSIVE)) {
+            blockers.push_back(holder);
+        }
+    }
+    if (!upgrade) {
+        if (queue.upgrading != -1) {
+            blockers.push_back(queue.upgrading);
+        }
+        // requests are served in order
+        for (const auto &[waiter, waiterMode]: queue.waiting) {
+            if (waiter == tid) {
+                break;
+            }
+            blockers.push_back(waiter);
+        }
+    }
+    return blockers;
+}
+
+bool LockManager::waitFor(int tid, std::vector<int> blockers) {
+    std::lock_guard lock(graphLatch);
+    std::vector<int> stack = blockers;
+    std::unordered_set<int> visited;
+    while (!stack.empty()) {
+        int current = stack.back();
+        stack.pop_back();
+        if (current == tid) {
+            waitsFor.erase(tid);
+            return false;
+        }
+        if (!visited.insert(current).second) {
+            continue;
+        }
+        auto it = waitsFor.find(current);
+        if (it != waitsFor.end()) {
+            stack.insert(stack.end(), it->second.begin(), it->second.end());
+        }
+    }
+    waitsFor[tid] = std::move(blockers);
+    return true;
+}
+
+void LockManager::stopWaiting(int tid) {
+    std::lock_guard lock(graphLatch);
+    waitsFor.erase(tid);
+}
+
+void LockManager::acquire(const TransactionId &tid, const PageId &pid, LockMode mode) {
+    Key key{pid.getTableId(), pid.pageNumber()};
+    Shard &shard = getShard(key);
+    std::unique_lock lock(shard.latch);
+    LockQueue &queue = shard.queues[key];
+
+    auto held = queue.granted.find(tid);
+    if (held != queue.granted.end() && (held->second == LockMode::EXCLUSIVE || mode == LockMode::SHARED)) {
+        return;
+    }
+    bool upgrade = held != queue.granted.end();
+    if (upgrade) {
+        if (queue.upgrading != -1) {
+            // both transactions hold a shared lock and wait for the other one to release it
+            throw TransactionAbortedException("deadlock: concurrent lock upgrades");
+        }
+        queue.upgrading = tid;
+    } else {
+        queue.waiting.emplace_back(tid, mode);
+    }
+
+    while (!canGrant(queue, tid, mode, upgrade)) {
+        if (!waitFor(tid, getBlockers(queue, tid, mode, upgrade))) {
+            if (upgrade) {
+                queue.upgrading = -1;
+            } else {
+                queue.waiting.remove_if([&tid](const auto &item) { return item.first == tid; });
+            }
+            queue.cv.notify_all();
+            throw TransactionAbortedException("deadlock");
+        }
+        queue.cv.wait(lock);
+    }
+    stopWaiting(tid);
+
+    if (upgrade) {
+        queue.upgrading = -1;
+    } else {
+        queue.waiting.pop_front();
+        // compatible requests queued behind this one may be granted too
+        queue.cv.notify_all();
+    }
+    queue.granted[tid] = mode;
+    lock.unlock();
+
+    HeldShard &heldShard = getHeldShard(tid);
+    std::lock_guard heldLock(heldShard.latch);
+    heldShard.held[tid].insert(key);
+}
+
+bool LockManager::tryAcquire(const TransactionId &tid, const PageId &pid, LockMode mode) {
+    Key key{pid.getTableId(), pid.pageNumber()};
+    Shard &shard = getShard(key);
+    std::unique_lock lock(shard.latch);
+    LockQueue &queue = shard.queues[key];
+
+    auto held = queue.granted.find(tid);
+    if (held != queue.granted.end() && (held->second == LockMode::EXCLUSIVE || mode == LockMode::SHARED)) {
+        return true;
+    }
+    bool upgrade = held != queue.granted.end();
+    if (upgrade) {
+        if (queue.upgrading != -1 || !canGrant(queue, tid, mode, true)) {
+            return false;
+        }
+    } else {
+        queue.waiting.emplace_back(tid, mode);
+        if (!canGrant(queue, tid, mode, false)) {
+            queue.waiting.pop_back();
+            if (queue.granted.empty() && queue.waiting.empty() && queue.upgrading == -1) {
+                shard.queues.erase(key);
+            }
+            return false;
+        }
+        queue.waiting.pop_front();
+    }
+    queue.granted[tid] = mode;
+    lock.unlock();
+
+    HeldShard &heldShard = getHeldShard(tid);
+    std::lock_guard heldLock(heldShard.latch);
+    heldShard.held[tid].insert(key);
+    return true;
+}
+
+void LockManager::release(int tid, const Key &key) {
+    Shard &shard = getShard(key);
+    std::lock_guard lock(shard.latch);
+    auto it = shard.queues.find(key);
+    if (it == shard.queues.end()) {
+        return;
+    }
+    LockQueue &queue = it->second;
+    queue.granted.erase(tid);
+    if (queue.granted.empty() && queue.waiting.empty() && queue.upgrading == -1) {
+        shard.queues.erase(it);
+    } else {
+        queue.cv.notify_all();
+    }
+}
+
+void LockManager::release(const TransactionId &tid, const PageId &pid) {
+    Key key{pid.getTableId(), pid.pageNumber()};
+    {
+        HeldShard &heldShard = getHeldShard(tid);
+        std::lock_guard heldLock(heldShard.latch);
+        auto it = heldShard.held.find(tid);
+        if (it == heldShard.held.end() || it->second.erase(key) == 0) {
+            return;
+        }
+    }
+    release(tid, key);
+}
+
+void LockManager::releaseAll(const TransactionId &tid) {
+    std::unordered_set<Key, KeyHash> keys;
+    {
+        HeldShard &heldShard = getHeldShard(tid);
+        std::lock_guard heldLock(heldShard.latch);
+        auto it = heldShard.held.find(tid);
+        if (it == heldShard.held.end()) {
+            return;
+        }
+        keys = std::move(it->second);
+        heldShard.held.erase(it);
+    }
+    for (const auto &key: keys) {
+        release(tid, key);
+    }
+}
+
+bool LockManager::holdsLock(const TransactionId &tid, const PageId &pid) {
+    HeldShard &heldShard = getHeldShard(tid);
+    std::lock_guard heldLock(heldShard.latch);
+    auto it = heldShard.held.find(tid);
+    return it != heldShard.held.end() && it->second.count({pid.getTableId(), pid.pageNumber()}) > 0;
+}
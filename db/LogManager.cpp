@@ -0,0 +1,508 @@
+#include <db/LogManager.h>
+#include <db/BTreePageId.h>
+#include <db/Database.h>
+#include <db/HeapPageId.h>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace db;
+
+namespace {
+    /** size, checksum, type, tid, prevLsn */
+    constexpr size_t HEADER_SIZE = 4 + 4 + 1 + 4 + 8;
+    /** tableId, pageNo, category, imageSize, undoNextLsn */
+    constexpr size_t PAGE_HEADER_SIZE = 4 + 4 + 1 + 4 + 8;
+
+    template<typename T>
+    void put(std::vector<uint8_t> &out, T value) {
+        auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<typename T>
+    T get(const uint8_t *&in) {
+        T value;
+        memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+
+    /** FNV-1a, detects records torn by a crash in the middle of a write */
+    uint32_t checksum(const uint8_t *data, size_t len) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < len; i++) {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    void writeImage(const PageId &pid, const std::vector<uint8_t> &image) {
+        Database::getCatalog().getDatabaseFile(pid.getTableId())->writePageData(pid, image.data());
+    }
+}
+
+//
+// LogRecord
+//
+
+std::unique_ptr<PageId> LogRecord::getPageId() const {
+    switch (category) {
+        case PageCategory::HEAP:
+            return std::make_unique<HeapPageId>(tableId, pageNo);
+        case PageCategory::ROOT_PTR:
+            return std::make_unique<BTreePageId>(tableId, pageNo, BTreePageType::ROOT_PTR);
+        case PageCategory::INTERNAL:
+            return std::make_unique<BTreePageId>(tableId, pageNo, BTreePageType::INTERNAL);
+        case PageCategory::LEAF:
+            return std::make_unique<BTreePageId>(tableId, pageNo, BTreePageType::LEAF);
+        case PageCategory::HEADER:
+            return std::make_unique<BTreePageId>(tableId, pageNo, BTreePageType::HEADER);
+        default:
+            throw std::runtime_error("Page type cannot be logged");
+    }
+}
+
+//
+// LogManager
+//
+
+LogManager::LogManager(const std::string &path) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1) {
+        throw std::runtime_error("open");
+    }
+    struct stat st{};
+    if (fstat(fd, &st) == -1) {
+        throw std::runtime_error("fstat");
+    }
+    if (static_cast<size_t>(st.st_size) < FIRST_LSN) {
+        uint8_t header[FIRST_LSN] = {};
+        memcpy(header, MAGIC, sizeof(MAGIC));
+        if (pwrite(fd, header, sizeof(header), 0) != sizeof(header) || ftruncate(fd, FIRST_LSN) == -1 ||
+            fdatasync(fd) == -1) {
+            throw std::runtime_error("write");
+        }
+        st.st_size = FIRST_LSN;
+    } else {
+        char magic[sizeof(MAGIC)];
+        if (pread(fd, magic, sizeof(magic), 0) != sizeof(magic) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error("Not a log file");
+        }
+    }
+    tailLsn = durableLsn = st.st_size;
+}
+
+LogManager::~LogManager() {
+    try {
+        std::unique_lock lock(latch);
+        force(lock, tailLsn + tail.size());
+    } catch (const std::exception &) {
+        // the records lost were not forced, they belong to transactions that did not commit
+    }
+    close(fd);
+}
+
+uint64_t LogManager::append(LogRecordType type, int tid, const std::vector<uint8_t> &body) {
+    uint64_t lsn = tailLsn + tail.size();
+    auto it = lastLsn.find(tid);
+    uint64_t prevLsn = it == lastLsn.end() || type == LogRecordType::CHECKPOINT ? 0 : it->second;
+    size_t start = tail.size();
+    put<uint32_t>(tail, HEADER_SIZE + body.size());
+    put<uint32_t>(tail, 0);
+    put<uint8_t>(tail, static_cast<uint8_t>(type));
+    put<int32_t>(tail, tid);
+    put<uint64_t>(tail, prevLsn);
+    tail.insert(tail.end(), body.begin(), body.end());
+    uint32_t sum = checksum(tail.data() + start + 8, tail.size() - start - 8);
+    memcpy(tail.data() + start + 4, &sum, sizeof(sum));
+    if (type == LogRecordType::CHECKPOINT) {
+        // not part of any transaction
+    } else if (type == LogRecordType::END) {
+        lastLsn.erase(tid);
+        firstLsn.erase(tid);
+    } else {
+        lastLsn[tid] = lsn;
+        firstLsn.emplace(tid, lsn);
+    }
+    return lsn;
+}
+
+uint64_t LogManager::appendPageRecord(LogRecordType type, int tid, const PageId &pid, const uint8_t *first,
+                                      const uint8_t *second, size_t imageSize, uint64_t undoNextLsn) {
+    std::vector<uint8_t> body;
+    body.reserve(PAGE_HEADER_SIZE + 2 * imageSize);
+    put<int32_t>(body, pid.getTableId());
+    put<int32_t>(body, pid.pageNumber());
+    put<uint8_t>(body, static_cast<uint8_t>(BufferPoolStats::categoryOf(pid)));
+    put<uint32_t>(body, imageSize);
+    put<uint64_t>(body, undoNextLsn);
+    body.insert(body.end(), first, first + imageSize);
+    if (second != nullptr) {
+        body.insert(body.end(), second, second + imageSize);
+    }
+    return append(type, tid, body);
+}
+
+bool LogManager::readRecord(uint64_t lsn, LogRecord &record, uint64_t &nextLsn) {
+    uint64_t end = tailLsn + tail.size();
+    if (lsn + HEADER_SIZE > end) {
+        return false;
+    }
+    std::vector<uint8_t> bytes(HEADER_SIZE);
+    auto read = [this, &bytes](uint64_t offset, size_t len) {
+        bytes.resize(len);
+        if (offset >= tailLsn) {
+            memcpy(bytes.data(), tail.data() + (offset - tailLsn), len);
+            return true;
+        }
+        if (!writing.empty() && offset >= writingLsn) {
+            // the leader of a group is writing it, it only reads the buffer meanwhile
+            memcpy(bytes.data(), writing.data() + (offset - writingLsn), len);
+            return true;
+        }
+        return pread(fd, bytes.data(), len, static_cast<off_t>(offset)) == static_cast<ssize_t>(len);
+    };
+    if (!read(lsn, HEADER_SIZE)) {
+        return false;
+    }
+    uint32_t size;
+    memcpy(&size, bytes.data(), sizeof(size));
+    if (size < HEADER_SIZE || lsn + size > end || !read(lsn, size)) {
+        return false;
+    }
+    uint32_t sum;
+    memcpy(&sum, bytes.data() + 4, sizeof(sum));
+    if (sum != checksum(bytes.data() + 8, size - 8)) {
+        return false;
+    }
+
+    const uint8_t *in = bytes.data() + 8;
+    record.lsn = lsn;
+    record.type = static_cast<LogRecordType>(get<uint8_t>(in));
+    record.tid = get<int32_t>(in);
+    record.prevLsn = get<uint64_t>(in);
+    record.before.clear();
+    record.after.clear();
+    record.pages.clear();
+    record.running.clear();
+    if (record.type == LogRecordType::UPDATE || record.type == LogRecordType::CLR) {
+        record.tableId = get<int32_t>(in);
+        record.pageNo = get<int32_t>(in);
+        record.category = static_cast<PageCategory>(get<uint8_t>(in));
+        auto imageSize = get<uint32_t>(in);
+        record.undoNextLsn = get<uint64_t>(in);
+        if (record.type == LogRecordType::UPDATE) {
+            record.before.assign(in, in + imageSize);
+            in += imageSize;
+        }
+        record.after.assign(in, in + imageSize);
+    } else if (record.type == LogRecordType::CHECKPOINT) {
+        record.redoLsn = get<uint64_t>(in);
+        auto numPages = get<uint32_t>(in);
+        for (uint32_t i = 0; i < numPages; i++) {
+            int tableId = get<int32_t>(in);
+            record.pages.emplace_back(tableId, get<int32_t>(in));
+        }
+        auto numRunning = get<uint32_t>(in);
+        for (uint32_t i = 0; i < numRunning; i++) {
+            int tid = get<int32_t>(in);
+            record.running.emplace_back(tid, get<uint64_t>(in));
+        }
+    }
+    nextLsn = lsn + size;
+    return true;
+}
+
+void LogManager::force(std::unique_lock<std::mutex> &lock, uint64_t end, bool commit) {
+    while (durableLsn < end) {
+        if (syncing) {
+            // the records may be in the group being synced, or go with the next one
+            synced.wait(lock);
+            continue;
+        }
+        syncing = true;
+        if (commit && maxWait.count() > 0) {
+            joined.wait_for(lock, maxWait, [this] { return pendingCommits >= maxBatch; });
+        }
+        writing.swap(tail);
+        writingLsn = tailLsn;
+        tailLsn += writing.size();
+        pendingCommits = 0;
+        lock.unlock();
+
+        bool ok = true;
+        for (size_t written = 0; ok && written < writing.size();) {
+            ssize_t n = pwrite(fd, writing.data() + written, writing.size() - written,
+                               static_cast<off_t>(writingLsn + written));
+            ok = n != -1;
+            written += ok ? n : 0;
+        }
+        ok = ok && fdatasync(fd) == 0;
+
+        lock.lock();
+        if (ok) {
+            durableLsn = tailLsn;
+            syncs++;
+        } else {
+            // keep the records, the next force retries them
+            tail.insert(tail.begin(), writing.begin(), writing.end());
+            tailLsn = writingLsn;
+        }
+        writing.clear();
+        syncing = false;
+        synced.notify_all();
+        if (!ok) {
+            throw std::runtime_error("write");
+        }
+    }
+}
+
+uint64_t LogManager::logUpdate(const TransactionId &tid, const PageId &pid, const uint8_t *before,
+                               const uint8_t *after, size_t imageSize) {
+    if (BufferPoolStats::categoryOf(pid) == PageCategory::OTHER) {
+        throw std::runtime_error("Page type cannot be logged");
+    }
+    std::lock_guard lock(latch);
+    return appendPageRecord(LogRecordType::UPDATE, tid, pid, before, after, imageSize, 0);
+}
+
+void LogManager::commit(const TransactionId &tid) {
+    std::unique_lock lock(latch);
+    if (lastLsn.count(tid) == 0) {
+        // read-only transaction, there is nothing to make durable
+        return;
+    }
+    append(LogRecordType::COMMIT, tid, {});
+    uint64_t end = tailLsn + tail.size();
+    if (++pendingCommits >= maxBatch) {
+        joined.notify_one();
+    }
+    force(lock, end, true);
+    commits++;
+    append(LogRecordType::END, tid, {});
+}
+
+void LogManager::setGroupCommit(std::chrono::microseconds maxWait, size_t maxBatch) {
+    std::lock_guard lock(latch);
+    this->maxWait = maxWait;
+    this->maxBatch = std::max<size_t>(maxBatch, 1);
+}
+
+LogStats LogManager::getStats() {
+    std::lock_guard lock(latch);
+    return {commits, syncs, recycledLsn};
+}
+
+std::vector<std::unique_ptr<PageId>> LogManager::abort(const TransactionId &tid) {
+    std::unique_lock lock(latch);
+    auto it = lastLsn.find(tid);
+    if (it == lastLsn.end()) {
+        return {};
+    }
+    uint64_t last = it->second;
+    append(LogRecordType::ABORT, tid, {});
+    return undo(lock, tid, last);
+}
+
+std::vector<std::unique_ptr<PageId>> LogManager::undo(std::unique_lock<std::mutex> &lock, int tid, uint64_t lsn) {
+    std::vector<std::pair<std::unique_ptr<PageId>, std::vector<uint8_t>>> restored;
+    LogRecord record;
+    uint64_t next;
+    while (lsn != 0) {
+        if (!readRecord(lsn, record, next)) {
+            throw std::runtime_error("Corrupted log");
+        }
+        if (record.type == LogRecordType::UPDATE) {
+            std::unique_ptr<PageId> pid = record.getPageId();
+            appendPageRecord(LogRecordType::CLR, tid, *pid, record.before.data(), nullptr, record.before.size(),
+                             record.prevLsn);
+            restored.emplace_back(std::move(pid), std::move(record.before));
+            lsn = record.prevLsn;
+        } else if (record.type == LogRecordType::CLR) {
+            // already undone by an interrupted rollback
+            lsn = record.undoNextLsn;
+        } else {
+            lsn = record.prevLsn;
+        }
+    }
+    append(LogRecordType::END, tid, {});
+    // the CLRs are durable before the images they describe, like any other page write
+    force(lock, tailLsn + tail.size());
+    std::vector<std::unique_ptr<PageId>> pids;
+    for (auto &[pid, image]: restored) {
+        // newest first, so the last image written is the one from before the transaction
+        writeImage(*pid, image);
+        pids.push_back(std::move(pid));
+    }
+    return pids;
+}
+
+void LogManager::flush(uint64_t lsn) {
+    std::unique_lock lock(latch);
+    // groups end on record boundaries, so the record is durable once its first byte is
+    force(lock, lsn + 1);
+}
+
+uint64_t LogManager::checkpoint(uint64_t redoLsn, const std::vector<std::pair<int, int>> &pages) {
+    std::lock_guard checkpointLock(checkpointLatch);
+    std::unique_lock lock(latch);
+    std::vector<uint8_t> body;
+    body.reserve(8 + 4 + 8 * pages.size() + 4 + 12 * lastLsn.size());
+    put<uint64_t>(body, redoLsn);
+    put<uint32_t>(body, pages.size());
+    for (auto [tableId, pageNo]: pages) {
+        put<int32_t>(body, tableId);
+        put<int32_t>(body, pageNo);
+    }
+    // recovery finds the transactions that were running here without reading the records before
+    put<uint32_t>(body, lastLsn.size());
+    for (auto [tid, last]: lastLsn) {
+        put<int32_t>(body, tid);
+        put<uint64_t>(body, last);
+    }
+    uint64_t keep = redoLsn;
+    for (auto [tid, first]: firstLsn) {
+        keep = std::min(keep, first);
+    }
+    uint64_t lsn = append(LogRecordType::CHECKPOINT, -1, body);
+    force(lock, lsn + 1);
+    lock.unlock();
+
+    writeCheckpointLsn(lsn);
+    recycle(keep);
+    return lsn;
+}
+
+void LogManager::writeCheckpointLsn(uint64_t lsn) {
+    if (pwrite(fd, &lsn, sizeof(lsn), sizeof(MAGIC)) != sizeof(lsn) || fdatasync(fd) == -1) {
+        throw std::runtime_error("write");
+    }
+}
+
+void LogManager::recycle(uint64_t lsn) {
+    // whole blocks only, the first one holds the magic
+    constexpr uint64_t BLOCK_SIZE = 4096;
+    uint64_t start = std::max(recycledLsn, BLOCK_SIZE) / BLOCK_SIZE * BLOCK_SIZE;
+    uint64_t end = lsn / BLOCK_SIZE * BLOCK_SIZE;
+    if (end <= start) {
+        return;
+    }
+    // file systems without holes keep the space until recovery truncates the log
+    if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(start),
+                  static_cast<off_t>(end - start)) == 0) {
+        std::lock_guard lock(latch);
+        recycledLsn = end;
+    }
+}
+
+uint64_t LogManager::getNextLsn() {
+    std::lock_guard lock(latch);
+    return tailLsn + tail.size();
+}
+
+void LogManager::recover() {
+    std::unique_lock lock(latch);
+
+    // analysis: find the transactions that were running, and the last image of every page.
+    // It starts at the redo LSN of the last checkpoint, the records before may be recycled.
+    std::set<int> committed;
+    std::map<std::pair<int, int>, LogRecord> images;
+    uint64_t redoLsn = 0;
+    LogRecord record;
+    uint64_t lsn = FIRST_LSN;
+    uint64_t next;
+    uint64_t checkpointLsn;
+    if (pread(fd, &checkpointLsn, sizeof(checkpointLsn), sizeof(MAGIC)) != sizeof(checkpointLsn)) {
+        throw std::runtime_error("pread");
+    }
+    // a checkpoint LSN past the end was left by a recovery interrupted after the truncation
+    if (checkpointLsn != 0 && readRecord(checkpointLsn, record, next) && record.type == LogRecordType::CHECKPOINT) {
+        lsn = record.redoLsn;
+    }
+    while (readRecord(lsn, record, next)) {
+        switch (record.type) {
+            case LogRecordType::UPDATE:
+            case LogRecordType::CLR:
+                lastLsn[record.tid] = lsn;
+                images[{record.tableId, record.pageNo}] = record;
+                break;
+            case LogRecordType::COMMIT:
+                lastLsn[record.tid] = lsn;
+                committed.insert(record.tid);
+                break;
+            case LogRecordType::ABORT:
+                lastLsn[record.tid] = lsn;
+                break;
+            case LogRecordType::END:
+                lastLsn.erase(record.tid);
+                committed.erase(record.tid);
+                break;
+            case LogRecordType::CHECKPOINT:
+                redoLsn = record.redoLsn;
+                // the checkpoint knows the transactions that were running, including those
+                // whose earlier records were not read
+                lastLsn.clear();
+                committed.clear();
+                for (auto [tid, last]: record.running) {
+                    lastLsn[tid] = last;
+                    LogRecord lastRecord;
+                    uint64_t unused;
+                    if (readRecord(last, lastRecord, unused) && lastRecord.type == LogRecordType::COMMIT) {
+                        committed.insert(tid);
+                    }
+                }
+                break;
+        }
+        lsn = next;
+    }
+    // anything after the last valid record was torn by the crash
+    if (ftruncate(fd, static_cast<off_t>(lsn)) == -1) {
+        throw std::runtime_error("ftruncate");
+    }
+    tailLsn = durableLsn = lsn;
+
+    // redo: repeat history, the last image of a page includes all the updates before it.
+    // Images older than the last checkpoint are already on disk.
+    std::set<DbFile *> files;
+    for (const auto &[key, image]: images) {
+        if (image.lsn < redoLsn) {
+            continue;
+        }
+        writeImage(*image.getPageId(), image.after);
+        files.insert(Database::getCatalog().getDatabaseFile(image.tableId));
+    }
+
+    // undo: roll the losers back. Under strict 2PL no two of them updated the same page, so
+    // they can be undone one after the other.
+    std::vector<std::pair<int, uint64_t>> running(lastLsn.begin(), lastLsn.end());
+    for (auto [tid, last]: running) {
+        if (committed.count(tid)) {
+            append(LogRecordType::END, tid, {});
+            continue;
+        }
+        for (const auto &pid: undo(lock, tid, last)) {
+            files.insert(Database::getCatalog().getDatabaseFile(pid->getTableId()));
+        }
+    }
+
+    // every update is on disk now, the log can start over
+    for (DbFile *file: files) {
+        file->sync();
+    }
+    force(lock, tailLsn + tail.size());
+    // truncated first: a checkpoint LSN left past the end is ignored by the next recovery
+    if (ftruncate(fd, FIRST_LSN) == -1 || fdatasync(fd) == -1) {
+        throw std::runtime_error("ftruncate");
+    }
+    writeCheckpointLsn(0);
+    tailLsn = durableLsn = FIRST_LSN;
+    recycledLsn = FIRST_LSN;
+    lastLsn.clear();
+    firstLsn.clear();
+}
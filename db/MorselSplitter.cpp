@@ -0,0 +1,23 @@
+#include <db/MorselSplitter.h>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace db;
+
+MorselSplitter::MorselSplitter(int numPages, int morselPages) : numPages(numPages), morselPages(morselPages) {
+    if (morselPages <= 0) {
+        throw std::runtime_error("morselPages must be positive");
+    }
+}
+
+std::optional<Morsel> MorselSplitter::next() {
+    // checked first, so that polling a drained splitter never overflows nextPage
+    if (nextPage.load(std::memory_order_relaxed) >= numPages) {
+        return std::nullopt;
+    }
+    int pageLo = nextPage.fetch_add(morselPages, std::memory_order_relaxed);
+    if (pageLo >= numPages) {
+        return std::nullopt;
+    }
+    return Morsel{pageLo, std::min(pageLo + morselPages, numPages)};
+}
@@ -0,0 +1,11 @@
+#include <db/Page.h>
+#include <db/DirtyPageIndex.h>
+
+using namespace db;
+
+void Page::markDirty(std::optional<TransactionId> tid) {
+    dirty = tid;
+    if (tid.has_value() && dirtyIndex != nullptr) {
+        dirtyIndex->add(*tid, frame, getId().getTableId());
+    }
+}
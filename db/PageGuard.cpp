@@ -0,0 +1,35 @@
+#include <db/PageGuard.h>
+#include <db/BufferPool.h>
+#include <cassert>
+#include <utility>
+
+using namespace db;
+
+PageGuard::PageGuard(const PageGuard &other) : bufferPool(other.bufferPool), page(other.page) {
+    if (page != nullptr) {
+        // the page is pinned, even a page discarded since is still alive
+        bufferPool->retainPin(page);
+    }
+}
+
+PageGuard::PageGuard(PageGuard &&other) noexcept
+        : bufferPool(std::exchange(other.bufferPool, nullptr)), page(std::exchange(other.page, nullptr)) {}
+
+PageGuard &PageGuard::operator=(PageGuard other) noexcept {
+    std::swap(bufferPool, other.bufferPool);
+    std::swap(page, other.page);
+    return *this;
+}
+
+PageGuard::~PageGuard() {
+    release();
+}
+
+void PageGuard::release() noexcept {
+    if (page != nullptr) {
+        [[maybe_unused]] bool released = bufferPool->releasePin(page);
+        assert(released);
+        page = nullptr;
+        bufferPool = nullptr;
+    }
+}
@@ -0,0 +1,239 @@
+#include <db/PagedFile.h>
+#include <db/BufferPool.h>
+#include <db/Database.h>
+#include <db/HeapPage.h>
+#include <db/PaxPage.h>
+#include <db/SlottedPage.h>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace db;
+
+//
+// PagedFile
+//
+
+PagedFile::PagedFile(const char *fname, const TupleDesc &td, IoBackendType ioBackend)
+        : td(td), io(IoBackend::create(ioBackend)) {
+    tableid = std::hash<std::string>{}(fname);
+    fd = open(fname, O_RDWR | O_CREAT | io->getOpenFlags(), 0644);
+    if (fd == -1 && errno == EINVAL) {
+        // the file system does not support direct I/O
+        fd = open(fname, O_RDWR | O_CREAT, 0644);
+    }
+    if (fd == -1) {
+        throw std::runtime_error("open");
+    }
+    struct stat st{};
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        throw std::runtime_error("fstat");
+    }
+    numPages = st.st_size / Database::getBufferPool().getPageSize();
+    freeSpace = std::make_unique<FreeSpaceMap>(std::string(fname) + ".fsm", fd, numPages);
+}
+
+PagedFile::~PagedFile() {
+    try {
+        // saved last, so that the map is newer than the file
+        freeSpace->save(true);
+    } catch (const std::runtime_error &) {
+        // the map is rebuilt when the file is opened next
+    }
+    close(fd);
+}
+
+int PagedFile::getId() const {
+    return tableid;
+}
+
+const TupleDesc &PagedFile::getTupleDesc() const {
+    return td;
+}
+
+void PagedFile::checkRead(ssize_t n, uint8_t *frame, size_t pageSize) {
+    if (n == -1) {
+        throw std::runtime_error("pread");
+    }
+    if (static_cast<size_t>(n) < pageSize) {
+        memset(frame + n, 0, pageSize - n);
+    }
+}
+
+Page *PagedFile::readPage(const PageId &pid, uint8_t *frame) {
+    auto page_size = Database::getBufferPool().getPageSize();
+    checkRead(io->read(fd, frame, page_size, static_cast<off_t>(pid.pageNumber()) * page_size), frame, page_size);
+    return createPage(dynamic_cast<const HeapPageId &>(pid), frame);
+}
+
+void PagedFile::writePage(Page *p) {
+    auto *data = static_cast<uint8_t *>(p->getPageData());
+    try {
+        writePageData(p->getId(), data);
+    } catch (...) {
+        delete[] data;
+        throw;
+    }
+    delete[] data;
+}
+
+void PagedFile::writePageData(const PageId &pid, const void *data) {
+    auto page_size = Database::getBufferPool().getPageSize();
+    if (io->write(fd, data, page_size, static_cast<off_t>(pid.pageNumber()) * page_size) != page_size) {
+        throw std::runtime_error("write");
+    }
+}
+
+void PagedFile::sync() {
+    if (fsync(fd) == -1) {
+        throw std::runtime_error("fsync");
+    }
+    freeSpace->save();
+}
+
+PageGuard PagedFile::getPageWithRoom(TransactionId tid, int pgNo, const Tuple &t, bool &full) {
+    BufferPool &bufferPool = Database::getBufferPool();
+    HeapPageId hpid(tableid, pgNo);
+    const PageId *pid = &hpid;
+    bool held = bufferPool.holdsLock(tid, pid);
+    PageGuard guard = bufferPool.tryFetchPage(tid, pid, Permissions::READ_WRITE);
+    full = guard && !hasRoom(guard.get(), t);
+    if (!guard || !full) {
+        return guard;
+    }
+    guard.release();
+    // the page was only read to look for room
+    if (!held) {
+        bufferPool.unsafeReleasePage(tid, pid);
+    }
+    return {};
+}
+
+std::vector<PageGuard> PagedFile::insertTuple(TransactionId tid, Tuple &t) {
+    // the page stays pinned until the buffer pool marked it dirty, an eviction in between
+    // would lose the update
+    PageGuard guard;
+    // the map is a hint, the page it names is checked and cleared from it if it is full
+    bool full;
+    for (int i = freeSpace->find(); i != -1 && i < numPages; i = freeSpace->find(i + 1)) {
+        if ((guard = getPageWithRoom(tid, i, t, full))) {
+            break;
+        }
+        if (full) {
+            freeSpace->update(i, false);
+        }
+    }
+    int last = numPages - 1;
+    if (!guard && fillLastPage && last >= 0) {
+        guard = getPageWithRoom(tid, last, t, full);
+    }
+    if (!guard) {
+        // append an empty page and read it through the buffer pool like any other, its updates
+        // are then logged against the empty image
+        auto *data = static_cast<uint8_t *>(createEmptyPageData());
+        std::unique_lock lock(sizeLatch);
+        HeapPageId hpid(tableid, numPages);
+        try {
+            writePageData(hpid, data);
+        } catch (...) {
+            delete[] data;
+            throw;
+        }
+        delete[] data;
+        numPages++;
+        lock.unlock();
+        guard = Database::getBufferPool().fetchPage(tid, &hpid, Permissions::READ_WRITE);
+    }
+    Page *page = guard.get();
+    {
+        // the page is marked dirty before a writer can log and write it
+        std::lock_guard updateLock(page->getUpdateLatch());
+        insertInto(page, t);
+        page->markDirty(tid);
+    }
+    freeSpace->update(page->getId().pageNumber(), isFree(page));
+    std::vector<PageGuard> dirty;
+    dirty.push_back(std::move(guard));
+    return dirty;
+}
+
+std::vector<PageGuard> PagedFile::deleteTuple(TransactionId tid, Tuple &t) {
+    PageGuard guard = Database::getBufferPool().fetchPage(tid, t.getRecordId()->getPageId(), Permissions::READ_WRITE);
+    Page *page = guard.get();
+    {
+        std::lock_guard updateLock(page->getUpdateLatch());
+        deleteFrom(page, t);
+        page->markDirty(tid);
+    }
+    freeSpace->update(page->getId().pageNumber(), isFree(page));
+    std::vector<PageGuard> dirty;
+    dirty.push_back(std::move(guard));
+    return dirty;
+}
+
+int PagedFile::getNumPages() const {
+    return numPages;
+}
+
+//
+// PagedFileIterator
+//
+
+template<typename P>
+PagedFileIterator<P>::PagedFileIterator(int tableid, int pageLo, int pageHi, bool end)
+        : pageHi(pageHi), hpid(tableid, end ? pageHi : pageLo) {
+    seek();
+}
+
+template<typename P>
+void PagedFileIterator<P>::seek() {
+    while (hpid.pageNumber() < pageHi) {
+        if (page == nullptr) {
+            readAhead.access(hpid, pageHi);
+            guard = Database::getBufferPool().fetchPage(&hpid);
+            page = guard.as<P>();
+            if (!page) {
+                throw std::runtime_error("dynamic_cast");
+            }
+            it = page->begin();
+        }
+        if (*it != page->end()) {
+            return;
+        }
+        // empty pages, or the end of one, are skipped
+        hpid = {hpid.getTableId(), hpid.pageNumber() + 1};
+        page = nullptr;
+    }
+    hpid = {hpid.getTableId(), pageHi};
+    it.reset();
+    guard.release();
+}
+
+template<typename P>
+bool PagedFileIterator<P>::operator!=(const PagedFileIterator &other) const {
+    return hpid != other.hpid || it.has_value() != other.it.has_value() || (it && *it != *other.it);
+}
+
+template<typename P>
+typename PagedFileIterator<P>::reference PagedFileIterator<P>::operator*() const {
+    return **it;
+}
+
+template<typename P>
+PagedFileIterator<P> &PagedFileIterator<P>::operator++() {
+    ++*it;
+    seek();
+    return *this;
+}
+
+namespace db {
+    template class PagedFileIterator<HeapPage>;
+    template class PagedFileIterator<SlottedPage>;
+    template class PagedFileIterator<PaxPage>;
+}
@@ -0,0 +1,48 @@
+#include <db/PaxFile.h>
+#include <algorithm>
+#include <string>
+
+using namespace db;
+
+PaxFile::PaxFile(const char *fname, const TupleDesc &td, StringEncoding encoding, IoBackendType ioBackend)
+        : PagedFile(fname, td, ioBackend) {
+    if (encoding == StringEncoding::DICTIONARY) {
+        dictionary = std::make_unique<StringDictionary>(std::string(fname) + ".dict");
+    }
+}
+
+Page *PaxFile::createPage(const HeapPageId &pid, uint8_t *frame) {
+    return new PaxPage(pid, frame, dictionary.get());
+}
+
+void *PaxFile::createEmptyPageData() const {
+    return PaxPage::createEmptyPageData();
+}
+
+bool PaxFile::hasRoom(const Page *page, const Tuple &) const {
+    return isFree(page);
+}
+
+bool PaxFile::isFree(const Page *page) const {
+    return dynamic_cast<const PaxPage *>(page)->getNumEmptySlots() > 0;
+}
+
+void PaxFile::insertInto(Page *page, Tuple &t) {
+    dynamic_cast<PaxPage *>(page)->insertTuple(&t);
+}
+
+void PaxFile::deleteFrom(Page *page, Tuple &t) {
+    dynamic_cast<PaxPage *>(page)->deleteTuple(&t);
+}
+
+PaxFileIterator PaxFile::begin() const {
+    return scan(0, getNumPages()).begin();
+}
+
+PaxFileIterator PaxFile::end() const {
+    return scan(0, getNumPages()).end();
+}
+
+PaxFileRange PaxFile::scan(int pageLo, int pageHi) const {
+    return {getId(), pageLo, std::min(pageHi, getNumPages())};
+}
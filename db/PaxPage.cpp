@@ -0,0 +1,189 @@
+#include <db/PaxPage.h>
+#include <db/Database.h>
+#include <db/IntField.h>
+#include <db/SlotBitmap.h>
+#include <db/StringField.h>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace db;
+
+//
+// PaxPageIterator
+//
+
+PaxPageIterator::PaxPageIterator(int slot, const PaxPage *page)
+        : slot(SlotBitmap::next(page->image.data(), page->numSlots, slot, true)), page(page) {}
+
+bool PaxPageIterator::operator!=(const PaxPageIterator &other) const {
+    return slot != other.slot || page != other.page;
+}
+
+PaxPageIterator &PaxPageIterator::operator++() {
+    slot = SlotBitmap::next(page->image.data(), page->numSlots, slot + 1, true);
+    return *this;
+}
+
+const Tuple &PaxPageIterator::operator*() const {
+    return page->getTuple(slot);
+}
+
+//
+// PaxPage
+//
+
+PaxPage::PaxPage(const HeapPageId &id, const uint8_t *data, StringDictionary *dictionary)
+        : pid(id), td(Database::getCatalog().getTupleDesc(id.getTableId())),
+          image(data, data + Database::getBufferPool().getPageSize()), dictionary(dictionary) {
+    size_t offset;
+    numSlots = getNumSlots(td, dictionary != nullptr, offset);
+    numUsed = SlotBitmap::count(image.data(), numSlots);
+    for (const auto &item: td) {
+        columns.push_back(offset);
+        widths.push_back(getValueSize(item.fieldType, dictionary != nullptr));
+        offset += numSlots * widths.back();
+    }
+    decoded.resize(numSlots);
+}
+
+PaxPage::~PaxPage() {
+    for (const Field *f: parsedFields) {
+        delete f;
+    }
+    for (const RecordId *rid: parsedRecordIds) {
+        delete rid;
+    }
+}
+
+size_t PaxPage::getValueSize(Types::Type type, bool encoded) {
+    return type == Types::STRING_TYPE && encoded ? sizeof(int) : Types::getLen(type);
+}
+
+int PaxPage::getNumSlots(const TupleDesc &td, bool encoded, size_t &headerSize) {
+    size_t pageSize = Database::getBufferPool().getPageSize();
+    size_t tupleSize = 0;
+    for (const auto &item: td) {
+        tupleSize += getValueSize(item.fieldType, encoded);
+    }
+    // as many slots as a HeapPage, unless the padding of the header takes the room of the last one
+    auto numSlots = static_cast<int>(pageSize * 8 / (tupleSize * 8 + 1));
+    while (true) {
+        headerSize = ((numSlots + 7) / 8 + 7) & ~size_t{7};
+        if (headerSize + numSlots * tupleSize <= pageSize) {
+            return numSlots;
+        }
+        numSlots--;
+    }
+}
+
+const PageId &PaxPage::getId() const {
+    return pid;
+}
+
+void *PaxPage::getPageData() const {
+    auto *data = new uint8_t[image.size()];
+    memcpy(data, image.data(), image.size());
+    return data;
+}
+
+void *PaxPage::createEmptyPageData() {
+    return new uint8_t[Database::getBufferPool().getPageSize()]{};
+}
+
+bool PaxPage::isSlotUsed(int slot) const {
+    return SlotBitmap::test(image.data(), slot);
+}
+
+void PaxPage::insertTuple(Tuple *t) {
+    if (getNumEmptySlots() <= 0) {
+        throw std::runtime_error("No space");
+    }
+    if (td != t->getTupleDesc()) {
+        throw std::runtime_error("Wrong tuple description");
+    }
+    // strings are encoded first, a failed write to the dictionary leaves the page as it was
+    std::vector<int> codes(td.numFields());
+    for (size_t i = 0; i < td.numFields() && dictionary != nullptr; i++) {
+        if (td.getFieldType(i) == Types::STRING_TYPE) {
+            const auto &field = dynamic_cast<const StringField &>(t->getField(static_cast<int>(i)));
+            codes[i] = dictionary->encode(field.getValue());
+        }
+    }
+    int slot = SlotBitmap::next(image.data(), numSlots, 0, false);
+    SlotBitmap::assign(image.data(), slot, true);
+    numUsed++;
+    for (size_t i = 0; i < td.numFields(); i++) {
+        uint8_t *data = image.data() + getValueOffset(slot, static_cast<int>(i));
+        const Field &field = t->getField(static_cast<int>(i));
+        if (td.getFieldType(i) == Types::INT_TYPE) {
+            field.serialize(data);
+        } else if (dictionary != nullptr) {
+            memcpy(data, &codes[i], sizeof(int));
+        } else {
+            std::string value = dynamic_cast<const StringField &>(field).getValue();
+            int len = static_cast<int>(std::min(value.size(), Types::STRING_LEN - 1));
+            memcpy(data, &len, sizeof(len));
+            memcpy(data + sizeof(len), value.data(), len);
+        }
+    }
+    t->setRecordId(new RecordId(&pid, slot));
+    std::lock_guard lock(latch);
+    // a tuple decoded from the slot before a delete is kept for its readers, not reused
+    decoded[slot] = nullptr;
+}
+
+void PaxPage::deleteTuple(Tuple *t) {
+    int slot = t->getRecordId()->getTupleno();
+    if (*t->getRecordId()->getPageId() != pid) {
+        throw std::runtime_error("Wrong page");
+    }
+    if (slot >= numSlots || !isSlotUsed(slot)) {
+        throw std::runtime_error("Empty slot");
+    }
+    SlotBitmap::assign(image.data(), slot, false);
+    numUsed--;
+    for (size_t i = 0; i < td.numFields(); i++) {
+        memset(image.data() + getValueOffset(slot, static_cast<int>(i)), 0, widths[i]);
+    }
+}
+
+const Tuple &PaxPage::getTuple(int slot) const {
+    std::lock_guard lock(latch);
+    if (decoded[slot] != nullptr) {
+        return *decoded[slot];
+    }
+    auto *rid = new RecordId(&pid, slot);
+    parsedRecordIds.push_back(rid);
+    Tuple &t = tuples.emplace_back(td, rid);
+    for (size_t i = 0; i < td.numFields(); i++) {
+        const Field *f;
+        if (td.getFieldType(i) == Types::INT_TYPE) {
+            f = new IntField(getInt(slot, static_cast<int>(i)));
+        } else {
+            f = new StringField(std::string(getString(slot, static_cast<int>(i))).c_str());
+        }
+        parsedFields.push_back(f);
+        t.setField(static_cast<int>(i), f);
+    }
+    decoded[slot] = &t;
+    return t;
+}
+
+std::string_view PaxPage::getString(int slot, int i) const {
+    if (dictionary != nullptr) {
+        return dictionary->decode(getCode(slot, i));
+    }
+    const uint8_t *data = image.data() + getValueOffset(slot, i);
+    int len;
+    memcpy(&len, data, sizeof(len));
+    len = std::clamp(len, 0, static_cast<int>(Types::STRING_LEN) - 1);
+    return {reinterpret_cast<const char *>(data + sizeof(len)), static_cast<size_t>(len)};
+}
+
+PaxPageIterator PaxPage::begin() const {
+    return {0, this};
+}
+
+PaxPageIterator PaxPage::end() const {
+    return {numSlots, this};
+}
@@ -0,0 +1,150 @@
+#include <db/Prefetcher.h>
+#include <db/BTreeLeafPage.h>
+#include <db/Database.h>
+#include <algorithm>
+
+using namespace db;
+
+//
+// Prefetcher
+//
+
+Prefetcher::Prefetcher(BufferPool &bufferPool) : bufferPool(bufferPool) {}
+
+Prefetcher::~Prefetcher() {
+    {
+        std::lock_guard lock(latch);
+        stopping = true;
+        queue.clear();
+    }
+    cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void Prefetcher::setWindow(int pages) {
+    window.store(std::max(pages, 0), std::memory_order_relaxed);
+}
+
+int Prefetcher::getWindow() const {
+    return window.load(std::memory_order_relaxed);
+}
+
+void Prefetcher::enqueue(Request request) {
+    {
+        std::lock_guard lock(latch);
+        if (stopping || queue.size() >= MAX_QUEUED) {
+            return;
+        }
+        if (!worker.joinable()) {
+            worker = std::thread(&Prefetcher::run, this);
+        }
+        queue.push_back(std::move(request));
+    }
+    cv.notify_one();
+}
+
+void Prefetcher::prefetch(const HeapPageId &pid) {
+    issued.fetch_add(1, std::memory_order_relaxed);
+    enqueue({std::make_unique<HeapPageId>(pid), 0});
+}
+
+void Prefetcher::prefetchLeaves(const BTreePageId &leaf, int count) {
+    if (count <= 0) {
+        return;
+    }
+    issued.fetch_add(count, std::memory_order_relaxed);
+    enqueue({std::make_unique<BTreePageId>(leaf), count - 1});
+}
+
+void Prefetcher::drain() {
+    std::unique_lock lock(latch);
+    idle.wait(lock, [this] { return queue.empty() && active == 0; });
+}
+
+void Prefetcher::run() {
+    std::unique_lock lock(latch);
+    while (true) {
+        cv.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) {
+            return;
+        }
+        Request request = std::move(queue.front());
+        queue.pop_front();
+        // pages that do not lead to further requests are read together
+        std::vector<std::unique_ptr<PageId>> batch;
+        while (request.followSiblings == 0 && !queue.empty() && queue.front().followSiblings == 0 &&
+               batch.size() + 1 < MAX_BATCH) {
+            batch.push_back(std::move(queue.front().pid));
+            queue.pop_front();
+        }
+        active++;
+        lock.unlock();
+
+        try {
+            if (!batch.empty()) {
+                std::vector<const PageId *> pids{request.pid.get()};
+                for (const auto &pid: batch) {
+                    pids.push_back(pid.get());
+                }
+                bufferPool.prefetchPages(pids);
+            } else {
+                PageGuard page = bufferPool.prefetchPage(request.pid.get());
+                auto *leaf = page.as<BTreeLeafPage>();
+                BTreePageId *next = leaf && request.followSiblings > 0 ? leaf->getRightSiblingId() : nullptr;
+                if (next != nullptr) {
+                    std::lock_guard queueLock(latch);
+                    // the rest of the chain goes first, it is the next thing the scan reads
+                    queue.push_front({std::unique_ptr<PageId>(next), request.followSiblings - 1});
+                }
+            }
+        } catch (const std::exception &) {
+            // read-ahead is best effort, e.g. no frame could be evicted
+        }
+
+        lock.lock();
+        active--;
+        if (queue.empty() && active == 0) {
+            idle.notify_all();
+        }
+    }
+}
+
+PrefetchStats Prefetcher::getStats() const {
+    return {issued.load(std::memory_order_relaxed), loaded.load(std::memory_order_relaxed),
+            hits.load(std::memory_order_relaxed), wasted.load(std::memory_order_relaxed)};
+}
+
+//
+// ReadAhead
+//
+
+void ReadAhead::access(const HeapPageId &pid, int numPages) {
+    int pgNo = pid.pageNumber();
+    run = pgNo == lastPage + 1 ? run + 1 : 0;
+    lastPage = pgNo;
+    Prefetcher &prefetcher = Database::getBufferPool().getPrefetcher();
+    int window = prefetcher.getWindow();
+    if (window == 0 || run < SEQUENTIAL_RUN) {
+        return;
+    }
+    int last = std::min(pgNo + window, numPages - 1);
+    for (int next = std::max(ahead + 1, pgNo + 1); next <= last; next++) {
+        prefetcher.prefetch({pid.getTableId(), next});
+    }
+    ahead = std::max(ahead, last);
+}
+
+void ReadAhead::accessLeaf(const BTreePageId *next) {
+    run++;
+    ahead = std::max(ahead - 1, 0);
+    Prefetcher &prefetcher = Database::getBufferPool().getPrefetcher();
+    int window = prefetcher.getWindow();
+    if (window == 0 || run < SEQUENTIAL_RUN || next == nullptr || ahead > 0) {
+        return;
+    }
+    // the leaves after the requested ones are only known once they are read
+    prefetcher.prefetchLeaves(*next, window);
+    ahead = window;
+}
@@ -0,0 +1,183 @@
+#include <db/ReplacementPolicy.h>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace db;
+
+std::unique_ptr<ReplacementPolicy> ReplacementPolicy::create(ReplacementPolicyType type, size_t numFrames) {
+    switch (type) {
+        case ReplacementPolicyType::CLOCK:
+            return std::make_unique<ClockPolicy>(numFrames);
+        case ReplacementPolicyType::LRU_K:
+            return std::make_unique<LRUKPolicy>(numFrames);
+        case ReplacementPolicyType::TWO_Q:
+            return std::make_unique<TwoQPolicy>(numFrames);
+        default:
+            throw std::invalid_argument("unexpected replacement policy");
+    }
+}
+
+//
+// ClockPolicy
+//
+
+ClockPolicy::ClockPolicy(size_t numFrames) : present(numFrames), referenced(numFrames), evictable(numFrames) {}
+
+void ClockPolicy::recordAccess(size_t frame) {
+    present[frame] = true;
+    referenced[frame] = true;
+}
+
+void ClockPolicy::setEvictable(size_t frame, bool value) {
+    evictable[frame] = value;
+}
+
+void ClockPolicy::remove(size_t frame) {
+    present[frame] = false;
+    referenced[frame] = false;
+    evictable[frame] = false;
+}
+
+std::optional<size_t> ClockPolicy::evict() {
+    size_t n = present.size();
+    // two sweeps are enough: the first one clears every reference bit
+    for (size_t step = 0; step < 2 * n; step++) {
+        size_t frame = hand;
+        hand = (hand + 1) % n;
+        if (!present[frame] || !evictable[frame]) {
+            continue;
+        }
+        if (referenced[frame]) {
+            referenced[frame] = false;
+            continue;
+        }
+        remove(frame);
+        return frame;
+    }
+    return std::nullopt;
+}
+
+//
+// LRUKPolicy
+//
+
+LRUKPolicy::LRUKPolicy(size_t numFrames, size_t k) : k(k), history(numFrames), evictable(numFrames) {}
+
+LRUKPolicy::Key LRUKPolicy::getKey(size_t frame) const {
+    const auto &h = history[frame];
+    // front() is the K-th most recent reference, or the first one if there are fewer than K
+    return {h.size() >= k, h.front(), frame};
+}
+
+void LRUKPolicy::recordAccess(size_t frame) {
+    auto &h = history[frame];
+    bool candidate = evictable[frame] && !h.empty();
+    if (candidate) {
+        candidates.erase(getKey(frame));
+    }
+    h.push_back(now++);
+    if (h.size() > k) {
+        h.pop_front();
+    }
+    if (evictable[frame]) {
+        candidates.insert(getKey(frame));
+    }
+}
+
+void LRUKPolicy::setEvictable(size_t frame, bool value) {
+    if (evictable[frame] == value) {
+        return;
+    }
+    if (!history[frame].empty()) {
+        if (value) {
+            candidates.insert(getKey(frame));
+        } else {
+            candidates.erase(getKey(frame));
+        }
+    }
+    evictable[frame] = value;
+}
+
+void LRUKPolicy::remove(size_t frame) {
+    if (evictable[frame] && !history[frame].empty()) {
+        candidates.erase(getKey(frame));
+    }
+    history[frame].clear();
+    evictable[frame] = false;
+}
+
+std::optional<size_t> LRUKPolicy::evict() {
+    if (candidates.empty()) {
+        return std::nullopt;
+    }
+    size_t victim = std::get<2>(*candidates.begin());
+    remove(victim);
+    return victim;
+}
+
+//
+// TwoQPolicy
+//
+
+TwoQPolicy::TwoQPolicy(size_t numFrames) : a1Threshold(std::max<size_t>(1, numFrames / 4)), queue(numFrames),
+                                           position(numFrames), evictable(numFrames) {}
+
+void TwoQPolicy::recordAccess(size_t frame) {
+    switch (queue[frame]) {
+        case Queue::NONE:
+            a1.push_front(frame);
+            position[frame] = a1.begin();
+            queue[frame] = Queue::A1;
+            break;
+        case Queue::A1:
+            a1.erase(position[frame]);
+            am.push_front(frame);
+            position[frame] = am.begin();
+            queue[frame] = Queue::AM;
+            break;
+        case Queue::AM:
+            am.splice(am.begin(), am, position[frame]);
+            break;
+    }
+}
+
+void TwoQPolicy::setEvictable(size_t frame, bool value) {
+    evictable[frame] = value;
+}
+
+void TwoQPolicy::remove(size_t frame) {
+    if (queue[frame] == Queue::A1) {
+        a1.erase(position[frame]);
+    } else if (queue[frame] == Queue::AM) {
+        am.erase(position[frame]);
+    }
+    queue[frame] = Queue::NONE;
+    evictable[frame] = false;
+}
+
+std::optional<size_t> TwoQPolicy::evictFrom(std::list<size_t> &q) {
+    for (auto it = q.rbegin(); it != q.rend(); ++it) {
+        if (evictable[*it]) {
+            size_t frame = *it;
+            remove(frame);
+            return frame;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<size_t> TwoQPolicy::evict() {
+    std::optional<size_t> victim;
+    if (a1.size() > a1Threshold || am.empty()) {
+        victim = evictFrom(a1);
+        if (!victim) {
+            victim = evictFrom(am);
+        }
+    } else {
+        victim = evictFrom(am);
+        if (!victim) {
+            victim = evictFrom(a1);
+        }
+    }
+    return victim;
+}
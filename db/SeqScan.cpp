@@ -2,6 +2,7 @@
 #include <db/Database.h>
 #include <db/Catalog.h>
 #include <db/BufferPool.h>
+#include <type_traits>
 
 using namespace db;
 
@@ -17,42 +18,101 @@ std::string SeqScan::getAlias() const {
     return alias;
 }
 
+SeqScan::SeqScan(int tableid, const std::string &tableAlias, std::vector<Morsel> morsels) {
+    reset(tableid, tableAlias);
+    this->morsels = std::move(morsels);
+}
+
 void SeqScan::reset(int tabid, const std::string &tableAlias) {
-    itopt = std::nullopt;
+    range = std::nullopt;
+    morsels = std::nullopt;
+    columns = std::nullopt;
     tableid = tabid;
     alias = tableAlias;
     tableName = Database::getCatalog().getTableName(tableid);
 }
 
 const TupleDesc &SeqScan::getTupleDesc() const {
+    if (columns) {
+        return projectedTd;
+    }
     return Database::getCatalog().getTupleDesc(tableid);
 }
 
+void SeqScan::setProjection(const std::vector<int> &columns) {
+    const TupleDesc &td = Database::getCatalog().getTupleDesc(tableid);
+    if (columns.empty()) {
+        throw std::runtime_error("empty projection");
+    }
+    std::vector<Types::Type> types;
+    std::vector<std::string> names;
+    for (int column: columns) {
+        if (column < 0 || static_cast<size_t>(column) >= td.numFields()) {
+            throw std::runtime_error("no such field");
+        }
+        types.push_back(td.getFieldType(column));
+        names.push_back(td.getFieldName(column));
+    }
+    this->columns = columns;
+    projectedTd = TupleDesc(types, names);
+}
+
 SeqScan::SeqScan(int tableid) : SeqScan(tableid, Database::getCatalog().getTableName(tableid)) {}
 
 void SeqScan::open() {
-    DbFile *file = Database::getCatalog().getDatabaseFile(tableid);
-    if (auto heapFile = dynamic_cast<HeapFile *>(file)) {
-        itopt = heapFile->begin();
-    } else {
+    auto *file = dynamic_cast<PagedFile *>(Database::getCatalog().getDatabaseFile(tableid));
+    if (!file) {
         throw std::runtime_error("can't open");
     }
+    nextMorsel = 0;
+    if (!morsels) {
+        openRange(0, file->getNumPages());
+    } else {
+        // the first morsel is opened by hasNext, like the next ones
+        openRange(0, 0);
+    }
 }
 
 bool SeqScan::hasNext() {
-    DbFile *file = Database::getCatalog().getDatabaseFile(tableid);
-    if (auto heapFile = dynamic_cast<HeapFile *>(file)) {
-        auto it = itopt.value();
-        return it != heapFile->end();
+    if (!range) {
+        throw std::runtime_error("can't next");
     }
-    throw std::runtime_error("can't next");
+    while (!std::visit([](auto &r) { return r.it != r.end; }, *range)) {
+        if (!morsels || nextMorsel == morsels->size()) {
+            return false;
+        }
+        const Morsel &morsel = (*morsels)[nextMorsel++];
+        openRange(morsel.pageLo, morsel.pageHi);
+    }
+    return true;
 }
 
 Tuple SeqScan::next() {
-    auto it = itopt.value();
-    auto tup = *it;
-    itopt = ++it;
-    return tup;
+    return std::visit([this](auto &r) { return next(r); }, range.value());
+}
+
+template<typename P>
+Tuple SeqScan::next(Range<P> &range) {
+    if constexpr (std::is_same_v<P, HeapPage>) {
+        if (columns) {
+            // only the projected fields are decoded
+            Tuple tup = range.it.getPage()->projectTuple(range.it.getSlot(), *columns, projectedTd);
+            ++range.it;
+            return tup;
+        }
+    }
+    // advanced in place, a copy of the iterator would pin its page once more
+    Tuple tup = *range.it;
+    ++range.it;
+    if (!columns) {
+        return tup;
+    }
+    Tuple projected(projectedTd);
+    projected.setRecordId(tup.getRecordId());
+    for (size_t i = 0; i < columns->size(); i++) {
+        projected.setField(static_cast<int>(i), &tup.getField((*columns)[i]));
+    }
+    return projected;
 }
 
 void SeqScan::rewind() {
@@ -61,5 +121,20 @@ void SeqScan::rewind() {
 }
 
 void SeqScan::close() {
-    itopt = std::nullopt;
+    range = std::nullopt;
+}
+
+void SeqScan::openRange(int pageLo, int pageHi) {
+    // the page of the previous range is unpinned before the first one of this range is read
+    range = std::nullopt;
+    DbFile *file = Database::getCatalog().getDatabaseFile(tableid);
+    if (auto *heapFile = dynamic_cast<HeapFile *>(file)) {
+        range.emplace(std::in_place_type<Range<HeapPage>>, heapFile->scan(pageLo, pageHi));
+    } else if (auto *slottedFile = dynamic_cast<SlottedFile *>(file)) {
+        range.emplace(std::in_place_type<Range<SlottedPage>>, slottedFile->scan(pageLo, pageHi));
+    } else if (auto *paxFile = dynamic_cast<PaxFile *>(file)) {
+        range.emplace(std::in_place_type<Range<PaxPage>>, paxFile->scan(pageLo, pageHi));
+    } else {
+        throw std::runtime_error("can't open");
+    }
 }
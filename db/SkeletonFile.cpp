@@ -31,7 +31,7 @@ void *SkeletonPage::getPageData() const {
 
 SkeletonPage::SkeletonPage(const PageId &pid) : pid(pid) {}
 
-Page *SkeletonFile::readPage(const PageId &pid) {
+Page *SkeletonFile::readPage(const PageId &pid, uint8_t *frame) {
     return new SkeletonPage(pid);
 }
 
@@ -43,13 +43,13 @@ SkeletonFileIterator SkeletonFile::end() const {
     throw std::runtime_error(std::string(__PRETTY_FUNCTION__) + " not implemented");
 }
 
-std::vector<Page *> SkeletonFile::insertTuple(TransactionId tid, Tuple &t) {
-    std::vector<Page *> pages;
+std::vector<PageGuard> SkeletonFile::insertTuple(TransactionId tid, Tuple &t) {
+    std::vector<PageGuard> pages;
     return pages;
 }
 
-std::vector<Page *> SkeletonFile::deleteTuple(TransactionId tid, Tuple &t) {
-    std::vector<Page *> pages;
+std::vector<PageGuard> SkeletonFile::deleteTuple(TransactionId tid, Tuple &t) {
+    std::vector<PageGuard> pages;
     return pages;
 }
 
@@ -57,6 +57,10 @@ void SkeletonFile::writePage(Page *p) {
     writes++;
 }
 
+void SkeletonFile::sync() {
+    syncs++;
+}
+
 int SkeletonFile::getNumPages() const {
     return 0;
 }
@@ -0,0 +1,52 @@
+#include <db/SlottedFile.h>
+#include <db/BufferPool.h>
+#include <db/Database.h>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace db;
+
+SlottedFile::SlottedFile(const char *fname, const TupleDesc &td, IoBackendType ioBackend)
+        : PagedFile(fname, td, ioBackend) {
+    if (static_cast<size_t>(Database::getBufferPool().getPageSize()) > SlottedPage::MAX_PAGE_SIZE) {
+        throw std::runtime_error("Page size too large for slotted pages");
+    }
+    // the last page is filled up to its last byte, as the records that still fit arrive
+    fillLastPage = true;
+}
+
+Page *SlottedFile::createPage(const HeapPageId &pid, uint8_t *frame) {
+    return new SlottedPage(pid, frame);
+}
+
+void *SlottedFile::createEmptyPageData() const {
+    return SlottedPage::createEmptyPageData();
+}
+
+bool SlottedFile::hasRoom(const Page *page, const Tuple &t) const {
+    return dynamic_cast<const SlottedPage *>(page)->getFreeSpace() >= SlottedPage::getRecordSize(td, t);
+}
+
+bool SlottedFile::isFree(const Page *page) const {
+    return dynamic_cast<const SlottedPage *>(page)->getFreeSpace() >= SlottedPage::getMaxRecordSize(td);
+}
+
+void SlottedFile::insertInto(Page *page, Tuple &t) {
+    dynamic_cast<SlottedPage *>(page)->insertTuple(&t);
+}
+
+void SlottedFile::deleteFrom(Page *page, Tuple &t) {
+    dynamic_cast<SlottedPage *>(page)->deleteTuple(&t);
+}
+
+SlottedFileIterator SlottedFile::begin() const {
+    return scan(0, getNumPages()).begin();
+}
+
+SlottedFileIterator SlottedFile::end() const {
+    return scan(0, getNumPages()).end();
+}
+
+SlottedFileRange SlottedFile::scan(int pageLo, int pageHi) const {
+    return {getId(), pageLo, std::min(pageHi, getNumPages())};
+}
@@ -0,0 +1,265 @@
+#include <db/SlottedPage.h>
+#include <db/Database.h>
+#include <db/IntField.h>
+#include <db/StringField.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+using namespace db;
+
+namespace {
+    size_t getStringLength(const Field &field) {
+        return std::min(dynamic_cast<const StringField &>(field).getValue().size(), Types::STRING_LEN - 1);
+    }
+}
+
+//
+// SlottedPageIterator
+//
+
+SlottedPageIterator::SlottedPageIterator(int slot, const SlottedPage *page) : slot(slot), page(page) {
+    while (this->slot < page->getNumSlots() && !page->isSlotUsed(this->slot)) {
+        this->slot++;
+    }
+}
+
+bool SlottedPageIterator::operator!=(const SlottedPageIterator &other) const {
+    return slot != other.slot || page != other.page;
+}
+
+SlottedPageIterator &SlottedPageIterator::operator++() {
+    do {
+        slot++;
+    } while (slot < page->getNumSlots() && !page->isSlotUsed(slot));
+    return *this;
+}
+
+const Tuple &SlottedPageIterator::operator*() const {
+    return page->getTuple(slot);
+}
+
+//
+// SlottedPage
+//
+
+SlottedPage::SlottedPage(const HeapPageId &id, const uint8_t *data)
+        : pid(id), td(Database::getCatalog().getTupleDesc(id.getTableId())),
+          image(data, data + Database::getBufferPool().getPageSize()) {
+    decoded.resize(getNumSlots());
+}
+
+uint16_t SlottedPage::getWord(size_t offset) const {
+    uint16_t value;
+    memcpy(&value, image.data() + offset, sizeof(value));
+    return value;
+}
+
+void SlottedPage::setWord(size_t offset, uint16_t value) {
+    memcpy(image.data() + offset, &value, sizeof(value));
+}
+
+size_t SlottedPage::getDataStart() const {
+    size_t start = getWord(sizeof(uint16_t));
+    return start == 0 ? image.size() : start;
+}
+
+void SlottedPage::setSlot(int slot, size_t offset, size_t length) {
+    setWord(HEADER_SIZE + slot * SLOT_SIZE, static_cast<uint16_t>(offset));
+    setWord(HEADER_SIZE + slot * SLOT_SIZE + sizeof(uint16_t), static_cast<uint16_t>(length));
+}
+
+int SlottedPage::findFreeSlot() const {
+    int slot = 0;
+    while (slot < getNumSlots() && isSlotUsed(slot)) {
+        slot++;
+    }
+    return slot;
+}
+
+const PageId &SlottedPage::getId() const {
+    return pid;
+}
+
+void *SlottedPage::getPageData() const {
+    auto *data = new uint8_t[image.size()];
+    memcpy(data, image.data(), image.size());
+    return data;
+}
+
+void *SlottedPage::createEmptyPageData() {
+    return new uint8_t[Database::getBufferPool().getPageSize()]{};
+}
+
+size_t SlottedPage::getRecordSize(const TupleDesc &td, const Tuple &t) {
+    size_t size = SLOT_SIZE;
+    for (size_t i = 0; i < td.numFields(); i++) {
+        if (td.getFieldType(i) == Types::INT_TYPE) {
+            size += sizeof(int);
+        } else {
+            size += sizeof(uint16_t) + getStringLength(t.getField(static_cast<int>(i)));
+        }
+    }
+    return size;
+}
+
+size_t SlottedPage::getMaxRecordSize(const TupleDesc &td) {
+    size_t size = SLOT_SIZE;
+    for (const auto &item: td) {
+        size += item.fieldType == Types::INT_TYPE ? sizeof(int) : sizeof(uint16_t) + Types::STRING_LEN - 1;
+    }
+    return size;
+}
+
+size_t SlottedPage::getFreeSpace() const {
+    size_t free = getDataStart() - HEADER_SIZE - getNumSlots() * SLOT_SIZE;
+    // a free slot of the directory is reused, its entry is already counted
+    return findFreeSlot() < getNumSlots() ? free + SLOT_SIZE : free;
+}
+
+int SlottedPage::getNumTuples() const {
+    int n = 0;
+    for (int slot = 0; slot < getNumSlots(); slot++) {
+        n += isSlotUsed(slot);
+    }
+    return n;
+}
+
+bool SlottedPage::isSlotUsed(int slot) const {
+    return getSlotLength(slot) != 0;
+}
+
+void SlottedPage::writeRecord(uint8_t *data, const Tuple &t) const {
+    for (size_t i = 0; i < td.numFields(); i++) {
+        const Field &field = t.getField(static_cast<int>(i));
+        if (td.getFieldType(i) == Types::INT_TYPE) {
+            int value = dynamic_cast<const IntField &>(field).getValue();
+            memcpy(data, &value, sizeof(value));
+            data += sizeof(value);
+        } else {
+            std::string value = dynamic_cast<const StringField &>(field).getValue();
+            auto len = static_cast<uint16_t>(std::min(value.size(), Types::STRING_LEN - 1));
+            memcpy(data, &len, sizeof(len));
+            memcpy(data + sizeof(len), value.data(), len);
+            data += sizeof(len) + len;
+        }
+    }
+}
+
+void SlottedPage::insertTuple(Tuple *t) {
+    if (td != t->getTupleDesc()) {
+        throw std::runtime_error("Wrong tuple description");
+    }
+    size_t size = getRecordSize(td, *t);
+    if (size > getFreeSpace()) {
+        throw std::runtime_error("No space");
+    }
+    int slot = findFreeSlot();
+    if (slot == getNumSlots()) {
+        setWord(0, static_cast<uint16_t>(slot + 1));
+    }
+    size_t length = size - SLOT_SIZE;
+    size_t offset = getDataStart() - length;
+    writeRecord(image.data() + offset, *t);
+    setWord(sizeof(uint16_t), static_cast<uint16_t>(offset));
+    setSlot(slot, offset, length);
+    t->setRecordId(new RecordId(&pid, slot));
+    std::lock_guard lock(latch);
+    retire(slot);
+}
+
+void SlottedPage::deleteTuple(Tuple *t) {
+    int slot = t->getRecordId()->getTupleno();
+    if (*t->getRecordId()->getPageId() != pid) {
+        throw std::runtime_error("Wrong page");
+    }
+    if (slot >= getNumSlots() || !isSlotUsed(slot)) {
+        throw std::runtime_error("Empty slot");
+    }
+    size_t offset = getSlotOffset(slot);
+    size_t length = getSlotLength(slot);
+    size_t start = getDataStart();
+    // close the gap: the records before the deleted one move up by its length
+    memmove(image.data() + start + length, image.data() + start, offset - start);
+    memset(image.data() + start, 0, length);
+    for (int other = 0; other < getNumSlots(); other++) {
+        if (isSlotUsed(other) && getSlotOffset(other) < offset) {
+            setSlot(other, getSlotOffset(other) + length, getSlotLength(other));
+        }
+    }
+    setSlot(slot, 0, 0);
+    start += length;
+    setWord(sizeof(uint16_t), static_cast<uint16_t>(start == image.size() ? 0 : start));
+    // free slots at the end of the directory are given back
+    int numSlots = getNumSlots();
+    while (numSlots > 0 && !isSlotUsed(numSlots - 1)) {
+        numSlots--;
+    }
+    setWord(0, static_cast<uint16_t>(numSlots));
+    std::lock_guard lock(latch);
+    retire(slot);
+}
+
+void SlottedPage::retire(int slot) {
+    // a tuple decoded from a slot before it changed is kept for its readers, not reused
+    if (static_cast<size_t>(slot) < decoded.size() && decoded[slot]) {
+        retired.push_back(std::move(decoded[slot]));
+    }
+    for (size_t i = getNumSlots(); i < decoded.size(); i++) {
+        if (decoded[i]) {
+            retired.push_back(std::move(decoded[i]));
+        }
+    }
+    decoded.resize(getNumSlots());
+}
+
+void SlottedPage::reclaim() {
+    std::lock_guard lock(latch);
+    retired.clear();
+}
+
+size_t SlottedPage::getNumRetired() const {
+    std::lock_guard lock(latch);
+    return retired.size();
+}
+
+const Tuple &SlottedPage::getTuple(int slot) const {
+    std::lock_guard lock(latch);
+    if (decoded[slot]) {
+        return decoded[slot]->tuple;
+    }
+    decoded[slot] = std::make_unique<Decoded>(td, &pid, slot);
+    Decoded &d = *decoded[slot];
+    d.tuple.setRecordId(&d.rid);
+    const uint8_t *data = image.data() + getSlotOffset(slot);
+    for (size_t i = 0; i < td.numFields(); i++) {
+        const Field *f;
+        if (td.getFieldType(i) == Types::INT_TYPE) {
+            int value;
+            memcpy(&value, data, sizeof(value));
+            f = new IntField(value);
+            data += sizeof(value);
+        } else {
+            uint16_t len;
+            memcpy(&len, data, sizeof(len));
+            char value[Types::STRING_LEN];
+            len = std::min<uint16_t>(len, Types::STRING_LEN - 1);
+            memcpy(value, data + sizeof(len), len);
+            value[len] = '\0';
+            f = new StringField(value);
+            data += sizeof(len) + len;
+        }
+        d.fields.emplace_back(f);
+        d.tuple.setField(static_cast<int>(i), f);
+    }
+    return d.tuple;
+}
+
+SlottedPageIterator SlottedPage::begin() const {
+    return {0, this};
+}
+
+SlottedPageIterator SlottedPage::end() const {
+    return {getNumSlots(), this};
+}
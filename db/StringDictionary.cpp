@@ -0,0 +1,126 @@
+#include <db/StringDictionary.h>
+#include <db/Type.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace db;
+
+StringDictionary::StringDictionary(const std::string &path) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1) {
+        throw std::runtime_error("open");
+    }
+    try {
+        load();
+    } catch (...) {
+        // the destructor does not run for an object that was never constructed
+        close(fd);
+        throw;
+    }
+}
+
+void StringDictionary::load() {
+    struct stat st{};
+    if (fstat(fd, &st) == -1) {
+        throw std::runtime_error("fstat");
+    }
+    std::vector<char> data(st.st_size);
+    if (pread(fd, data.data(), data.size(), 0) != st.st_size) {
+        throw std::runtime_error("pread");
+    }
+    if (data.size() < sizeof(MAGIC) || memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        if (!data.empty()) {
+            throw std::runtime_error("Not a dictionary");
+        }
+        if (pwrite(fd, MAGIC, sizeof(MAGIC), 0) != sizeof(MAGIC)) {
+            throw std::runtime_error("write");
+        }
+        // a file torn before its magic is durable could not be told from another file
+        if (fdatasync(fd) == -1) {
+            throw std::runtime_error("fdatasync");
+        }
+        end = sizeof(MAGIC);
+        return;
+    }
+    size_t offset = sizeof(MAGIC);
+    uint16_t len;
+    while (offset + sizeof(len) <= data.size()) {
+        memcpy(&len, data.data() + offset, sizeof(len));
+        if (offset + sizeof(len) + len > data.size()) {
+            break;
+        }
+        const std::string &value = values.emplace_back(data.data() + offset + sizeof(len), len);
+        codes.emplace(value, static_cast<int>(values.size()));
+        offset += sizeof(len) + len;
+    }
+    // a torn record at the end belongs to no page on disk, it is dropped so that the file
+    // only holds whole records
+    end = static_cast<off_t>(offset);
+    if (end < st.st_size && ftruncate(fd, end) == -1) {
+        throw std::runtime_error("ftruncate");
+    }
+}
+
+StringDictionary::~StringDictionary() {
+    close(fd);
+}
+
+int StringDictionary::encode(std::string_view value) {
+    value = value.substr(0, Types::STRING_LEN - 1);
+    {
+        std::shared_lock lock(latch);
+        auto it = codes.find(value);
+        if (it != codes.end()) {
+            return it->second;
+        }
+    }
+    std::unique_lock lock(latch);
+    // another thread may have added it while the latch was released
+    auto it = codes.find(value);
+    if (it != codes.end()) {
+        return it->second;
+    }
+    auto len = static_cast<uint16_t>(value.size());
+    std::vector<char> record(sizeof(len) + len);
+    memcpy(record.data(), &len, sizeof(len));
+    memcpy(record.data() + sizeof(len), value.data(), len);
+    if (pwrite(fd, record.data(), record.size(), end) != static_cast<ssize_t>(record.size())) {
+        throw std::runtime_error("write");
+    }
+    if (fdatasync(fd) == -1) {
+        throw std::runtime_error("fdatasync");
+    }
+    end += static_cast<off_t>(record.size());
+    const std::string &stored = values.emplace_back(value);
+    int code = static_cast<int>(values.size());
+    codes.emplace(stored, code);
+    return code;
+}
+
+std::optional<int> StringDictionary::find(std::string_view value) const {
+    std::shared_lock lock(latch);
+    auto it = codes.find(value.substr(0, Types::STRING_LEN - 1));
+    if (it == codes.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::string_view StringDictionary::decode(int code) const {
+    std::shared_lock lock(latch);
+    if (code < 1 || static_cast<size_t>(code) > values.size()) {
+        throw std::runtime_error("Unknown code");
+    }
+    return values[code - 1];
+}
+
+int StringDictionary::size() const {
+    std::shared_lock lock(latch);
+    return static_cast<int>(values.size());
+}
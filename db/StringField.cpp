@@ -1,4 +1,5 @@
 #include <db/StringField.h>
+#include <algorithm>
 
 using namespace db;
 
@@ -33,8 +34,10 @@ Field *StringField::parse(void *data) {
     auto *ptr = (uint8_t *) data;
     int len;
     memcpy(&len, ptr, sizeof(int));
+    len = std::clamp(len, 0, static_cast<int>(Types::STRING_LEN) - 1);
     char value[Types::STRING_LEN];
     memcpy(value, ptr + sizeof(int), len);
+    value[len] = '\0';
     return new StringField(value);
 }
 
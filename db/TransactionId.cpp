@@ -1,7 +1,8 @@
 #include <db/TransactionId.h>
+#include <atomic>
 
 using namespace db;
 
-static int nextTransactionId = 0;
+static std::atomic<int> nextTransactionId = 0;
 
 TransactionId::TransactionId() : id(nextTransactionId++) {}
@@ -0,0 +1,117 @@
+#include <db/Vacuum.h>
+#include <db/BufferPool.h>
+#include <db/Database.h>
+#include <db/HeapPage.h>
+#include <stdexcept>
+#include <vector>
+
+using namespace db;
+
+Vacuum::Vacuum(HeapFile &file) : file(file) {}
+
+void Vacuum::setRelocationCallback(std::function<void(const RecordId &, const RecordId &)> callback) {
+    onRelocate = std::move(callback);
+}
+
+VacuumStats Vacuum::run() {
+    if (file.isMapped()) {
+        // the tuples would be moved, then the pages emptied for them could not be removed
+        throw std::runtime_error("Cannot vacuum a mapped file");
+    }
+    BufferPool &bufferPool = Database::getBufferPool();
+    int numPages = file.getNumPages();
+    VacuumStats stats{0, numPages, numPages};
+    if (numPages == 0) {
+        return stats;
+    }
+    // the live tuples fill the first target pages, the pages after them are emptied
+    long live = 0;
+    int slotsPerPage = 0;
+    for (int pgNo = 0; pgNo < numPages; pgNo++) {
+        HeapPageId hpid(file.getId(), pgNo);
+        PageGuard guard = bufferPool.fetchPage(&hpid);
+        auto *page = guard.as<HeapPage>();
+        slotsPerPage = page->getNumTuples();
+        live += slotsPerPage - page->getNumEmptySlots();
+    }
+    auto target = static_cast<int>((live + slotsPerPage - 1) / slotsPerPage);
+    for (int source = numPages - 1; source >= target; source--) {
+        if (!emptyPage(source, target, stats.tuplesMoved)) {
+            break;
+        }
+    }
+    truncate(target);
+    stats.pagesAfter = file.getNumPages();
+    return stats;
+}
+
+bool Vacuum::emptyPage(int source, int target, long &moved) {
+    BufferPool &bufferPool = Database::getBufferPool();
+    const TupleDesc &td = file.getTupleDesc();
+    TransactionId tid;
+    bool done = true;
+    try {
+        HeapPageId hpid(file.getId(), source);
+        // pinned, the fields of its tuples are copied from the page itself
+        PageGuard guard = bufferPool.fetchPage(tid, &hpid, Permissions::READ_WRITE);
+        auto *page = guard.as<HeapPage>();
+        std::vector<int> slots;
+        for (auto it = page->begin(); it != page->end(); ++it) {
+            slots.push_back(it.getSlot());
+        }
+        for (int slot: slots) {
+            const Tuple &tuple = *HeapPageIterator(slot, page);
+            Tuple copy(td);
+            for (size_t i = 0; i < td.numFields(); i++) {
+                copy.setField(static_cast<int>(i), &tuple.getField(static_cast<int>(i)));
+            }
+            bufferPool.insertTuple(tid, file.getId(), &copy);
+            const RecordId *to = copy.getRecordId();
+            if (to->getPageId()->pageNumber() >= target) {
+                // the first pages are full, e.g. of concurrent inserts: the tuple stays where it was
+                bufferPool.deleteTuple(tid, &copy);
+                delete to;
+                done = false;
+                break;
+            }
+            RecordId from(&hpid, slot);
+            Tuple original(td);
+            original.setRecordId(&from);
+            bufferPool.deleteTuple(tid, &original);
+            if (onRelocate) {
+                onRelocate(from, *to);
+            }
+            delete to;
+            moved++;
+        }
+    } catch (...) {
+        bufferPool.transactionComplete(tid, false);
+        throw;
+    }
+    bufferPool.transactionComplete(tid);
+    return done;
+}
+
+void Vacuum::truncate(int target) {
+    BufferPool &bufferPool = Database::getBufferPool();
+    TransactionId tid;
+    try {
+        int end = file.getNumPages();
+        int from = end;
+        while (from > target) {
+            HeapPageId hpid(file.getId(), from - 1);
+            // the exclusive lock keeps inserts out until the page is gone
+            PageGuard guard = bufferPool.fetchPage(tid, &hpid, Permissions::READ_WRITE);
+            auto *page = guard.as<HeapPage>();
+            if (page->getNumEmptySlots() != page->getNumTuples()) {
+                break;
+            }
+            from--;
+        }
+        file.truncate(from, end);
+    } catch (...) {
+        bufferPool.transactionComplete(tid, false);
+        throw;
+    }
+    bufferPool.transactionComplete(tid);
+}
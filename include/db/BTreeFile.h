@@ -9,6 +9,8 @@
 #include <db/TupleDesc.h>
 #include <db/PagesMap.h>
 #include <db/BTreeLeafPage.h>
+#include <db/Prefetcher.h>
+#include <db/PageGuard.h>
 
 namespace db {
     class BTreeFile;
@@ -18,8 +20,11 @@ namespace db {
         IndexPredicate *pred;
         BTreeFile *file;
 
+        /** Keeps current_leaf resident while its tuples are returned */
+        PageGuard guard;
         BTreeLeafPage *current_leaf;
         BTreeLeafPageIterator it;
+        ReadAhead readAhead;
     public:
         BTreeFileIterator(TransactionId tid, IndexPredicate *pred, BTreeFile *file, bool done=false);
 
@@ -391,7 +396,7 @@ namespace db {
          * @param pid - the id of the page to read from disk
          * @return the page constructed from the contents on disk
          */
-        Page *readPage(const PageId &pid) override;
+        Page *readPage(const PageId &pid, uint8_t *frame) override;
 
         /**
          * Write a page to disk.  This should not be called directly but should 
@@ -401,6 +406,10 @@ namespace db {
          */
         void writePage(Page *page) override;
 
+        void writePageData(const PageId &pid, const void *data) override;
+
+        void sync() override;
+
         /**
          * Returns the number of pages in this BTreeFile.
          */
@@ -452,7 +461,7 @@ namespace db {
          * many pages since parent pointers will need to be updated when an internal node splits.
          * @see splitLeafPage
          */
-        std::vector<Page *> insertTuple(TransactionId tid, Tuple &t) override;
+        std::vector<PageGuard> insertTuple(TransactionId tid, Tuple &t) override;
 
         /**
          * Delete a tuple from this BTreeFile. 
@@ -465,7 +474,7 @@ namespace db {
          * many pages since parent pointers will need to be updated when an internal node merges.
          * @see handleMinOccupancyPage
          */
-        std::vector<Page *> deleteTuple(TransactionId tid, Tuple &t) override;
+        std::vector<PageGuard> deleteTuple(TransactionId tid, Tuple &t) override;
 
         /**
          * Get a read lock on the root pointer page. Create the root pointer page and root page
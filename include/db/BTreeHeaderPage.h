@@ -38,6 +38,10 @@ namespace db {
          */
         BTreeHeaderPage(const BTreePageId *id, uint8_t *data);
 
+        BTreeHeaderPage(const BTreeHeaderPage &) = delete;
+
+        ~BTreeHeaderPage() override;
+
         /**
          * Initially mark all slots in the header used.
          */
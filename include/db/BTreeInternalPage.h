@@ -130,6 +130,10 @@ namespace db {
          */
         BTreeInternalPage(const BTreePageId &id, uint8_t *data, int key);
 
+        BTreeInternalPage(const BTreeInternalPage &) = delete;
+
+        ~BTreeInternalPage() override;
+
         /**
          * Retrieve the maximum number of entries this page can hold. (The number of keys)
           */
@@ -41,6 +41,8 @@ namespace db {
         uint8_t *header;
         Tuple *tuples;
         int numSlots;
+        /** Slots in use, kept up to date by markSlotUsed */
+        int numUsed;
         int leftSibling; // leaf node or 0
         int rightSibling; // leaf node or 0
 
@@ -92,6 +94,10 @@ namespace db {
          */
         BTreeLeafPage(const BTreePageId &id, uint8_t *data, int key);
 
+        BTreeLeafPage(const BTreeLeafPage &) = delete;
+
+        ~BTreeLeafPage() override;
+
         /**
          * Retrieve the maximum number of tuples this page can hold.
          */
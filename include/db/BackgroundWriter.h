@@ -0,0 +1,80 @@
+#ifndef DB_BACKGROUNDWRITER_H
+#define DB_BACKGROUNDWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace db {
+    class BufferPool;
+
+    struct BackgroundWriterStats {
+        /** Pages written by the background writer */
+        long pagesWritten;
+        /** Evictions that had to write their victim before reusing the frame */
+        long evictionFlushes;
+    };
+
+    /**
+     * BackgroundWriter keeps a share of the frames of the BufferPool clean, so that evictions
+     * rarely have to write their victim before they can reuse its frame.
+     * <p>
+     * Every interval, or as soon as an eviction had to write a dirty page, a worker thread
+     * counts the dirty pages of the pool and writes the excess. Dirty pages are written sorted
+     * by (table, page number), which lets the files merge pages that are adjacent on disk in
+     * a single write.
+     * <p>
+     * The writer is disabled until a clean target is set: it writes through the Catalog, so
+     * every file with pages in the pool must outlive the BufferPool.
+     */
+    class BackgroundWriter {
+        BufferPool &bufferPool;
+        std::atomic<double> cleanTarget{DEFAULT_CLEAN_TARGET};
+        std::atomic<int> intervalMs{DEFAULT_INTERVAL_MS};
+
+        std::mutex latch;
+        std::condition_variable cv;
+        bool stopping = false;
+        bool wakeup = false;
+        /** Started when a clean target is set */
+        std::thread worker;
+
+        std::atomic<long> pagesWritten{0};
+        std::atomic<long> evictionFlushes{0};
+
+        void run();
+
+    public:
+        /** Default share of the frames kept clean, the writer is disabled by default. */
+        static constexpr double DEFAULT_CLEAN_TARGET = 0;
+
+        /** Default time between two rounds of the writer */
+        static constexpr int DEFAULT_INTERVAL_MS = 10;
+
+        explicit BackgroundWriter(BufferPool &bufferPool);
+
+        BackgroundWriter(const BackgroundWriter &) = delete;
+
+        /**
+         * Stop the worker. Dirty pages are left in the pool.
+         */
+        ~BackgroundWriter();
+
+        /**
+         * @param share share of the frames to keep clean, in [0, 1]. 0 disables the writer.
+         */
+        void setCleanTarget(double share);
+
+        double getCleanTarget() const;
+
+        void setInterval(int ms);
+
+        /** Called by the BufferPool when an eviction writes a dirty victim, wakes the writer up */
+        void recordEvictionFlush();
+
+        BackgroundWriterStats getStats() const;
+    };
+}
+
+#endif
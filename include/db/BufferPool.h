@@ -4,6 +4,25 @@
 #include <db/Tuple.h>
 #include <db/TransactionId.h>
 #include <db/PagesMap.h>
+#include <db/ReplacementPolicy.h>
+#include <db/LockManager.h>
+#include <db/FrameArena.h>
+#include <db/Prefetcher.h>
+#include <db/BackgroundWriter.h>
+#include <db/Checkpointer.h>
+#include <db/DirtyPageIndex.h>
+#include <db/BufferPoolStats.h>
+#include <db/PageGuard.h>
+#include <db/LogManager.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 /**
  * BufferPool manages the reading and writing of pages into memory from
@@ -13,26 +32,229 @@
  * The BufferPool is also responsible for locking;  when a transaction fetches
  * a page, BufferPool checks that the transaction has the appropriate
  * locks to read/write the page.
+ * <p>
+ * Pages are read into frames of a FrameArena allocated once when the pool is created. A page
+ * that is evicted or discarded is deleted at once, unless it is pinned: it then keeps its frame
+ * until its last PageGuard is released. A pointer returned by getPage is only valid until the
+ * page can be evicted, callers that keep using a page while calling into the pool pin it with
+ * fetchPage.
+ * <p>
+ * All the methods of the BufferPool are thread-safe.
  */
 namespace db {
+    /**
+     * A page found dirty by BufferPool::snapshotDirtyPages, and the frame it was found in.
+     */
+    struct SnapshotPage {
+        int tableId;
+        int pageNo;
+        /** Frame of the arena, as recorded by the DirtyPageIndex */
+        size_t frame;
+    };
+
     class BufferPool {
+        friend class PageGuard;
+
         /** Default page size. Use the pageSize member instead. */
         static constexpr int PAGE_SIZE = 4096;
         /** Bytes per page, including header. */
         int pageSize = PAGE_SIZE;
         int numPages;
-        PagesMap pages;
+
+        /**
+         * A partition of the buffer pool. Pages are assigned to shards by hashing their PageId,
+         * and each shard has its own frames, replacement policy and latch, so threads working
+         * on different shards never contend.
+         * <p>
+         * Lookups of resident pages only take the latch in shared mode. The replacement policy
+         * is not thread-safe, so hits are appended to a lock-free access buffer and replayed
+         * into the policy by the next thread holding the latch in exclusive mode.
+         */
+        struct Shard {
+            static constexpr size_t ACCESS_BUFFER_SIZE = 64;
+
+            /** Index in the arena of the first frame of the shard */
+            size_t firstFrame;
+            std::shared_mutex latch;
+            PagesMap pages;
+            /** Frame holding each resident page */
+            std::unordered_map<const PageId *, size_t, hasher, equals> frameIds;
+            /** Page held by each frame, nullptr if the frame is free */
+            std::vector<Page *> frames;
+            std::vector<size_t> freeFrames;
+            /** Serializes releasedFrames, pins are released without the latch of the shard */
+            std::mutex releasedLatch;
+            /** Frames of removed pages whose last pin was released, moved to freeFrames when allocating */
+            std::vector<size_t> releasedFrames;
+            std::unique_ptr<ReplacementPolicy> policy;
+            /** Frames read by the prefetcher and not accessed since */
+            std::unique_ptr<std::atomic<bool>[]> prefetched;
+            std::array<std::atomic<size_t>, ACCESS_BUFFER_SIZE> accesses;
+            std::atomic<size_t> numAccesses{0};
+
+            Shard(size_t firstFrame, size_t numFrames, ReplacementPolicyType policyType);
+
+            Shard(const Shard &) = delete;
+
+            /**
+             * Delete the resident pages.
+             */
+            ~Shard();
+
+            /**
+             * Record a hit on frame while holding the latch in shared mode.
+             * @return true if the access buffer is full and should be drained
+             */
+            bool recordHit(size_t frame);
+
+            /**
+             * Replay the buffered hits into the policy. Requires the latch in exclusive mode.
+             */
+            void drainAccesses();
+        };
+
+        /** Frames of all the shards, it outlives the pages read into it */
+        FrameArena arena;
+        std::vector<std::unique_ptr<Shard>> shards;
+        /** Shards sorted by address: operations latching several shards latch them in this order */
+        std::vector<Shard *> latchOrder;
+        /** Next shard evictPage() tries first */
+        std::atomic<size_t> nextEvictShard{0};
+        LockManager lockManager;
+        BufferPoolStats stats;
+        /** Write-ahead log, nullptr until openLog is called */
+        std::unique_ptr<LogManager> log;
+        /** Frames dirtied by each running transaction */
+        DirtyPageIndex dirtyIndex;
+        /** Serializes the updates of the before images held by the frames */
+        std::mutex imageLatch;
+        /** Declared after the shards so their workers stop before the shards are destroyed */
+        BackgroundWriter writer;
+        Checkpointer checkpointer;
+        Prefetcher prefetcher;
+
+        Shard &getShard(const PageId *pid) const;
+
+        /**
+         * Return a free frame of shard, evicting a page of the shard if there is none.
+         */
+        size_t allocateFrame(Shard &shard);
+
+        uint8_t *getFrameData(const Shard &shard, size_t frame) const;
+
+        /**
+         * Make page resident in frame, which must be allocated.
+         */
+        void installPage(Shard &shard, size_t frame, Page *page);
+
+        /**
+         * Remove the page held by frame from shard. The page is deleted and its frame freed now
+         * if it is not pinned, or else when its last pin is released. The frame must already be
+         * removed from the replacement policy.
+         */
+        void removePage(Shard &shard, size_t frame);
+
+        /**
+         * Read pid from its file into a frame of shard. Requires the latch in exclusive mode.
+         */
+        Page *readPage(Shard &shard, const PageId *pid);
+
+        /**
+         * Look up pids, reading the missing ones in one batch per file. With prefetch, the
+         * accesses are not recorded and the pages read are flagged as prefetched.
+         */
+        void readPages(const std::vector<const PageId *> &pids, bool prefetch,
+                       const std::function<void(Page *)> &callback);
+
+        /**
+         * Cache page in shard, replacing any resident version of the same page. Throws if page
+         * was evicted or discarded, its callers keep it pinned until it is cached.
+         */
+        void cachePage(Shard &shard, Page *page);
+
+        /**
+         * Log the changes made to the page held by frame since its last log record. The frame
+         * holds the image of the page as of that record, it is the before image and is then
+         * replaced by the after image. Requires the latch, in shared mode at least, and the
+         * update latch of the page.
+         */
+        void logPage(Shard &shard, size_t frame);
+
+        /**
+         * Retrieve pid, pinning it if pin is set.
+         */
+        Page *getPage(const PageId *pid, bool pin);
+
+        /**
+         * Evict an unpinned page of shard.
+         * @return false if no page of the shard can be evicted
+         */
+        bool evictPage(Shard &shard);
+
+        void flushPage(Shard &shard, const PageId *pid);
+
+        /**
+         * Write dirty pages sorted by (table, page number), logging them first if there is a
+         * log. Their update latches are held from the log records until the writes, and pages
+         * that are not built in place are written from the logged image in their frame. The
+         * caller holds the latches of their shards; pages already written meanwhile are
+         * removed from dirty.
+         */
+        void writeDirtyPages(std::vector<Page *> &dirty);
+
+        /**
+         * @param dirtied frames of the arena, as recorded by the DirtyPageIndex
+         * @return the shard and frame of each of them
+         */
+        std::vector<std::pair<Shard *, size_t>> getDirtyFrames(const std::vector<size_t> &dirtied);
+
+        /**
+         * Write the dirty pages in frames accepted by filter, which is given the index of the
+         * frame. Only the shards of the frames are latched, in shared mode.
+         * @return the number of pages written
+         */
+        size_t flushFrames(const std::vector<std::pair<Shard *, size_t>> &frames,
+                           const std::function<bool(size_t, const Page *)> &filter);
+
+        void discardPage(Shard &shard, const PageId *pid);
+
+        /**
+         * Release a pin of page without throwing, for PageGuard destructors. Releasing the last
+         * pin of a removed page deletes it and frees its frame.
+         * @return false if the page is not pinned
+         */
+        bool releasePin(const Page *page) noexcept;
+
+        /**
+         * Pin page once more, for PageGuard copies. The page must be pinned already.
+         */
+        void retainPin(Page *page) noexcept;
+
+        /**
+         * Clear the prefetched flag of frame.
+         * @return true if the page had been prefetched and is accessed for the first time
+         */
+        bool takePrefetched(Shard &shard, size_t frame);
+
+        /**
+         * Count the page in frame as wasted if it was prefetched and never accessed.
+         */
+        void releasePrefetched(Shard &shard, size_t frame);
 
     public:
         BufferPool(const BufferPool &) = delete;
 
-        const PagesMap &getPages() const;
+        /**
+         * @return a snapshot of the pages currently resident in all the shards.
+         */
+        PagesMap getPages() const;
 
         const int &getNumPages() const;
 
         /**
          * Discards a page from the buffer pool.
          * Flushes the page to disk to ensure dirty pages are updated on disk.
+         * The page is chosen by the replacement policy of this buffer pool.
          */
         void evictPage();
 
@@ -43,11 +265,31 @@ namespace db {
          */
         static constexpr int DEFAULT_PAGES = 50;
 
+        /**
+         * Default replacement policy passed to the constructor.
+         */
+        static constexpr ReplacementPolicyType DEFAULT_POLICY = ReplacementPolicyType::LRU_K;
+
+        /**
+         * Default number of shards passed to the constructor.
+         */
+        static constexpr int DEFAULT_SHARDS = 1;
+
+        /**
+         * Whether the frames are backed by huge pages by default.
+         */
+        static constexpr bool DEFAULT_HUGE_PAGES = false;
+
         /**
          * Creates a BufferPool that caches up to numPages pages.
          * @param numPages maximum number of pages in this buffer pool.
+         * @param policyType the policy used to choose which page to evict.
+         * @param numShards number of independently latched partitions. Each shard holds
+         *                  numPages / numShards pages.
+         * @param hugePages back the frames with huge pages, if the system has some reserved.
          */
-        explicit BufferPool(int numPages) : numPages(numPages) {}
+        explicit BufferPool(int numPages, ReplacementPolicyType policyType = DEFAULT_POLICY,
+                            int numShards = DEFAULT_SHARDS, bool hugePages = DEFAULT_HUGE_PAGES);
 
         /**
          * Retrieve the specified page.
@@ -60,14 +302,147 @@ namespace db {
          * space in the buffer pool, an page should be evicted and the new page
          * should be added in its place.
          *
+         * @param tid the ID of the transaction requesting the page
+         * @param pid the ID of the requested page
+         * @param perm the requested permissions on the page
+         * @throws TransactionAbortedException if waiting for the lock would deadlock
+         */
+        Page *getPage(const TransactionId &tid, const PageId *pid, Permissions perm);
+
+        /**
+         * Retrieve the specified page without acquiring any lock.
+         * Used by iterators that do not run on behalf of a transaction.
+         *
          * @param pid the ID of the requested page
          */
         Page *getPage(const PageId *pid);
 
+        /**
+         * Retrieve the specified page like getPage and pin it: the page is not evicted until
+         * the returned guard is destroyed. Operations that keep using a page across calls into
+         * the buffer pool must hold a guard, or another thread may evict the page meanwhile.
+         * Pinning every frame of a shard makes reads into that shard fail.
+         */
+        PageGuard fetchPage(const TransactionId &tid, const PageId *pid, Permissions perm);
+
+        /**
+         * Retrieve and pin the specified page like fetchPage if its lock can be granted without
+         * waiting.
+         * @return an empty guard if another transaction holds or waits for a conflicting lock
+         */
+        PageGuard tryFetchPage(const TransactionId &tid, const PageId *pid, Permissions perm);
+
+        /**
+         * Retrieve and pin the specified page without acquiring any lock.
+         * @see fetchPage
+         */
+        PageGuard fetchPage(const PageId *pid);
+
+        /**
+         * Retrieve the specified page without acquiring any lock and pin it once more. Every
+         * pin must be released with unpinPage, PageGuard does both.
+         */
+        Page *pinPage(const PageId *pid);
+
+        /**
+         * Release a pin of page. A page discarded while it was pinned is deleted once its last
+         * pin is released.
+         */
+        void unpinPage(const Page *page);
+
+        /**
+         * @return the number of pins of the specified page, 0 if it is not resident
+         */
+        int getPinCount(const PageId *pid);
+
+        /**
+         * Read the specified page into the buffer pool on behalf of the Prefetcher, without
+         * acquiring any lock. A page that is already resident is returned as is and its access
+         * is not recorded; the first getPage of a prefetched page counts as its first access.
+         *
+         * @param pid the ID of the requested page
+         * @return the page, pinned so that it can be inspected for the next pages to read
+         */
+        PageGuard prefetchPage(const PageId *pid);
+
+        /**
+         * Retrieve several pages without acquiring any lock. The missing pages are read in one
+         * batch by their file, which may keep all the reads in flight at once, and callback is
+         * called with each page as soon as it is available. callback runs while the latches of
+         * the shards are held and must not call into the buffer pool.
+         *
+         * @param pids the pages to retrieve, at most as many as the pool holds
+         */
+        void getPages(const std::vector<const PageId *> &pids, const std::function<void(Page *)> &callback);
+
+        /**
+         * Read several pages into the buffer pool on behalf of the Prefetcher, in one batch.
+         *
+         * @see prefetchPage
+         */
+        void prefetchPages(const std::vector<const PageId *> &pids);
+
+        /**
+         * Return the Prefetcher reading pages ahead of the scans of this buffer pool.
+         */
+        Prefetcher &getPrefetcher() { return prefetcher; }
+
+        /**
+         * Recover the files of the Catalog from the write-ahead log at path, then log every
+         * update to it. Commits then only force the log, dirty pages are written whenever they
+         * are evicted or flushed, after the log records describing them.
+         * <p>
+         * Call it at startup, once the tables are added to the Catalog. The resident pages are
+         * flushed and discarded first, recovery writes the files directly.
+         */
+        void openLog(const std::string &path);
+
+        /**
+         * Return the write-ahead log, nullptr if openLog was not called and commits force the
+         * pages of the transaction instead.
+         */
+        LogManager *getLog() { return log.get(); }
+
+        /**
+         * Return the hit, miss, eviction and flush counters of this buffer pool.
+         */
+        const BufferPoolStats &getStats() const { return stats; }
+
+        /**
+         * Releases the lock on a page.
+         * Calling this is very risky, and may result in wrong behavior. Think hard
+         * about who needs to call this and why, and why they can run the risk of
+         * calling it.
+         *
+         * @param tid the ID of the transaction requesting the unlock
+         * @param pid the ID of the page to unlock
+         */
+        void unsafeReleasePage(const TransactionId &tid, const PageId *pid);
+
+        /**
+         * Return true if the specified transaction has a lock on the specified page
+         */
+        bool holdsLock(const TransactionId &tid, const PageId *pid);
+
+        /**
+         * Commit or abort a given transaction; release all locks associated to
+         * the transaction. On commit the pages dirtied by the transaction are
+         * written and synced to disk, on abort they are discarded so the next
+         * reader gets them back from disk.
+         * <p>
+         * With a write-ahead log, commit logs the pages and forces the log instead,
+         * sharing the sync with concurrent committers, and abort rolls the logged
+         * updates back on disk before discarding the pages.
+         *
+         * @param tid the ID of the transaction requesting the unlock
+         * @param commit a flag indicating whether we should commit or abort
+         */
+        void transactionComplete(const TransactionId &tid, bool commit = true);
+
         int getPageSize() const { return pageSize; }
 
         /** DO NOT USE */
-        void setPageSize(int newPageSize) { pageSize = newPageSize; }
+        void setPageSize(int newPageSize);
 
         /** DO NOT USE */
         void resetPageSize() { setPageSize(PAGE_SIZE); }
@@ -128,6 +503,52 @@ namespace db {
          * Write all pages of the specified transaction to disk.
          */
         void flushPages(const TransactionId &tid);
+
+        /**
+         * Write up to limit dirty pages to disk, in (table, page number) order.
+         * Used by the BackgroundWriter.
+         * @return the number of pages written
+         */
+        size_t flushDirtyPages(size_t limit);
+
+        /**
+         * @return the number of dirty pages in the pool
+         */
+        size_t countDirtyPages() const;
+
+        /**
+         * Write the dirty pages accepted by filter, at most limit of them. The pages are sorted
+         * by (table, page number) and each file writes its pages in one call, so that adjacent
+         * pages can be merged. The latches of all the shards are held in shared mode.
+         * @return the number of pages written
+         */
+        size_t flushDirtyPages(const std::function<bool(const Page *)> &filter, size_t limit);
+
+        /**
+         * Return the dirty pages, sorted by (table, page number). The latches of all the
+         * shards are held in exclusive mode, so no page is being written meanwhile: the pages
+         * that are not returned are on disk as they are in the pool.
+         * @param redoLsn set to the next LSN of the log while the latches are held
+         */
+        std::vector<SnapshotPage> snapshotDirtyPages(uint64_t &redoLsn);
+
+        /**
+         * Write the pages of a snapshot that are still dirty in the frames they were found in,
+         * the others were written, and maybe evicted, since. Each page is looked up by its
+         * frame and only the shards of the pages are latched, in shared mode.
+         * @return the number of pages written
+         */
+        size_t flushSnapshotPages(const std::vector<SnapshotPage> &pages);
+
+        /**
+         * Return the BackgroundWriter keeping frames of this buffer pool clean.
+         */
+        BackgroundWriter &getBackgroundWriter() { return writer; }
+
+        /**
+         * Return the Checkpointer of this buffer pool.
+         */
+        Checkpointer &getCheckpointer() { return checkpointer; }
     };
 }
 
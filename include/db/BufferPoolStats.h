@@ -0,0 +1,152 @@
+#ifndef DB_BUFFERPOOLSTATS_H
+#define DB_BUFFERPOOLSTATS_H
+
+#include <db/PageId.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace db {
+    enum class PageCategory {
+        HEAP, ROOT_PTR, INTERNAL, LEAF, HEADER, OTHER
+    };
+
+    /**
+     * @return the lower case name of category, as used in the JSON dump
+     */
+    const char *toString(PageCategory category);
+
+    /**
+     * Latencies in power of two buckets: bucket i counts latencies in [2^i, 2^(i+1)) ns.
+     */
+    struct LatencyHistogram {
+        static constexpr int BUCKETS = 32;
+
+        std::array<uint64_t, BUCKETS> buckets{};
+        uint64_t count = 0;
+        uint64_t totalNs = 0;
+
+        static int bucketOf(uint64_t ns);
+
+        /**
+         * @param p percentile, in [0, 1]
+         * @return upper bound of the bucket holding the p-th percentile, 0 if nothing was recorded
+         */
+        uint64_t percentileNs(double p) const;
+    };
+
+    /**
+     * Counters of the pages of one category of one table.
+     */
+    struct PageStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        /** Evictions that had to write their victim */
+        uint64_t dirtyEvictions = 0;
+        /** Pages written to disk */
+        uint64_t flushes = 0;
+        /** Reads of a page from its file, including read-ahead */
+        LatencyHistogram reads;
+        /** Writes of a page to its file. Pages written in one call share its latency. */
+        LatencyHistogram writes;
+
+        PageStats &operator+=(const PageStats &other);
+    };
+
+    /**
+     * BufferPoolStats counts the activity of a BufferPool per table and page category.
+     * <p>
+     * Every thread records into its own slot, so the hot path never writes a cache line
+     * shared with other threads: a counter update is a relaxed load and store by the only
+     * thread writing it. Queries sum the slots of all the threads that recorded anything,
+     * including the threads that exited since.
+     */
+    class BufferPoolStats {
+    public:
+        enum Counter {
+            HITS, MISSES, EVICTIONS, DIRTY_EVICTIONS, FLUSHES,
+            READS, WRITES = READS + LatencyHistogram::BUCKETS + 2,
+            NUM_COUNTERS = WRITES + LatencyHistogram::BUCKETS + 2
+        };
+
+    private:
+        using Cell = std::array<std::atomic<uint64_t>, NUM_COUNTERS>;
+
+        /** Counters of one thread */
+        struct Slot {
+            /** Held by the owner thread to insert cells, and by queries to read them */
+            std::mutex latch;
+            std::unordered_map<uint64_t, std::unique_ptr<Cell>> cells;
+        };
+
+        /** Cached slot of the calling thread */
+        struct Local {
+            uint64_t owner = 0;
+            std::shared_ptr<Slot> slot;
+            uint64_t lastKey = UINT64_MAX;
+            Cell *lastCell = nullptr;
+        };
+
+        /** Distinguishes instances, an address may be reused by a later BufferPool */
+        const uint64_t id;
+        mutable std::mutex latch;
+        std::vector<std::shared_ptr<Slot>> slots;
+
+        static Local &local();
+
+        Cell &cell(const PageId &pid);
+
+        void add(const PageId &pid, int counter, uint64_t n = 1);
+
+        void addLatency(const PageId &pid, int histogram, std::chrono::nanoseconds latency);
+
+    public:
+        BufferPoolStats();
+
+        BufferPoolStats(const BufferPoolStats &) = delete;
+
+        static PageCategory categoryOf(const PageId &pid);
+
+        void recordHit(const PageId &pid) { add(pid, HITS); }
+
+        void recordMiss(const PageId &pid) { add(pid, MISSES); }
+
+        void recordEviction(const PageId &pid, bool dirty);
+
+        void recordRead(const PageId &pid, std::chrono::nanoseconds latency) { addLatency(pid, READS, latency); }
+
+        /** Record the write of a page, counted as a flush */
+        void recordWrite(const PageId &pid, std::chrono::nanoseconds latency);
+
+        /**
+         * @return the counters per (table id, page category)
+         */
+        std::map<std::pair<int, PageCategory>, PageStats> getStats() const;
+
+        /**
+         * @return the counters of the table, all categories summed
+         */
+        PageStats getTableStats(int tableId) const;
+
+        /**
+         * @return the counters of the whole pool
+         */
+        PageStats getTotals() const;
+
+        /**
+         * Dump the counters as a JSON array with one object per (table, category).
+         */
+        std::string toJson() const;
+    };
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef DB_BULKLOADER_H
+#define DB_BULKLOADER_H
+
+#include <db/HeapFile.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace db {
+    enum class BulkFormat {
+        /** One row per line, fields separated by commas, strings optionally in double quotes */
+        CSV,
+        /** Rows back to back in the layout of the tuples of a HeapPage, getSize() bytes each */
+        BINARY
+    };
+
+    struct BulkLoadStats {
+        long rows;
+        /** Pages appended to the file */
+        int pages;
+    };
+
+    /**
+     * BulkLoader appends rows to a HeapFile without going through the BufferPool: the input
+     * is split in chunks that worker threads parse straight into full HeapPage images, and
+     * the pages of each chunk are appended with a single sequential write, in input order.
+     * The rows that do not fill the last page of a chunk are packed into shared pages, the
+     * order of the rows is therefore only kept within chunks.
+     * <p>
+     * The loaded pages are synced before load returns. They are not logged: a load is not
+     * part of a transaction, and no transaction may update the file while it runs.
+     */
+    class BulkLoader {
+        HeapFile &file;
+        BulkFormat format;
+        int threads;
+        size_t chunkSize = DEFAULT_CHUNK_SIZE;
+
+    public:
+        static constexpr size_t DEFAULT_CHUNK_SIZE = 16 << 20;
+
+        /**
+         * @param threads number of parsing threads, 0 for one per hardware thread
+         */
+        BulkLoader(HeapFile &file, BulkFormat format, int threads = 0);
+
+        /**
+         * @param bytes input each worker parses at once, rounded to whole rows
+         */
+        void setChunkSize(size_t bytes);
+
+        /**
+         * Load the rows of the file at path, which is mapped rather than read.
+         */
+        BulkLoadStats load(const char *path);
+
+        /**
+         * Load the rows in the size bytes at data.
+         */
+        BulkLoadStats load(const uint8_t *data, size_t size);
+    };
+}
+
+#endif
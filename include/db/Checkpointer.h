@@ -0,0 +1,114 @@
+#ifndef DB_CHECKPOINTER_H
+#define DB_CHECKPOINTER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace db {
+    class BufferPool;
+
+    struct CheckpointerStats {
+        /** Checkpoints completed, each with its record in the log */
+        long checkpoints;
+        /** Pages written by the checkpoints */
+        long pagesWritten;
+        /** Redo LSN of the last completed checkpoint, 0 if there was none */
+        uint64_t lastRedoLsn;
+    };
+
+    /**
+     * Checkpointer writes the pages that are dirty when a checkpoint starts, spread over a
+     * target duration and under a page rate limit, then logs a checkpoint record so recovery
+     * can skip the updates that are already on disk.
+     * <p>
+     * Unlike flushAllPages, which holds the latches of every shard in shared mode for the
+     * whole flush and so blocks every miss until it is done, the checkpoint writes small
+     * batches and sleeps between them; a miss waits for one batch at most. The dirty pages
+     * are collected under the exclusive latches of all the shards, which only takes a scan
+     * of the pool.
+     * <p>
+     * Pages are written whether their transaction committed or not, so checkpoints require
+     * the write-ahead log of the BufferPool. Checkpoints run in the calling thread, or every
+     * period in a worker thread once a period is set.
+     */
+    class Checkpointer {
+        BufferPool &bufferPool;
+        std::atomic<int> durationMs{DEFAULT_DURATION_MS};
+        std::atomic<int> maxPagesPerSecond{DEFAULT_MAX_PAGES_PER_SECOND};
+        std::atomic<int> batchPages{DEFAULT_BATCH_PAGES};
+
+        /** Serializes the checkpoints */
+        std::mutex running;
+
+        std::mutex latch;
+        std::condition_variable cv;
+        bool stopping = false;
+        std::chrono::milliseconds period{0};
+        /** Started when a period is set */
+        std::thread worker;
+
+        std::atomic<long> checkpoints{0};
+        std::atomic<long> pagesWritten{0};
+        std::atomic<uint64_t> lastRedoLsn{0};
+
+        void run();
+
+        /**
+         * Sleep until deadline, or until the Checkpointer stops.
+         * @return false if it stopped
+         */
+        bool sleepUntil(std::chrono::steady_clock::time_point deadline);
+
+    public:
+        /** Default time a checkpoint spreads its writes over */
+        static constexpr int DEFAULT_DURATION_MS = 1000;
+
+        /** Default page rate limit, 0 for none */
+        static constexpr int DEFAULT_MAX_PAGES_PER_SECOND = 0;
+
+        /** Default number of pages written at once */
+        static constexpr int DEFAULT_BATCH_PAGES = 16;
+
+        explicit Checkpointer(BufferPool &bufferPool);
+
+        Checkpointer(const Checkpointer &) = delete;
+
+        /**
+         * Stop the worker. A checkpoint in progress is abandoned without its record.
+         */
+        ~Checkpointer();
+
+        /**
+         * @param ms time a checkpoint spreads its writes over. It takes longer if the rate limit
+         *           does not allow writing all the pages in that time.
+         */
+        void setDuration(int ms);
+
+        /**
+         * @param pages maximum number of pages written per second, 0 for no limit
+         */
+        void setMaxRate(int pages);
+
+        void setBatchSize(int pages);
+
+        /**
+         * @param ms time between the start of two checkpoints of the worker, 0 stops taking
+         *           periodic checkpoints
+         */
+        void setPeriod(int ms);
+
+        /**
+         * Take a checkpoint and return once its record is durable.
+         * @return false if the Checkpointer was stopped before the checkpoint completed
+         */
+        bool checkpoint();
+
+        CheckpointerStats getStats() const;
+    };
+}
+
+#endif
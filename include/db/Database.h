@@ -15,7 +15,8 @@ namespace db::Database {
      * Method used for testing -- create a new instance of the buffer pool and
      * return it
      */
-    void resetBufferPool(int pages);
+    void resetBufferPool(int pages, ReplacementPolicyType policyType = BufferPool::DEFAULT_POLICY,
+                         int numShards = BufferPool::DEFAULT_SHARDS, bool hugePages = BufferPool::DEFAULT_HUGE_PAGES);
 
     /** reset the database, used for unit tests only. */
     void reset();
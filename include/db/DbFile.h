@@ -6,6 +6,9 @@
 #include <db/Tuple.h>
 #include <db/PageId.h>
 #include <db/Page.h>
+#include <db/PageGuard.h>
+#include <functional>
+#include <stdexcept>
 #include <vector>
 
 namespace db {
@@ -20,8 +23,27 @@ namespace db {
     public:
         /**
          * Read the specified page from disk.
+         *
+         * @param id the page to read
+         * @param frame the frame of the BufferPool the page is read into, BufferPool::getPageSize()
+         *              bytes aligned on 4 KiB. It belongs to the page until the page is evicted.
+         */
+        virtual Page *readPage(const PageId &id, uint8_t *frame) = 0;
+
+        /**
+         * Read several pages, calling callback with the index of each page in pids as soon
+         * as it is read. Files that can keep several reads in flight override this, by
+         * default the pages are read one after the other.
+         *
+         * @param pids the pages to read
+         * @param frames the frame each page is read into, see readPage
          */
-        virtual Page *readPage(const PageId &id) = 0;
+        virtual void readPages(const std::vector<const PageId *> &pids, const std::vector<uint8_t *> &frames,
+                               const std::function<void(size_t, Page *)> &callback) {
+            for (size_t i = 0; i < pids.size(); i++) {
+                callback(i, readPage(*pids[i], frames[i]));
+            }
+        }
 
         /**
          * Push the specified page to disk.
@@ -31,6 +53,34 @@ namespace db {
          */
         virtual void writePage(Page *p) = 0;
 
+        /**
+         * Push several pages to disk. Files override this to merge the writes of pages that
+         * are adjacent on disk, by default the pages are written one after the other.
+         *
+         * @param pages the pages to write, sorted by page number
+         */
+        virtual void writePages(const std::vector<Page *> &pages) {
+            for (Page *page: pages) {
+                writePage(page);
+            }
+        }
+
+        /**
+         * Write the raw image of a page, as logged by the LogManager. Used by recovery and
+         * rollback, which restore pages without going through the BufferPool.
+         *
+         * @param pid the page to write
+         * @param data the image, as returned by getPageData for a page of this kind
+         */
+        virtual void writePageData([[maybe_unused]] const PageId &pid, [[maybe_unused]] const void *data) {
+            throw std::runtime_error("Pages of this file cannot be restored");
+        }
+
+        /**
+         * Make the writes to the file durable.
+         */
+        virtual void sync() {}
+
         /**
          * Inserts the specified tuple to the file on behalf of transaction.
          * This method will acquire a lock on the affected pages of the file, and
@@ -39,9 +89,10 @@ namespace db {
          * @param tid The transaction performing the update
          * @param t The tuple to add.  This tuple should be updated to reflect that
          *          it is now stored in this file.
-         * @return A vector contain the pages that were modified
+         * @return Guards pinning the pages that were modified, so that they cannot be
+         *         evicted before the caller marked them dirty
          */
-        virtual std::vector<Page *> insertTuple(TransactionId tid, Tuple &t) = 0;
+        virtual std::vector<PageGuard> insertTuple(TransactionId tid, Tuple &t) = 0;
 
         /**
          * Removes the specified tuple from the file on behalf of the specified
@@ -52,9 +103,9 @@ namespace db {
          * @param tid The transaction performing the update
          * @param t The tuple to delete.  This tuple should be updated to reflect that
          *          it is no longer stored on any page.
-         * @return A vector contain the pages that were modified
+         * @return Guards pinning the pages that were modified
          */
-        virtual std::vector<Page *> deleteTuple(TransactionId tid, Tuple &t) = 0;
+        virtual std::vector<PageGuard> deleteTuple(TransactionId tid, Tuple &t) = 0;
 
         /**
          * Returns a unique ID used to identify this DbFile in the Catalog. This id
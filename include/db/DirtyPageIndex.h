@@ -0,0 +1,50 @@
+#ifndef DB_DIRTYPAGEINDEX_H
+#define DB_DIRTYPAGEINDEX_H
+
+#include <db/TransactionId.h>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace db {
+    /**
+     * DirtyPageIndex records the frames of a BufferPool each running transaction dirtied,
+     * so that commit and abort visit the pages of the transaction instead of the whole pool,
+     * and the tables of those pages, which a commit syncs even if their pages were written
+     * earlier by an eviction, the BackgroundWriter or a checkpoint.
+     * <p>
+     * Entries are never removed when a page leaves its frame: a frame may hold another page
+     * by the time it is looked up, and callers check that the page is still dirtied by the
+     * transaction.
+     */
+    class DirtyPageIndex {
+        struct Entry {
+            std::unordered_set<size_t> frames;
+            std::unordered_set<int> tables;
+        };
+
+        std::mutex latch;
+        std::unordered_map<int, Entry> entries;
+
+    public:
+        DirtyPageIndex() = default;
+
+        DirtyPageIndex(const DirtyPageIndex &) = delete;
+
+        void add(const TransactionId &tid, size_t frame, int tableId);
+
+        /**
+         * @return the frames dirtied by tid since it started
+         */
+        std::vector<size_t> get(const TransactionId &tid);
+
+        /**
+         * Return the frames dirtied by tid and forget the transaction.
+         * @param tables set to the tables of every page dirtied by tid
+         */
+        std::vector<size_t> take(const TransactionId &tid, std::unordered_set<int> &tables);
+    };
+}
+
+#endif
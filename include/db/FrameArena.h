@@ -0,0 +1,55 @@
+#ifndef DB_FRAMEARENA_H
+#define DB_FRAMEARENA_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace db {
+    /**
+     * FrameArena is the memory backing the frames of the BufferPool. It is allocated once,
+     * when the pool is created, as one contiguous mapping of numFrames frames. Every frame
+     * starts on a 4 KiB boundary, so it can be the target of direct I/O.
+     * <p>
+     * The arena can be backed by huge pages to save TLB misses on large pools. If the system
+     * has no huge pages reserved, the arena falls back to regular pages and asks for
+     * transparent huge pages instead.
+     */
+    class FrameArena {
+        uint8_t *base;
+        size_t length;
+        size_t frameSize;
+        size_t numFrames;
+        bool hugePages = false;
+
+    public:
+        /** Alignment of every frame */
+        static constexpr size_t ALIGNMENT = 4096;
+
+        /**
+         * @param numFrames number of frames of the arena
+         * @param frameSize minimum size of a frame, rounded up to a multiple of ALIGNMENT
+         * @param useHugePages back the arena with huge pages if possible
+         */
+        FrameArena(size_t numFrames, size_t frameSize, bool useHugePages = false);
+
+        FrameArena(const FrameArena &) = delete;
+
+        ~FrameArena();
+
+        /**
+         * @return the first byte of frame i, in the range [0, numFrames)
+         */
+        uint8_t *getFrame(size_t i) const { return base + i * frameSize; }
+
+        size_t getFrameSize() const { return frameSize; }
+
+        size_t getNumFrames() const { return numFrames; }
+
+        /**
+         * @return true if the arena is backed by reserved huge pages
+         */
+        bool usesHugePages() const { return hugePages; }
+    };
+}
+
+#endif
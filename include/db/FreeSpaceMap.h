@@ -0,0 +1,74 @@
+#ifndef DB_FREESPACEMAP_H
+#define DB_FREESPACEMAP_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace db {
+    /**
+     * FreeSpaceMap records which pages of a HeapFile may have a free slot, one bit per page,
+     * so that an insert probes a single page instead of reading the table until it finds room.
+     * <p>
+     * The map is a hint: inserts check the page they are given and clear its bit if it turns
+     * out to be full, and a page whose bit is wrongly clear only loses its free slots until a
+     * delete sets it again. It is therefore neither logged nor synced. It is kept in a file
+     * next to the table along with the modification time of the table when it was saved; a
+     * table written since, e.g. by a crash before the map was saved, gets a map with every
+     * page marked free.
+     */
+    class FreeSpaceMap {
+        static constexpr char MAGIC[8] = {'D', 'B', 'F', 'S', 'M', '0', '0', '1'};
+
+        int fd;
+        /** The table, whose modification time validates the saved map */
+        int heapFd;
+        std::mutex latch;
+        /** Bit i is set if page i may have a free slot */
+        std::vector<uint64_t> words;
+        /** Number of pages the map covers */
+        int numPages;
+        /** No bit is set in the words before this one */
+        size_t firstWord = 0;
+        bool dirty = false;
+
+        static int64_t getModificationTime(int fd);
+
+        void setAll(int from, int to);
+
+    public:
+        /**
+         * Open or create the map stored at path for the table open as heapFd, which has
+         * numPages pages.
+         */
+        FreeSpaceMap(const std::string &path, int heapFd, int numPages);
+
+        FreeSpaceMap(const FreeSpaceMap &) = delete;
+
+        ~FreeSpaceMap();
+
+        /**
+         * @return the first page from pgNo on that may have a free slot, -1 if every such page is full
+         */
+        int find(int pgNo = 0);
+
+        /**
+         * Record whether page pgNo has a free slot. Pages past the end of the map are added.
+         */
+        void update(int pgNo, bool free);
+
+        /**
+         * Forget the pages from numPages on, which were removed from the table.
+         */
+        void truncate(int numPages);
+
+        /**
+         * Write the map if it changed since it was last saved, or always with force. The table
+         * must be written before, or the map is discarded when it is opened next.
+         */
+        void save(bool force = false);
+    };
+}
+
+#endif
@@ -5,28 +5,19 @@
 #include <db/Tuple.h>
 #include <db/Page.h>
 #include <db/PageId.h>
-#include <db/DbFile.h>
+#include <db/PagedFile.h>
 #include <db/HeapPage.h>
 #include <db/HeapPageId.h>
+#include <db/IoBackend.h>
+#include <atomic>
 
 namespace db {
-    class HeapFileIterator {
-        int numPages;
-        HeapPageId hpid;
-        bool end;
-        HeapPageIterator *it;
-        HeapPage *page;
+    using HeapFileIterator = PagedFileIterator<HeapPage>;
 
-    public:
-
-        HeapFileIterator(int tableid, int numPages, bool end = false);
-
-        bool operator!=(const HeapFileIterator &other) const;
-
-        Tuple &operator*() const;
-
-        HeapFileIterator &operator++();
-    };
+    /**
+     * The pages [pageLo, pageHi) of a HeapFile, as returned by HeapFile::scan.
+     */
+    using HeapFileRange = PagedFileRange<HeapPage>;
 
     /**
      * HeapFile is an implementation of a DbFile that stores a collection of tuples
@@ -38,52 +29,108 @@ namespace db {
      * @see db::HeapPage::HeapPage
      * @author Sam Madden
      */
-    class HeapFile : public DbFile {
-        int fd;
-        int tableid;
-        const TupleDesc &td;
-        int numPages;
-    public:
+    class HeapFile : public PagedFile {
+        /** Read-only mapping of the first mappedSize bytes of the file, with IoBackendType::MMAP */
+        uint8_t *mapping = nullptr;
+        size_t mappedSize = 0;
+        std::atomic<bool> sectorWrites{false};
 
         /**
-         * Constructs a heap file backed by the specified file.
-         *
-         * @param f the file that stores the on-disk backing store for this heap file.
+         * Write the sectors of page updated since it was last written.
          */
-        HeapFile(const char *fname, const TupleDesc &td);
+        void writeSectors(HeapPage *page);
 
         /**
-         * Returns an ID uniquely identifying this HeapFile. Implementation note:
-         * you will need to generate this tableid somewhere ensure that each
-         * HeapFile has a "unique id," and that you always return the same value for
-         * a particular HeapFile. We suggest hashing the absolute file name of the
-         * file underlying the heapfile, i.e. f.getAbsoluteFile().hashCode().
-         * @return an ID uniquely identifying this HeapFile.
+         * @return the mapped bytes of page pgNo, or nullptr if the page is not mapped, e.g. it
+         *         was appended after the file was opened
          */
-        int getId() const override;
+        uint8_t *getMappedPage(int pgNo) const;
+
+    protected:
+        Page *createPage(const HeapPageId &pid, uint8_t *frame) override;
+
+        void *createEmptyPageData() const override;
+
+        bool hasRoom(const Page *page, const Tuple &t) const override;
+
+        bool isFree(const Page *page) const override;
+
+        void insertInto(Page *page, Tuple &t) override;
+
+        void deleteFrom(Page *page, Tuple &t) override;
+
+    public:
 
         /**
-         * Returns the TupleDesc of the table stored in this DbFile.
-         * @return TupleDesc of this DbFile.
+         * Constructs a heap file backed by the specified file. Its free space map is kept in
+         * a file of the same name with a .fsm suffix.
+         *
+         * @param f the file that stores the on-disk backing store for this heap file.
+         * @param ioBackend how the pages are read and written. With IO_URING the file is opened
+         *                  with O_DIRECT when the file system supports it. With MMAP pages are
+         *                  parsed straight from a mapping of the file instead of being copied into
+         *                  a frame first, which suits read-mostly tables.
          */
-        const TupleDesc &getTupleDesc() const override;
+        HeapFile(const char *fname, const TupleDesc &td, IoBackendType ioBackend = IoBackendType::POSIX);
 
-        Page *readPage(const PageId &pid) override;
+        ~HeapFile() override;
 
-        std::vector<Page *> insertTuple(TransactionId tid, Tuple &t) override;
+        Page *readPage(const PageId &pid, uint8_t *frame) override;
 
-        std::vector<Page *> deleteTuple(TransactionId tid, Tuple &t) override;
+        void readPages(const std::vector<const PageId *> &pids, const std::vector<uint8_t *> &frames,
+                       const std::function<void(size_t, Page *)> &callback) override;
 
         /**
-         * Returns the number of pages in this HeapFile.
+         * Start a scan of the file. A mapped file is advised for sequential access.
          */
-        int getNumPages() const override;
-
         HeapFileIterator begin() const;
 
         HeapFileIterator end() const;
 
+        /**
+         * Start a scan of the pages [pageLo, pageHi), e.g. a morsel of a parallel scan. Pages
+         * past the end of the file are left out.
+         * @see db::MorselSplitter
+         */
+        HeapFileRange scan(int pageLo, int pageHi) const;
+
         void writePage(Page *p) override;
+
+        /**
+         * Write runs of consecutive pages with a single pwritev each, straight from the pages.
+         */
+        void writePages(const std::vector<Page *> &pages) override;
+
+        /**
+         * @param enable write only the 512-byte sectors of a page updated since it was last
+         *               written instead of the whole page, with one write per run of sectors.
+         *               Ignored if the backend requires a larger alignment, as with O_DIRECT.
+         */
+        void setSectorWrites(bool enable);
+
+        /**
+         * @return whether pages are parsed from a mapping of the file, with IoBackendType::MMAP
+         */
+        bool isMapped() const { return mapping != nullptr; }
+
+        /**
+         * Append count page images at the end of the file with a single write, bypassing the
+         * BufferPool; the appended pages are not logged. No transaction may update the file
+         * meanwhile.
+         * @see db::BulkLoader
+         */
+        void appendPages(const uint8_t *pages, int count);
+
+        /**
+         * Remove the pages [from, to) at the end of the file, and from the BufferPool. The caller
+         * holds exclusive locks on them and has checked that they are empty.
+         * @return false if the file no longer ends at to, e.g. a page was appended since, in
+         *         which case nothing is removed
+         * @throws std::runtime_error with IoBackendType::MMAP, whose mapping must not shrink
+         *         under its readers
+         * @see db::Vacuum
+         */
+        bool truncate(int from, int to);
     };
 }
 
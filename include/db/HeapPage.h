@@ -4,6 +4,11 @@
 #include <db/HeapPageId.h>
 #include <db/Tuple.h>
 #include <db/Page.h>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
 
 namespace db {
     class HeapPageIterator;
@@ -11,6 +16,16 @@ namespace db {
     /**
      * Each instance of HeapPage stores data for one page of HeapFiles and
      * implements the Page interface that is used by BufferPool.
+     * <p>
+     * The page image is authoritative: the header and the fields are read from it in place,
+     * and inserts and deletes write into it, so the image is also what is written to disk.
+     * Tuples are only decoded into Fields when the iterator reaches them; typed accessors
+     * read single fields without decoding anything.
+     * <p>
+     * Updates are tracked per 512-byte sector. The page keeps the bytes of the sectors updated
+     * since it was last logged, from which it rebuilds the before image of the write-ahead
+     * log, and the set of sectors updated since it was last written, so the file can write
+     * only those.
      *
      * @see HeapFile
      * @see BufferPool
@@ -21,14 +36,56 @@ namespace db {
 
         HeapPageId pid;
         TupleDesc td;
-        uint8_t *header;
-        Tuple *tuples;
+        /** The page as stored on disk, header first */
+        uint8_t *image;
+        /** Where updates go, image unless the page was read from a read-only mapping */
+        uint8_t *frame;
+        size_t pageSize;
         int numSlots;
+        /** Slots in use, kept up to date by markSlotUsed */
+        int numUsed;
+        size_t headerSize;
+        size_t tupleSize;
+        /** Offset of each field in a tuple */
+        std::vector<size_t> offsets;
+
+        /** Sector bytes before their first update since the page was last logged, empty if not updated */
+        std::vector<std::vector<uint8_t>> beforeSectors;
+        /** Sectors updated since the page was last written */
+        std::vector<bool> unwrittenSectors;
+
+        /** Serializes the decoding of tuples by concurrent readers, and the sector bookkeeping */
+        mutable std::mutex latch;
+        /** Tuple decoded from each slot, nullptr until the slot is first read */
+        mutable std::vector<std::unique_ptr<Tuple>> decoded;
+        /** Field i of each slot at slot * td.numFields() + i, nullptr until first read */
+        mutable std::vector<const Field *> decodedFields;
+        /** Tuples decoded from slots that were overwritten since, kept for their readers until reclaim */
+        std::vector<std::unique_ptr<Tuple>> retiredTuples;
+        /** Fields decoded from slots that were overwritten since, kept for their readers until reclaim */
+        std::vector<const Field *> retiredFields;
+        /** RecordId of each slot, nullptr until the slot is first read */
+        mutable std::vector<const RecordId *> recordIds;
+
+        /**
+         * Decode the tuple in slot, once.
+         */
+        const Tuple &getTuple(int slot) const;
+
+        /**
+         * Decode field i of the tuple in slot, once. Requires the latch.
+         */
+        const Field *decodeField(int slot, int i) const;
+
+        /**
+         * @return the RecordId of slot, created once. Requires the latch.
+         */
+        const RecordId *getRecordId(int slot) const;
 
         /**
-         * Suck up tuples from the source file.
+         * Record the update of len bytes at offset of the image, which is about to happen.
          */
-        void readTuple(Tuple *t, uint8_t *data, int slotId);
+        void beginUpdate(size_t offset, size_t len);
 
         /**
          * Abstraction to fill or clear a slot on this page.
@@ -51,8 +108,15 @@ namespace db {
          * @see Database#getCatalog
          * @see Catalog#getTupleDesc
          * @see BufferPool#getPageSize()
+         *
+         * @param data the image, updated in place unless frame is set
+         * @param frame if data is read-only, buffer the image is copied to on the first update
          */
-        HeapPage(const HeapPageId &id, uint8_t *data);
+        HeapPage(const HeapPageId &id, uint8_t *data, uint8_t *frame = nullptr);
+
+        HeapPage(const HeapPage &) = delete;
+
+        ~HeapPage() override;
 
 
         /** Retrieve the number of tuples on this page.
@@ -84,6 +148,32 @@ namespace db {
          */
         void *getPageData() const override;
 
+        const uint8_t *getImage() const override { return image; }
+
+        bool takeBeforeImage(uint8_t *before) override;
+
+        void reclaim() override;
+
+        /**
+         * @return the number of tuples and fields kept for the readers of overwritten slots
+         */
+        size_t getNumRetired() const;
+
+        /** Updates are tracked with this granularity */
+        static constexpr size_t SECTOR_SIZE = 512;
+
+        /**
+         * Return the sectors updated since the last call and forget them; the page is about to be
+         * written. Requires the update latch of the page, which keeps updates out until the write
+         * completed. The bytes kept for the before image stay until takeBeforeImage.
+         */
+        std::vector<bool> takeUnwrittenSectors();
+
+        /**
+         * Mark sectors returned by takeUnwrittenSectors as updated again, their write failed.
+         */
+        void restoreUnwrittenSectors(const std::vector<bool> &sectors);
+
         /**
          * Static method to generate a byte array corresponding to an empty
          * HeapPage.
@@ -128,6 +218,41 @@ namespace db {
          */
         void insertTuple(Tuple *t);
 
+        /**
+         * Decode some fields of the tuple in slot, e.g. the columns a scan projects. Fields are
+         * decoded on their first read only, and shared with every later read of the slot; they
+         * belong to the page, like the RecordId of the tuple.
+         * @param columns the fields to decode, in the order of the fields of td
+         * @param td the schema of the result, with one field per column
+         */
+        Tuple projectTuple(int slot, const std::vector<int> &columns, const TupleDesc &td) const;
+
+        /**
+         * @return the bytes of the tuple in slot, fields at the offsets of getFieldOffset
+         */
+        const uint8_t *getTupleData(int slot) const {
+            return image + headerSize + slot * tupleSize;
+        }
+
+        /**
+         * @return the offset of field i in the bytes of a tuple
+         */
+        size_t getFieldOffset(int i) const { return offsets[i]; }
+
+        /**
+         * @return field i, an INT_TYPE field, of the tuple in slot, read without decoding the tuple
+         */
+        int getInt(int slot, int i) const {
+            int value;
+            memcpy(&value, getTupleData(slot) + offsets[i], sizeof(value));
+            return value;
+        }
+
+        /**
+         * @return field i, a STRING_TYPE field, of the tuple in slot. The view points into the
+         *         page and is valid as long as the page is.
+         */
+        std::string_view getString(int slot, int i) const;
     };
 
     /**
@@ -145,6 +270,11 @@ namespace db {
         Tuple &operator*() const;
 
         HeapPageIterator &operator++();
+
+        /**
+         * @return the slot of the current tuple, for the typed accessors of the page
+         */
+        int getSlot() const { return slot; }
     };
 }
 
@@ -0,0 +1,154 @@
+#ifndef DB_IOBACKEND_H
+#define DB_IOBACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <vector>
+
+namespace db {
+    /**
+     * POSIX: pread/pwrite. IO_URING: batched reads with O_DIRECT, see UringIoBackend.
+     * MMAP: a HeapFile serves reads from a shared read-only mapping of the file, writes use
+     * pwrite like POSIX.
+     */
+    enum class IoBackendType {
+        POSIX, IO_URING, MMAP
+    };
+
+    /**
+     * A read of len bytes at offset into buf, submitted as part of a batch.
+     */
+    struct IoRequest {
+        void *buf;
+        size_t len;
+        off_t offset;
+        /** Called with the number of bytes read, or -errno */
+        std::function<void(ssize_t)> callback;
+    };
+
+    /**
+     * IoBackend performs the disk I/O of a DbFile. Besides single reads and writes, it can
+     * read a batch of pages at once: the backend keeps as many reads in flight as it can and
+     * calls the callback of each request as soon as it completes, on the calling thread.
+     * <p>
+     * Backends are thread-safe.
+     */
+    class IoBackend {
+    public:
+        virtual ~IoBackend() = default;
+
+        /**
+         * @return flags the file has to be opened with, e.g. O_DIRECT
+         */
+        virtual int getOpenFlags() const { return 0; }
+
+        /**
+         * @return the multiple the offsets and lengths of writes must be aligned on
+         */
+        virtual size_t getAlignment() const { return 1; }
+
+        /**
+         * Read len bytes at offset into buf.
+         * @return the number of bytes read, or -1 with errno set
+         */
+        virtual ssize_t read(int fd, void *buf, size_t len, off_t offset) = 0;
+
+        /**
+         * Write len bytes of buf at offset.
+         * @return the number of bytes written, or -1 with errno set, EINVAL if len or offset
+         *         is not aligned on getAlignment()
+         */
+        virtual ssize_t write(int fd, const void *buf, size_t len, off_t offset) = 0;
+
+        /**
+         * Write the iovcnt buffers of iov one after the other, starting at offset.
+         * @return the number of bytes written, or -1 with errno set
+         */
+        virtual ssize_t writev(int fd, const iovec *iov, int iovcnt, off_t offset) = 0;
+
+        /**
+         * Perform all the reads of requests, returning once every callback was called.
+         */
+        virtual void readBatch(int fd, std::vector<IoRequest> &requests) = 0;
+
+        /**
+         * Create a backend of the given type. If io_uring is not available, a POSIX backend
+         * is returned instead.
+         */
+        static std::unique_ptr<IoBackend> create(IoBackendType type);
+    };
+
+    /**
+     * Blocking pread/pwrite through the page cache. Batches are read one request at a time.
+     */
+    class PosixIoBackend : public IoBackend {
+    public:
+        ssize_t read(int fd, void *buf, size_t len, off_t offset) override;
+
+        ssize_t write(int fd, const void *buf, size_t len, off_t offset) override;
+
+        ssize_t writev(int fd, const iovec *iov, int iovcnt, off_t offset) override;
+
+        void readBatch(int fd, std::vector<IoRequest> &requests) override;
+    };
+
+    /**
+     * io_uring with O_DIRECT: reads bypass the page cache, the BufferPool being the only
+     * cache of the pages, and a batch keeps up to QUEUE_DEPTH reads in flight with a single
+     * system call per submission.
+     * <p>
+     * Direct I/O requires buffers, offsets and lengths aligned on ALIGNMENT. Frames of the
+     * BufferPool are, other buffers are copied through an aligned bounce buffer. Reads of an
+     * unaligned length read the whole aligned block, writes of one are rejected: padding them
+     * would overwrite the bytes that follow.
+     */
+    class UringIoBackend : public IoBackend {
+        struct Ring;
+
+        std::mutex latch;
+        /** Null if it could not be set up again after a failed submission, reads then use pread */
+        std::unique_ptr<Ring> ring;
+
+        /**
+         * Submit the requests in [first, last) and reap their completions. If the submission
+         * fails, the reads the kernel took are waited for and the ring is set up again, so
+         * that the entries it did not take are never submitted.
+         */
+        void submit(std::vector<IoRequest> &requests, size_t first, size_t last, int fd);
+
+        /**
+         * Wait for inflight completions and drop them, without calling their callbacks.
+         */
+        void drain(size_t inflight);
+
+    public:
+        static constexpr unsigned QUEUE_DEPTH = 64;
+        static constexpr size_t ALIGNMENT = 4096;
+
+        /**
+         * @throws std::runtime_error if io_uring is not supported by the kernel
+         */
+        UringIoBackend();
+
+        ~UringIoBackend() override;
+
+        int getOpenFlags() const override;
+
+        size_t getAlignment() const override { return ALIGNMENT; }
+
+        ssize_t read(int fd, void *buf, size_t len, off_t offset) override;
+
+        ssize_t write(int fd, const void *buf, size_t len, off_t offset) override;
+
+        ssize_t writev(int fd, const iovec *iov, int iovcnt, off_t offset) override;
+
+        void readBatch(int fd, std::vector<IoRequest> &requests) override;
+    };
+}
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef DB_LOCKMANAGER_H
+#define DB_LOCKMANAGER_H
+
+#include <db/PageId.h>
+#include <db/TransactionId.h>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace db {
+    /**
+     * Thrown when a transaction has to be aborted, e.g. because waiting for a lock would
+     * deadlock. The transaction holds all its locks until it is completed.
+     */
+    class TransactionAbortedException : public std::runtime_error {
+    public:
+        explicit TransactionAbortedException(const std::string &what) : std::runtime_error(what) {}
+    };
+
+    enum class LockMode {
+        SHARED, EXCLUSIVE
+    };
+
+    /**
+     * LockManager grants page-level shared and exclusive locks to transactions, implementing
+     * strict two-phase locking together with the BufferPool: locks are acquired when pages are
+     * fetched and only released when the transaction completes.
+     * <p>
+     * Requests are served in FIFO order, except lock upgrades which go first. A transaction
+     * that cannot be granted a lock sleeps on the condition variable of the page and is woken
+     * as soon as the lock is released. Before sleeping, it records which transactions it waits
+     * for in a wait-for graph. If this closes a cycle, the requesting transaction is aborted
+     * with a TransactionAbortedException.
+     * <p>
+     * The lock table is split into shards, each with its own mutex, so transactions locking
+     * different pages rarely contend.
+     */
+    class LockManager {
+        static constexpr size_t NUM_SHARDS = 16;
+
+        /** Locks are held on physical pages: (table id, page number) */
+        struct Key {
+            int tableId;
+            int pgNo;
+
+            bool operator==(const Key &other) const { return tableId == other.tableId && pgNo == other.pgNo; }
+        };
+
+        struct KeyHash {
+            size_t operator()(const Key &key) const {
+                return std::hash<int>()(key.tableId) ^ std::hash<int>()(key.pgNo) * 31;
+            }
+        };
+
+        struct LockQueue {
+            std::unordered_map<int, LockMode> granted;
+            std::list<std::pair<int, LockMode>> waiting;
+            /** Transaction waiting to upgrade its shared lock, -1 if none */
+            int upgrading = -1;
+            std::condition_variable cv;
+        };
+
+        struct Shard {
+            std::mutex latch;
+            std::unordered_map<Key, LockQueue, KeyHash> queues;
+        };
+
+        struct HeldShard {
+            std::mutex latch;
+            std::unordered_map<int, std::unordered_set<Key, KeyHash>> held;
+        };
+
+        Shard shards[NUM_SHARDS];
+        /** Locks held by each transaction, sharded by transaction id */
+        HeldShard heldShards[NUM_SHARDS];
+
+        std::mutex graphLatch;
+        /** Wait-for graph: transactions each blocked transaction is waiting for */
+        std::unordered_map<int, std::vector<int>> waitsFor;
+
+        Shard &getShard(const Key &key);
+
+        HeldShard &getHeldShard(int tid);
+
+        static bool canGrant(const LockQueue &queue, int tid, LockMode mode, bool upgrade);
+
+        static std::vector<int> getBlockers(const LockQueue &queue, int tid, LockMode mode, bool upgrade);
+
+        /**
+         * Record that tid waits for blockers.
+         * @return false if this closes a cycle in the wait-for graph
+         */
+        bool waitFor(int tid, std::vector<int> blockers);
+
+        void stopWaiting(int tid);
+
+        void release(int tid, const Key &key);
+
+    public:
+        /**
+         * Acquire a lock on pid for tid, blocking until it is granted. A transaction holding a
+         * shared lock that asks for an exclusive one is upgraded.
+         * @throws TransactionAbortedException if waiting would deadlock
+         */
+        void acquire(const TransactionId &tid, const PageId &pid, LockMode mode);
+
+        /**
+         * Acquire a lock on pid for tid if it can be granted without waiting, like acquire.
+         * @return false if another transaction holds or waits for a conflicting lock
+         */
+        bool tryAcquire(const TransactionId &tid, const PageId &pid, LockMode mode);
+
+        /**
+         * Release the lock tid holds on pid, if any.
+         */
+        void release(const TransactionId &tid, const PageId &pid);
+
+        /**
+         * Release all the locks held by tid.
+         */
+        void releaseAll(const TransactionId &tid);
+
+        /**
+         * @return true if tid holds a lock on pid
+         */
+        bool holdsLock(const TransactionId &tid, const PageId &pid);
+    };
+}
+
+#endif
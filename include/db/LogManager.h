@@ -0,0 +1,238 @@
+#ifndef DB_LOGMANAGER_H
+#define DB_LOGMANAGER_H
+
+#include <db/BufferPoolStats.h>
+#include <db/Page.h>
+#include <db/PageId.h>
+#include <db/TransactionId.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace db {
+    enum class LogRecordType : uint8_t {
+        UPDATE, CLR, COMMIT, ABORT, END, CHECKPOINT
+    };
+
+    /**
+     * A record of the log, as read back by recovery and rollback.
+     */
+    struct LogRecord {
+        LogRecordType type;
+        /** Offset of the record in the log */
+        uint64_t lsn;
+        int tid;
+        /** Previous record of the same transaction, 0 for its first record */
+        uint64_t prevLsn;
+        /** UPDATE and CLR: the page the images belong to */
+        int tableId;
+        int pageNo;
+        PageCategory category;
+        /** UPDATE: the page before the update, CLR: unused */
+        std::vector<uint8_t> before;
+        /** UPDATE: the page after the update, CLR: the page restored by the undo */
+        std::vector<uint8_t> after;
+        /** CLR: next record of the transaction to undo */
+        uint64_t undoNextLsn;
+        /** CHECKPOINT: every update logged before this LSN is on disk */
+        uint64_t redoLsn;
+        /** CHECKPOINT: (table, page number) of the pages the checkpoint wrote */
+        std::vector<std::pair<int, int>> pages;
+        /** CHECKPOINT: (transaction, last record) of the transactions running at the checkpoint */
+        std::vector<std::pair<int, uint64_t>> running;
+
+        /**
+         * @return the id of the page of an UPDATE or CLR record
+         */
+        std::unique_ptr<PageId> getPageId() const;
+    };
+
+    struct LogStats {
+        /** Transactions committed */
+        long commits;
+        /** fdatasync calls on the log */
+        long syncs;
+        /** Records before this LSN are not needed by recovery anymore, their space was given back */
+        uint64_t recycledLsn;
+    };
+
+    /**
+     * LogManager is the write-ahead log of the database. Updates are logged as full before
+     * and after images of the pages, which makes redo and undo idempotent.
+     * <p>
+     * Records are appended to an in-memory tail and written sequentially. Commit forces the
+     * tail with a single fdatasync, and before a dirty page is written the BufferPool forces
+     * the log up to the LSN of the page. Pages can therefore be written at any time (steal)
+     * and need not be written at commit (no-force).
+     * <p>
+     * Commits are grouped: one committer writes and syncs the tail for all the commit records
+     * appended so far, while the others wait for it. Records appended during a sync go with
+     * the next one. The leader of a group may also wait up to a configurable delay for more
+     * committers to join, trading latency for fewer syncs.
+     * <p>
+     * The LSN of a record is its offset in the log. Page formats have no room for it, so the
+     * LSN of a page is only kept in memory; recovery redoes every update in the log instead
+     * of comparing LSNs.
+     * <p>
+     * Recovery follows ARIES: analysis rebuilds the table of the transactions that were
+     * running, redo repeats history by writing the last image of every page, and undo rolls
+     * the losers back, logging compensation records so an interrupted recovery never undoes
+     * twice. Once the files are synced the log is truncated.
+     * <p>
+     * A checkpoint record marks a point before which every logged update is on disk, and
+     * lists the transactions running at the checkpoint. Once it is durable its LSN is written
+     * after the magic, recovery starts from there, and the space of the records that neither
+     * redo nor the undo of those transactions needs is given back to the file system.
+     */
+    class LogManager {
+        /** Written at the start of the log, record offsets start after it */
+        static constexpr char MAGIC[8] = {'D', 'B', 'L', 'O', 'G', '0', '0', '2'};
+        /** Records start after the magic and the LSN of the last durable checkpoint, 0 if none */
+        static constexpr uint64_t FIRST_LSN = sizeof(MAGIC) + sizeof(uint64_t);
+
+        int fd;
+        std::mutex latch;
+        /** Records not written to the file yet, starting at tailLsn */
+        std::vector<uint8_t> tail;
+        uint64_t tailLsn;
+        /** Records being written by the leader of a group, starting at writingLsn */
+        std::vector<uint8_t> writing;
+        uint64_t writingLsn = 0;
+        /** Records before this offset are durable */
+        uint64_t durableLsn;
+        /** Set while a leader writes and syncs the log */
+        bool syncing = false;
+        /** Notified when durableLsn moves, and when a committer joins the next group */
+        std::condition_variable synced;
+        std::condition_variable joined;
+        /** Commit records appended since the last group was taken */
+        size_t pendingCommits = 0;
+        std::chrono::microseconds maxWait{DEFAULT_MAX_WAIT_US};
+        size_t maxBatch = DEFAULT_MAX_BATCH;
+        long commits = 0;
+        long syncs = 0;
+        /** Last record of each running transaction */
+        std::unordered_map<int, uint64_t> lastLsn;
+        /** First record of each running transaction, the log from there on is kept for its undo */
+        std::unordered_map<int, uint64_t> firstLsn;
+        /** Serializes the checkpoints, which write their LSN after the magic */
+        std::mutex checkpointLatch;
+        /** Records before this offset were given back to the file system */
+        uint64_t recycledLsn = FIRST_LSN;
+
+        uint64_t append(LogRecordType type, int tid, const std::vector<uint8_t> &body);
+
+        uint64_t appendPageRecord(LogRecordType type, int tid, const PageId &pid, const uint8_t *first,
+                                  const uint8_t *second, size_t imageSize, uint64_t undoNextLsn);
+
+        /**
+         * Read the record at lsn. Requires the latch.
+         * @return false if there is no valid record at lsn, e.g. a torn write at the end
+         */
+        bool readRecord(uint64_t lsn, LogRecord &record, uint64_t &nextLsn);
+
+        /**
+         * Make the records before end durable, writing and syncing the tail unless another
+         * thread already does. Requires the latch, which is released during the write.
+         * @param commit the caller is a committer, it may wait for others to join its group
+         */
+        void force(std::unique_lock<std::mutex> &lock, uint64_t end, bool commit = false);
+
+        /**
+         * Write the LSN of the last durable checkpoint after the magic, and sync it.
+         */
+        void writeCheckpointLsn(uint64_t lsn);
+
+        /**
+         * Give the space of the records before lsn back to the file system. The file keeps its
+         * size and offsets, the records read as zeros.
+         */
+        void recycle(uint64_t lsn);
+
+        /**
+         * Undo the records of tid from lsn on, logging CLRs and writing the restored images
+         * to the files. Requires the latch.
+         * @return the pages that were restored
+         */
+        std::vector<std::unique_ptr<PageId>> undo(std::unique_lock<std::mutex> &lock, int tid, uint64_t lsn);
+
+    public:
+        /** Default delay a group leader waits for more committers, 0 syncs right away */
+        static constexpr int DEFAULT_MAX_WAIT_US = 0;
+
+        /** Default number of commits after which a group is synced without waiting further */
+        static constexpr size_t DEFAULT_MAX_BATCH = 64;
+
+        /**
+         * Open or create the log at path. Call recover() before logging anything.
+         */
+        explicit LogManager(const std::string &path);
+
+        LogManager(const LogManager &) = delete;
+
+        /**
+         * Write the tail and close the log.
+         */
+        ~LogManager();
+
+        /**
+         * Log the update of page by tid from before to after, each imageSize bytes.
+         * @return the LSN of the record
+         */
+        uint64_t logUpdate(const TransactionId &tid, const PageId &pid, const uint8_t *before, const uint8_t *after,
+                           size_t imageSize);
+
+        /**
+         * Log the commit of tid and force the log. Returns once the commit is durable, which
+         * may be through the sync of another committer.
+         */
+        void commit(const TransactionId &tid);
+
+        /**
+         * @param maxWait how long the leader of a group waits for more committers
+         * @param maxBatch number of commits that closes a group before maxWait elapses
+         */
+        void setGroupCommit(std::chrono::microseconds maxWait, size_t maxBatch);
+
+        LogStats getStats();
+
+        /**
+         * Roll tid back: every update it logged is undone, on disk, in reverse order.
+         * @return the pages whose images were restored on disk
+         */
+        std::vector<std::unique_ptr<PageId>> abort(const TransactionId &tid);
+
+        /**
+         * Force the log up to and including the record at lsn.
+         */
+        void flush(uint64_t lsn);
+
+        /**
+         * Log and force a checkpoint record, then recycle the records recovery does not need
+         * anymore. The caller guarantees that every update logged before redoLsn is on disk,
+         * synced.
+         * @param pages (table, page number) of the pages written to reach that state
+         * @return the LSN of the record
+         */
+        uint64_t checkpoint(uint64_t redoLsn, const std::vector<std::pair<int, int>> &pages);
+
+        /**
+         * @return the offset the next record will be written at
+         */
+        uint64_t getNextLsn();
+
+        /**
+         * Bring the files of the Catalog back to the state of the committed transactions.
+         * The pages involved must not be resident in the BufferPool.
+         */
+        void recover();
+    };
+}
+
+#endif
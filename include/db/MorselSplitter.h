@@ -0,0 +1,49 @@
+#ifndef DB_MORSELSPLITTER_H
+#define DB_MORSELSPLITTER_H
+
+#include <atomic>
+#include <optional>
+
+namespace db {
+    /**
+     * The pages [pageLo, pageHi) of a file.
+     */
+    struct Morsel {
+        int pageLo;
+        int pageHi;
+    };
+
+    /**
+     * MorselSplitter hands out the pages of a file as morsels of consecutive pages, for scans
+     * that share a file between workers. Each worker takes the next morsel once it is done
+     * with its own, so faster workers take more of them and no worker idles while morsels
+     * are left. Taking a morsel is a single atomic increment.
+     *
+     * @see db::HeapFile::scan
+     */
+    class MorselSplitter {
+        int numPages;
+        int morselPages;
+        std::atomic<int> nextPage{0};
+
+    public:
+        /** Default morsel size, large enough for read-ahead to reach its full window */
+        static constexpr int DEFAULT_MORSEL_PAGES = 64;
+
+        /**
+         * @param numPages the pages [0, numPages) are handed out
+         * @param morselPages pages per morsel, the last one may be shorter
+         */
+        explicit MorselSplitter(int numPages, int morselPages = DEFAULT_MORSEL_PAGES);
+
+        MorselSplitter(const MorselSplitter &) = delete;
+
+        /**
+         * Take the next morsel, from any thread.
+         * @return the morsel, empty once every page was handed out
+         */
+        std::optional<Morsel> next();
+    };
+}
+
+#endif
@@ -3,9 +3,15 @@
 
 #include <db/PageId.h>
 #include <db/TransactionId.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <optional>
 
 namespace db {
+    class DirtyPageIndex;
+
     /**
      * Page is the interface used to represent pages that are resident in the
      * BufferPool.  Typically, DbFiles will read and write pages from disk.
@@ -16,6 +22,19 @@ namespace db {
     class Page {
     protected:
         std::optional<TransactionId> dirty = std::nullopt;
+        /** LSN of the last log record of this page, 0 if it was not logged since it was read */
+        uint64_t lsn = 0;
+    private:
+        friend class BufferPool;
+        /** Set in pinState once the page left the BufferPool, its last pin then deletes it */
+        static constexpr uint32_t REMOVED = 1u << 31;
+        /** Index of the BufferPool holding the page, told which transaction dirties its frame */
+        DirtyPageIndex *dirtyIndex = nullptr;
+        /** Frame of the page in the BufferPool, across all its shards */
+        size_t frame = 0;
+        /** Number of pins of the page, and REMOVED. A pinned page is neither evicted nor deleted */
+        std::atomic<uint32_t> pinState{0};
+        std::mutex updateLatch;
     public:
         /**
          * Return the id of this page.  The id is a unique identifier for a page
@@ -38,9 +57,22 @@ namespace db {
         /**
          * Set the dirty state of this page as dirtied by a particular transaction
          */
-        virtual void markDirty(std::optional<TransactionId> tid) final {
-            dirty = tid;
-        }
+        virtual void markDirty(std::optional<TransactionId> tid) final;
+
+        /**
+         * Return the latch ordering the updates of this page with its logging and writing. Files
+         * hold it from the update of a resident page until the page is marked dirty, and the
+         * BufferPool from the log record of a page until its write, so the page written is the
+         * page logged. Holders must not call into the BufferPool.
+         */
+        std::mutex &getUpdateLatch() { return updateLatch; }
+
+        /**
+         * @return the LSN of the last log record describing this page
+         */
+        uint64_t getLsn() const { return lsn; }
+
+        void setLsn(uint64_t newLsn) { lsn = newLsn; }
         /**
          * Generates a byte array representing the contents of this page.
          * Used to serialize this page to disk.
@@ -53,6 +85,27 @@ namespace db {
          */
         virtual void *getPageData() const = 0;
 
+        /**
+         * @return the image of a page that is updated in place, which is also the data to
+         *         write to disk, or nullptr if getPageData builds the data. The BufferPool keeps
+         *         the before image of the write-ahead log in the frame of the latter pages.
+         */
+        virtual const uint8_t *getImage() const { return nullptr; }
+
+        /**
+         * Pages updated in place: write into before the image as of the last call, or as read,
+         * and start tracking updates from the current image.
+         * @return false if the page was not updated since
+         */
+        virtual bool takeBeforeImage([[maybe_unused]] uint8_t *before) { return false; }
+
+        /**
+         * Free what the page keeps for readers that may still use it, e.g. the tuples decoded
+         * from slots overwritten since. Called by the BufferPool as the last pin of the page is
+         * released: like an evicted page, an unpinned page is no longer read by anyone.
+         */
+        virtual void reclaim() {}
+
         virtual ~Page() = default;
     };
 }
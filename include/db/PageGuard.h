@@ -0,0 +1,58 @@
+#ifndef DB_PAGEGUARD_H
+#define DB_PAGEGUARD_H
+
+#include <db/Page.h>
+
+namespace db {
+    class BufferPool;
+
+    /**
+     * PageGuard keeps a page pinned in the BufferPool for as long as it lives, so that the
+     * page cannot be evicted while it is being used. Copying a guard pins the page once more,
+     * destroying or releasing a guard unpins it.
+     *
+     * @see BufferPool#fetchPage
+     */
+    class PageGuard {
+        BufferPool *bufferPool = nullptr;
+        Page *page = nullptr;
+
+    public:
+        PageGuard() = default;
+
+        /**
+         * Take over a pin of page, as acquired with BufferPool::pinPage.
+         */
+        PageGuard(BufferPool &bufferPool, Page *page) : bufferPool(&bufferPool), page(page) {}
+
+        PageGuard(const PageGuard &other);
+
+        PageGuard(PageGuard &&other) noexcept;
+
+        PageGuard &operator=(PageGuard other) noexcept;
+
+        ~PageGuard();
+
+        /**
+         * Unpin the page now, the guard becomes empty. Never throws: a guard only releases the
+         * pin it took, so an unbalanced pin is a bug of a raw unpinPage caller.
+         */
+        void release() noexcept;
+
+        Page *get() const { return page; }
+
+        Page *operator->() const { return page; }
+
+        Page &operator*() const { return *page; }
+
+        explicit operator bool() const { return page != nullptr; }
+
+        /**
+         * @return the page as a T, nullptr if it is not one
+         */
+        template<typename T>
+        T *as() const { return dynamic_cast<T *>(page); }
+    };
+}
+
+#endif
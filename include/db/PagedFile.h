@@ -0,0 +1,184 @@
+#ifndef DB_PAGEDFILE_H
+#define DB_PAGEDFILE_H
+
+#include <db/DbFile.h>
+#include <db/FreeSpaceMap.h>
+#include <db/HeapPageId.h>
+#include <db/IoBackend.h>
+#include <db/PageGuard.h>
+#include <db/Prefetcher.h>
+#include <db/TupleDesc.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace db {
+    /**
+     * Iterates over the tuples of the pages [pageLo, pageHi) of a PagedFile whose pages are Ps,
+     * keeping the current page pinned. P iterates over its used slots with begin() and end().
+     * It is instantiated for HeapPage, SlottedPage and PaxPage.
+     */
+    template<typename P>
+    class PagedFileIterator {
+        using PageIterator = decltype(std::declval<const P &>().begin());
+
+        /** Page after the last one of the scan */
+        int pageHi;
+        HeapPageId hpid;
+        /** Keeps the current page resident while its tuples are returned */
+        PageGuard guard;
+        P *page = nullptr;
+        /** Position in page, empty at the end of the scan */
+        std::optional<PageIterator> it;
+        ReadAhead readAhead;
+
+        /**
+         * Move to the first tuple from the current position on, across pages.
+         */
+        void seek();
+
+    public:
+        using reference = decltype(*std::declval<const PageIterator &>());
+
+        /**
+         * Iterate over the tuples of the pages [pageLo, pageHi) of a file.
+         * @param end build the iterator past the last tuple instead
+         */
+        PagedFileIterator(int tableid, int pageLo, int pageHi, bool end = false);
+
+        bool operator!=(const PagedFileIterator &other) const;
+
+        reference operator*() const;
+
+        PagedFileIterator &operator++();
+
+        /**
+         * @return the page of the current tuple, pinned by the iterator
+         */
+        const P *getPage() const { return page; }
+
+        /**
+         * @return the slot of the current tuple in its page
+         */
+        int getSlot() const { return it->getSlot(); }
+    };
+
+    /**
+     * The pages [pageLo, pageHi) of a PagedFile. Iterators are plain values: a scan allocates
+     * nothing beyond the pages it reads.
+     */
+    template<typename P>
+    class PagedFileRange {
+        int tableid;
+        int pageLo;
+        int pageHi;
+
+    public:
+        PagedFileRange(int tableid, int pageLo, int pageHi) : tableid(tableid), pageLo(pageLo), pageHi(pageHi) {}
+
+        PagedFileIterator<P> begin() const { return {tableid, pageLo, pageHi}; }
+
+        PagedFileIterator<P> end() const { return {tableid, pageLo, pageHi, true}; }
+    };
+
+    /**
+     * PagedFile is what the DbFiles of HeapPageId-addressed pages have in common: a file of
+     * BufferPool::getPageSize() pages read and written through an IoBackend, grown one empty
+     * page at a time, and a FreeSpaceMap of the pages that may take another tuple, kept next
+     * to the file with a .fsm suffix. Subclasses provide the page format.
+     *
+     * @see db::HeapFile
+     * @see db::SlottedFile
+     * @see db::PaxFile
+     */
+    class PagedFile : public DbFile {
+        /**
+         * Lock the page pgNo for writing if no other transaction holds or waits for its lock: an
+         * insert moves on to another page rather than waiting, or upgrading a shared lock that
+         * concurrent inserts may hold as well.
+         * @param full set to whether the page was checked and t does not fit in it
+         * @return the page pinned for writing if t fits in it, an empty guard otherwise, in which
+         *         case the page is not kept locked if it was only locked for the check
+         */
+        PageGuard getPageWithRoom(TransactionId tid, int pgNo, const Tuple &t, bool &full);
+
+    protected:
+        int fd;
+        int tableid;
+        const TupleDesc &td;
+        /** Read without the latch by inserts and scans */
+        std::atomic<int> numPages;
+        /** Serializes the changes of numPages */
+        std::mutex sizeLatch;
+        std::unique_ptr<IoBackend> io;
+        /** Pages that may take another tuple, saved next to the file */
+        std::unique_ptr<FreeSpaceMap> freeSpace;
+        /** Whether inserts also try the last page when the free space map has none */
+        bool fillLastPage = false;
+
+        /**
+         * @param fname the file of the pages. With a backend that asks for O_DIRECT, the file is
+         *              opened without it if the file system does not support direct I/O.
+         */
+        PagedFile(const char *fname, const TupleDesc &td, IoBackendType ioBackend);
+
+        /**
+         * Check a read of a page, zeroing the end of a page that was read past the end of the file.
+         */
+        static void checkRead(ssize_t n, uint8_t *frame, size_t pageSize);
+
+        /**
+         * @return the page pid read into frame
+         */
+        virtual Page *createPage(const HeapPageId &pid, uint8_t *frame) = 0;
+
+        /**
+         * @return the image of an empty page, allocated with new[]
+         */
+        virtual void *createEmptyPageData() const = 0;
+
+        /**
+         * @return whether t can be inserted into page
+         */
+        virtual bool hasRoom(const Page *page, const Tuple &t) const = 0;
+
+        /**
+         * @return whether page is kept in the free space map
+         */
+        virtual bool isFree(const Page *page) const = 0;
+
+        virtual void insertInto(Page *page, Tuple &t) = 0;
+
+        virtual void deleteFrom(Page *page, Tuple &t) = 0;
+
+    public:
+        PagedFile(const PagedFile &) = delete;
+
+        ~PagedFile() override;
+
+        int getId() const override;
+
+        const TupleDesc &getTupleDesc() const override;
+
+        Page *readPage(const PageId &pid, uint8_t *frame) override;
+
+        void writePage(Page *p) override;
+
+        void writePageData(const PageId &pid, const void *data) override;
+
+        /**
+         * Sync the file, then save its free space map.
+         */
+        void sync() override;
+
+        std::vector<PageGuard> insertTuple(TransactionId tid, Tuple &t) override;
+
+        std::vector<PageGuard> deleteTuple(TransactionId tid, Tuple &t) override;
+
+        int getNumPages() const override;
+    };
+}
+
+#endif
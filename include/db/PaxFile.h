@@ -0,0 +1,77 @@
+#ifndef DB_PAXFILE_H
+#define DB_PAXFILE_H
+
+#include <db/PagedFile.h>
+#include <db/PaxPage.h>
+#include <db/StringDictionary.h>
+#include <memory>
+
+namespace db {
+    enum class StringEncoding {
+        /** STRING_LEN bytes per value, as in a HeapFile */
+        INLINE,
+        /** A 4-byte code per value, see StringDictionary */
+        DICTIONARY
+    };
+
+    using PaxFileIterator = PagedFileIterator<PaxPage>;
+
+    using PaxFileRange = PagedFileRange<PaxPage>;
+
+    /**
+     * PaxFile is a DbFile of PaxPages, a column-grouped alternative to HeapFile for tables
+     * that are mostly scanned a few fields at a time. Pages and records are addressed like
+     * those of a HeapFile, with HeapPageIds and slot numbers, and the pages with an empty
+     * slot are kept in a FreeSpaceMap next to the file.
+     * <p>
+     * Operators that only need some int fields can read the minipages of each page directly,
+     * see PaxPage::getIntColumn. With StringEncoding::DICTIONARY, the strings of the file
+     * are stored as codes of a StringDictionary kept next to the file, which suits strings of
+     * few distinct values; filters translate their constant with getDictionary()->find and
+     * compare PaxPage::getCodeColumn.
+     *
+     * @see db::PaxPage
+     */
+    class PaxFile : public PagedFile {
+        /** nullptr with StringEncoding::INLINE */
+        std::unique_ptr<StringDictionary> dictionary;
+
+    protected:
+        Page *createPage(const HeapPageId &pid, uint8_t *frame) override;
+
+        void *createEmptyPageData() const override;
+
+        bool hasRoom(const Page *page, const Tuple &t) const override;
+
+        bool isFree(const Page *page) const override;
+
+        void insertInto(Page *page, Tuple &t) override;
+
+        void deleteFrom(Page *page, Tuple &t) override;
+
+    public:
+        /**
+         * @param fname the file of the pages, its free space map is kept in fname.fsm and its
+         *              dictionary in fname.dict
+         * @param encoding how strings are stored, the same every time the file is opened
+         */
+        PaxFile(const char *fname, const TupleDesc &td, StringEncoding encoding = StringEncoding::INLINE,
+                IoBackendType ioBackend = IoBackendType::POSIX);
+
+        /**
+         * @return the dictionary of the strings, nullptr if they are stored inline
+         */
+        StringDictionary *getDictionary() const { return dictionary.get(); }
+
+        PaxFileIterator begin() const;
+
+        PaxFileIterator end() const;
+
+        /**
+         * Start a scan of the pages [pageLo, pageHi). Pages past the end of the file are left out.
+         */
+        PaxFileRange scan(int pageLo, int pageHi) const;
+    };
+}
+
+#endif
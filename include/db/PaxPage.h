@@ -0,0 +1,185 @@
+#ifndef DB_PAXPAGE_H
+#define DB_PAXPAGE_H
+
+#include <db/HeapPageId.h>
+#include <db/Page.h>
+#include <db/StringDictionary.h>
+#include <db/Tuple.h>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace db {
+    class PaxPage;
+
+    class PaxPageIterator {
+        int slot;
+        const PaxPage *page;
+    public:
+        PaxPageIterator(int slot, const PaxPage *page);
+
+        bool operator!=(const PaxPageIterator &other) const;
+
+        PaxPageIterator &operator++();
+
+        const Tuple &operator*() const;
+
+        int getSlot() const { return slot; }
+    };
+
+    /**
+     * PaxPage holds as many tuples as a HeapPage of the same table, but groups the values of
+     * each field together (Partition Attributes Across): the page starts with the header
+     * bitmap of the used slots, padded to 8 bytes, followed by one minipage per field with
+     * the value of that field for every slot. A scan of one field reads a contiguous array
+     * instead of striding over whole tuples.
+     * <p>
+     * Values are stored as in a HeapPage, an int in 4 bytes and a string as a 4-byte length
+     * followed by STRING_LEN bytes, so every minipage is 4-byte aligned. Empty slots are
+     * zeroed, an aggregate over an int column can add up a whole minipage.
+     * <p>
+     * With a StringDictionary, strings are stored as their 4-byte code instead, and a page
+     * holds as many tuples as the narrower tuples fit. Operators can then filter, group and
+     * join on the codes of getCodeColumn without decoding any string.
+     * <p>
+     * Like a SlottedPage, the page keeps its own copy of the image and decodes tuples when
+     * they are first read.
+     *
+     * @see PaxFile
+     */
+    class PaxPage : public Page {
+        friend class PaxPageIterator;
+
+        HeapPageId pid;
+        TupleDesc td;
+        std::vector<uint8_t> image;
+        int numSlots;
+        /** Slots in use */
+        int numUsed;
+        /** Offset of the minipage of each field, and the size of its values */
+        std::vector<size_t> columns;
+        std::vector<size_t> widths;
+        /** Codes of the strings, nullptr if they are stored inline */
+        StringDictionary *dictionary;
+
+        /** Serializes the decoding of tuples by concurrent readers */
+        mutable std::mutex latch;
+        /** Tuple decoded from each slot, nullptr until the slot is first read */
+        mutable std::vector<const Tuple *> decoded;
+        /** Tuples, fields and record ids decoded from the page, deleted with the page */
+        mutable std::deque<Tuple> tuples;
+        mutable std::vector<const Field *> parsedFields;
+        mutable std::vector<const RecordId *> parsedRecordIds;
+
+        /**
+         * @return the offset of field i of the tuple in slot
+         */
+        size_t getValueOffset(int slot, int i) const {
+            return columns[i] + slot * widths[i];
+        }
+
+    public:
+        /**
+         * @param data the page as stored on disk, copied
+         * @param dictionary the dictionary the strings of the page are encoded with, nullptr if
+         *                   they are stored inline
+         */
+        PaxPage(const HeapPageId &id, const uint8_t *data, StringDictionary *dictionary = nullptr);
+
+        PaxPage(const PaxPage &) = delete;
+
+        ~PaxPage() override;
+
+        /**
+         * @return the size of a value of type in a page, with or without a dictionary
+         */
+        static size_t getValueSize(Types::Type type, bool encoded);
+
+        /**
+         * @return the number of slots of a page of td, and the size of its header
+         */
+        static int getNumSlots(const TupleDesc &td, bool encoded, size_t &headerSize);
+
+        const PageId &getId() const override;
+
+        void *getPageData() const override;
+
+        /**
+         * @return the data of an empty page
+         */
+        static void *createEmptyPageData();
+
+        int getNumSlots() const { return numSlots; }
+
+        int getNumEmptySlots() const { return numSlots - numUsed; }
+
+        bool isSlotUsed(int slot) const;
+
+        /**
+         * @return the header bitmap, bit slot % 8 of byte slot / 8 is set if slot is used
+         */
+        const uint8_t *getHeader() const { return image.data(); }
+
+        /**
+         * Add t to the first empty slot and set its RecordId.
+         * @throws std::runtime_error if the page is full or t has another TupleDesc
+         */
+        void insertTuple(Tuple *t);
+
+        /**
+         * Remove t from the page and zero its values.
+         * @throws std::runtime_error if t is not on this page
+         */
+        void deleteTuple(Tuple *t);
+
+        /**
+         * Decode the tuple in slot, once.
+         */
+        const Tuple &getTuple(int slot) const;
+
+        /**
+         * @return the minipage of field i, an INT_TYPE field: getNumSlots() values, 0 in the
+         *         empty slots. Valid as long as the page is.
+         */
+        const int *getIntColumn(int i) const {
+            return reinterpret_cast<const int *>(image.data() + columns[i]);
+        }
+
+        /**
+         * @return field i, an INT_TYPE field, of the tuple in slot
+         */
+        int getInt(int slot, int i) const {
+            int value;
+            memcpy(&value, image.data() + getValueOffset(slot, i), sizeof(value));
+            return value;
+        }
+
+        /**
+         * @return the minipage of field i, a dictionary encoded STRING_TYPE field: the code of
+         *         every slot, 0 in the empty slots. Valid as long as the page is.
+         */
+        const int *getCodeColumn(int i) const {
+            return reinterpret_cast<const int *>(image.data() + columns[i]);
+        }
+
+        /**
+         * @return the code of field i, a dictionary encoded STRING_TYPE field, of the tuple in slot
+         */
+        int getCode(int slot, int i) const { return getInt(slot, i); }
+
+        /**
+         * @return field i, a STRING_TYPE field, of the tuple in slot. The view points into the
+         *         page, or the dictionary, and is valid as long as the page is.
+         */
+        std::string_view getString(int slot, int i) const;
+
+        PaxPageIterator begin() const;
+
+        PaxPageIterator end() const;
+    };
+}
+
+#endif
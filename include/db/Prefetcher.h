@@ -0,0 +1,149 @@
+#ifndef DB_PREFETCHER_H
+#define DB_PREFETCHER_H
+
+#include <db/HeapPageId.h>
+#include <db/BTreePageId.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace db {
+    class BufferPool;
+
+    struct PrefetchStats {
+        /** Pages requested by the iterators */
+        long issued;
+        /** Pages read from disk by the prefetcher */
+        long loaded;
+        /** Prefetched pages that were accessed while resident */
+        long hits;
+        /** Prefetched pages that were evicted or discarded before being accessed */
+        long wasted;
+    };
+
+    /**
+     * Prefetcher reads pages into the BufferPool in the background, ahead of sequential scans.
+     * <p>
+     * Iterators report the pages they move to through a ReadAhead. Once the access looks
+     * sequential, the next pages are queued here and a worker thread reads them into the
+     * pool without taking any lock, so the scan finds them resident instead of stalling on
+     * the read. B+ tree leaves are not laid out in order on disk, so leaf requests follow the
+     * chain of right siblings from the page read by the worker.
+     * <p>
+     * Read-ahead is disabled until a window is set: the worker reads files through the
+     * Catalog, so every file it may be reading must outlive the BufferPool.
+     */
+    class Prefetcher {
+        /** Requests beyond this are dropped, read-ahead is best effort */
+        static constexpr size_t MAX_QUEUED = 1024;
+        /** Heap pages queued together are read in batches of up to this many pages */
+        static constexpr size_t MAX_BATCH = 32;
+
+        struct Request {
+            std::unique_ptr<PageId> pid;
+            /** Number of right siblings to read after pid */
+            int followSiblings;
+        };
+
+        BufferPool &bufferPool;
+        std::atomic<int> window{DEFAULT_WINDOW};
+
+        std::mutex latch;
+        std::condition_variable cv;
+        std::deque<Request> queue;
+        /** Requests being served by the worker */
+        int active = 0;
+        /** Notified when the queue becomes empty and no request is being served */
+        std::condition_variable idle;
+        bool stopping = false;
+        /** Started on the first request */
+        std::thread worker;
+
+        std::atomic<long> issued{0};
+        std::atomic<long> loaded{0};
+        std::atomic<long> hits{0};
+        std::atomic<long> wasted{0};
+
+        void enqueue(Request request);
+
+        void run();
+
+    public:
+        /** Default number of pages read ahead, read-ahead is disabled by default. */
+        static constexpr int DEFAULT_WINDOW = 0;
+
+        explicit Prefetcher(BufferPool &bufferPool);
+
+        Prefetcher(const Prefetcher &) = delete;
+
+        /**
+         * Stop the worker, dropping the queued requests.
+         */
+        ~Prefetcher();
+
+        /**
+         * @param pages number of pages read ahead of a sequential scan, 0 disables read-ahead.
+         */
+        void setWindow(int pages);
+
+        int getWindow() const;
+
+        /**
+         * Queue pid to be read into the buffer pool.
+         */
+        void prefetch(const HeapPageId &pid);
+
+        /**
+         * Queue leaf and count - 1 of its right siblings to be read into the buffer pool.
+         */
+        void prefetchLeaves(const BTreePageId &leaf, int count);
+
+        /**
+         * Block until all the queued requests are served.
+         */
+        void drain();
+
+        /** Called by the BufferPool when it reads a page on behalf of the prefetcher */
+        void recordLoad() { loaded.fetch_add(1, std::memory_order_relaxed); }
+
+        /** Called by the BufferPool on the first access to a prefetched page */
+        void recordHit() { hits.fetch_add(1, std::memory_order_relaxed); }
+
+        /** Called by the BufferPool when a prefetched page leaves the pool without being accessed */
+        void recordWasted() { wasted.fetch_add(1, std::memory_order_relaxed); }
+
+        PrefetchStats getStats() const;
+    };
+
+    /**
+     * Detects sequential access by an iterator and queues read-ahead requests.
+     * Each iterator keeps its own ReadAhead and reports every page it moves to.
+     */
+    class ReadAhead {
+        /** Number of consecutive pages after which the access is considered sequential */
+        static constexpr int SEQUENTIAL_RUN = 2;
+
+        int lastPage = -1;
+        int run = 0;
+        /** Heap files: last page requested. B+ trees: leaves requested but not reached yet */
+        int ahead = 0;
+
+    public:
+        /**
+         * Report that a heap file iterator moved to pid.
+         * @param numPages number of pages in the file, nothing is read past the end
+         */
+        void access(const HeapPageId &pid, int numPages);
+
+        /**
+         * Report that a B+ tree iterator moved to the right sibling of the previous leaf.
+         * @param next the right sibling of the new leaf, nullptr if it is the last one
+         */
+        void accessLeaf(const BTreePageId *next);
+    };
+}
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef DB_REPLACEMENTPOLICY_H
+#define DB_REPLACEMENTPOLICY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <optional>
+#include <set>
+#include <tuple>
+#include <vector>
+
+namespace db {
+    enum class ReplacementPolicyType {
+        CLOCK, LRU_K, TWO_Q
+    };
+
+    /**
+     * ReplacementPolicy decides which frame of the BufferPool should be evicted next.
+     * Frames are identified by their index in the BufferPool, in the range [0, numFrames).
+     * <p>
+     * The BufferPool calls recordAccess every time the page held by a frame is referenced
+     * (including when the frame is filled), and remove when the page leaves the frame.
+     * Only frames marked as evictable are considered by evict.
+     */
+    class ReplacementPolicy {
+    public:
+        virtual ~ReplacementPolicy() = default;
+
+        /**
+         * Record that the page held by frame was referenced.
+         */
+        virtual void recordAccess(size_t frame) = 0;
+
+        /**
+         * Control whether frame can be chosen as a victim.
+         */
+        virtual void setEvictable(size_t frame, bool evictable) = 0;
+
+        /**
+         * Forget all the history of frame. Called when its page is discarded.
+         */
+        virtual void remove(size_t frame) = 0;
+
+        /**
+         * Choose a victim among the evictable frames and forget its history.
+         * @return the victim frame, or nullopt if no frame can be evicted
+         */
+        virtual std::optional<size_t> evict() = 0;
+
+        /**
+         * Create a policy of the given type managing numFrames frames.
+         */
+        static std::unique_ptr<ReplacementPolicy> create(ReplacementPolicyType type, size_t numFrames);
+    };
+
+    /**
+     * CLOCK (second chance): a hand sweeps the frames, clearing reference bits and
+     * evicting the first evictable frame that was not referenced since the last sweep.
+     */
+    class ClockPolicy : public ReplacementPolicy {
+        std::vector<bool> present;
+        std::vector<bool> referenced;
+        std::vector<bool> evictable;
+        size_t hand = 0;
+    public:
+        explicit ClockPolicy(size_t numFrames);
+
+        void recordAccess(size_t frame) override;
+
+        void setEvictable(size_t frame, bool value) override;
+
+        void remove(size_t frame) override;
+
+        std::optional<size_t> evict() override;
+    };
+
+    /**
+     * LRU-K: evicts the frame whose K-th most recent reference is the oldest. Frames
+     * referenced fewer than K times have an infinite backward K-distance and are evicted
+     * first (oldest first reference first), which keeps pages touched once by a scan from
+     * pushing out pages that are referenced repeatedly.
+     */
+    class LRUKPolicy : public ReplacementPolicy {
+        /** (has K references, K-th most recent or first reference, frame), smallest is evicted first */
+        using Key = std::tuple<bool, uint64_t, size_t>;
+
+        size_t k;
+        uint64_t now = 0;
+        std::vector<std::deque<uint64_t>> history;
+        std::vector<bool> evictable;
+        std::set<Key> candidates;
+
+        Key getKey(size_t frame) const;
+    public:
+        LRUKPolicy(size_t numFrames, size_t k = 2);
+
+        void recordAccess(size_t frame) override;
+
+        void setEvictable(size_t frame, bool value) override;
+
+        void remove(size_t frame) override;
+
+        std::optional<size_t> evict() override;
+    };
+
+    /**
+     * Simplified 2Q: frames referenced once live in a FIFO queue (A1), frames referenced
+     * again while resident are promoted to an LRU queue (Am). Victims are taken from A1
+     * while it holds more than a quarter of the frames, so a large scan only ever cycles
+     * through A1 and leaves the hot pages in Am untouched.
+     */
+    class TwoQPolicy : public ReplacementPolicy {
+        enum class Queue {
+            NONE, A1, AM
+        };
+        size_t a1Threshold;
+        std::list<size_t> a1;
+        std::list<size_t> am;
+        std::vector<Queue> queue;
+        std::vector<std::list<size_t>::iterator> position;
+        std::vector<bool> evictable;
+
+        std::optional<size_t> evictFrom(std::list<size_t> &q);
+    public:
+        explicit TwoQPolicy(size_t numFrames);
+
+        void recordAccess(size_t frame) override;
+
+        void setEvictable(size_t frame, bool value) override;
+
+        void remove(size_t frame) override;
+
+        std::optional<size_t> evict() override;
+    };
+}
+
+#endif
@@ -2,12 +2,17 @@
 #define DB_SEQSCAN_H
 
 #include <iostream>
+#include <optional>
 #include <string>
 #include <stdexcept>
+#include <variant>
 #include <vector>
 #include <db/TupleDesc.h>
 #include <db/DbFile.h>
 #include <db/HeapFile.h>
+#include <db/MorselSplitter.h>
+#include <db/PaxFile.h>
+#include <db/SlottedFile.h>
 #include <db/DbIterator.h>
 
 namespace db {
@@ -17,11 +22,41 @@ namespace db {
      * disk).
      */
     class SeqScan : public DbIterator {
-        using iterator = HeapFileIterator;
+        /**
+         * A page range being scanned. Its end is kept from when the range was opened: an end
+         * built later would include the pages appended since, which the scan does not reach.
+         */
+        template<typename P>
+        struct Range {
+            PagedFileIterator<P> it;
+            PagedFileIterator<P> end;
+
+            explicit Range(const PagedFileRange<P> &range) : it(range.begin()), end(range.end()) {}
+        };
+
         int tableid;
         std::string alias;
         std::string tableName;
-        std::optional<SeqScan::iterator> itopt;
+        /** The range being scanned, empty when the scan is closed */
+        std::optional<std::variant<Range<HeapPage>, Range<SlottedPage>, Range<PaxPage>>> range;
+        /** Page ranges of the file to scan, in order, the whole file when not set */
+        std::optional<std::vector<Morsel>> morsels;
+        /** Next morsel to open once the current one is done */
+        size_t nextMorsel = 0;
+        /** Fields of the table returned, all of them when not set */
+        std::optional<std::vector<int>> columns;
+        TupleDesc projectedTd;
+
+        /**
+         * Position the scan at the start of the pages [pageLo, pageHi) of the table.
+         */
+        void openRange(int pageLo, int pageHi);
+
+        /**
+         * @return the tuple at the position of range, which is then advanced
+         */
+        template<typename P>
+        Tuple next(Range<P> &range);
     public:
 
         /**
@@ -67,6 +102,15 @@ namespace db {
 
         SeqScan(int tableid);
 
+        /**
+         * Creates a sequential scan over some page ranges of a table stored in a PagedFile,
+         * e.g. the morsels a worker of a parallel scan took from a MorselSplitter. The
+         * ranges are scanned in the order given, none may be given.
+         *
+         * @param morsels the page ranges to scan
+         */
+        SeqScan(int tableid, const std::string &tableAlias, std::vector<Morsel> morsels);
+
         /**
          * Returns the TupleDesc with field names from the underlying HeapFile,
          * prefixed with the tableAlias string from the constructor. This prefix
@@ -79,6 +123,14 @@ namespace db {
          */
         const TupleDesc &getTupleDesc() const override;
 
+        /**
+         * Return only some fields of the table, e.g. the ones the rest of the plan reads. Pages
+         * of a HeapFile then decode only those fields. Call before open.
+         *
+         * @param columns indexes of the fields in the table, in the order they are returned
+         */
+        void setProjection(const std::vector<int> &columns);
+
         void open() override;
 
         bool hasNext() override;
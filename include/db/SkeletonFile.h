@@ -50,6 +50,7 @@ namespace db {
         TupleDesc td;
     public:
         int writes = 0;
+        int syncs = 0;
 
         SkeletonFile(int id, const TupleDesc &td) : id(id), td(td) {}
 
@@ -63,17 +64,19 @@ namespace db {
 
         int getNumPages() const override;
 
-        Page *readPage(const PageId &pid) override;
+        Page *readPage(const PageId &pid, uint8_t *frame) override;
 
         void writePage(Page *p) override;
 
+        void sync() override;
+
         iterator begin() const;
 
         iterator end() const;
 
-        std::vector<Page *> insertTuple(TransactionId tid, Tuple &t) override;
+        std::vector<PageGuard> insertTuple(TransactionId tid, Tuple &t) override;
 
-        std::vector<Page *> deleteTuple(TransactionId tid, Tuple &t) override;
+        std::vector<PageGuard> deleteTuple(TransactionId tid, Tuple &t) override;
     };
 }
 
@@ -0,0 +1,104 @@
+#ifndef DB_SLOTBITMAP_H
+#define DB_SLOTBITMAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Word at a time scans of the slot headers of the pages: bit i of a header, bit i % 8 of
+ * byte i / 8, is bit i % 64 of its little-endian 64-bit word i / 64, so a scan tests 64 slots
+ * with a popcount or a count of trailing zeros. Headers need not be aligned, and the bytes
+ * after the last slot are never read.
+ */
+namespace db::SlotBitmap {
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "header bytes are loaded as little-endian words");
+
+    /**
+     * @return word w of the numBits bits at bitmap, the bits past numBits cleared
+     */
+    inline uint64_t loadWord(const uint8_t *bitmap, int numBits, int w) {
+        int first = w * 8;
+        int bytes = (numBits + 7) / 8;
+        uint64_t word = 0;
+        if (first + 8 <= bytes) {
+            memcpy(&word, bitmap + first, 8);
+        } else {
+            memcpy(&word, bitmap + first, bytes - first);
+        }
+        int bits = numBits - w * 64;
+        return bits >= 64 ? word : word & ((uint64_t{1} << bits) - 1);
+    }
+
+    /**
+     * @return the number of set bits among the numBits at bitmap
+     */
+    inline int count(const uint8_t *bitmap, int numBits) {
+        int n = 0;
+        for (int w = 0; w * 64 < numBits; w++) {
+            n += __builtin_popcountll(loadWord(bitmap, numBits, w));
+        }
+        return n;
+    }
+
+    /**
+     * @return the first bit at or after from that is set, or clear if value is false,
+     *         numBits if there is none
+     */
+    inline int next(const uint8_t *bitmap, int numBits, int from, bool value) {
+        if (from >= numBits) {
+            return numBits;
+        }
+        for (int w = from / 64; w * 64 < numBits; w++) {
+            uint64_t word = loadWord(bitmap, numBits, w);
+            if (!value) {
+                word = ~word;
+                int bits = numBits - w * 64;
+                if (bits < 64) {
+                    word &= (uint64_t{1} << bits) - 1;
+                }
+            }
+            if (w == from / 64) {
+                word &= ~uint64_t{0} << (from % 64);
+            }
+            if (word != 0) {
+                return w * 64 + __builtin_ctzll(word);
+            }
+        }
+        return numBits;
+    }
+
+    /**
+     * @return the last set bit at or before from, -1 if there is none
+     */
+    inline int prev(const uint8_t *bitmap, int numBits, int from) {
+        from = std::min(from, numBits - 1);
+        for (int w = from / 64; w >= 0 && from >= 0; w--) {
+            uint64_t word = loadWord(bitmap, numBits, w);
+            if (w == from / 64 && from % 64 < 63) {
+                word &= (uint64_t{2} << (from % 64)) - 1;
+            }
+            if (word != 0) {
+                return w * 64 + 63 - __builtin_clzll(word);
+            }
+        }
+        return -1;
+    }
+
+    inline bool test(const uint8_t *bitmap, int i) {
+        return (bitmap[i >> 3] >> (i & 7) & 1) != 0;
+    }
+
+    /**
+     * Set or clear bit i.
+     * @return whether the bit changed
+     */
+    inline bool assign(uint8_t *bitmap, int i, bool value) {
+        uint8_t mask = 1 << (i & 7);
+        uint8_t before = bitmap[i >> 3];
+        bitmap[i >> 3] = value ? before | mask : before & ~mask;
+        return bitmap[i >> 3] != before;
+    }
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef DB_SLOTTEDFILE_H
+#define DB_SLOTTEDFILE_H
+
+#include <db/PagedFile.h>
+#include <db/SlottedPage.h>
+
+namespace db {
+    using SlottedFileIterator = PagedFileIterator<SlottedPage>;
+
+    using SlottedFileRange = PagedFileRange<SlottedPage>;
+
+    /**
+     * SlottedFile is a DbFile of SlottedPages: tuples in no particular order, strings stored
+     * with their actual length. It is a drop-in replacement for a HeapFile whose strings are
+     * mostly shorter than Types::STRING_LEN.
+     * <p>
+     * Like a HeapFile, the pages that may have room are kept in a FreeSpaceMap next to the
+     * file. A page is marked free while it can hold the largest tuple of the table; pages
+     * with less room are only filled further as the last page of the file.
+     *
+     * @see db::SlottedPage
+     */
+    class SlottedFile : public PagedFile {
+    protected:
+        Page *createPage(const HeapPageId &pid, uint8_t *frame) override;
+
+        void *createEmptyPageData() const override;
+
+        bool hasRoom(const Page *page, const Tuple &t) const override;
+
+        bool isFree(const Page *page) const override;
+
+        void insertInto(Page *page, Tuple &t) override;
+
+        void deleteFrom(Page *page, Tuple &t) override;
+
+    public:
+        /**
+         * @param fname the file of the pages, its free space map is kept in fname.fsm
+         * @throws std::runtime_error if the page size of the BufferPool is above
+         *         SlottedPage::MAX_PAGE_SIZE
+         */
+        SlottedFile(const char *fname, const TupleDesc &td, IoBackendType ioBackend = IoBackendType::POSIX);
+
+        SlottedFileIterator begin() const;
+
+        SlottedFileIterator end() const;
+
+        /**
+         * Start a scan of the pages [pageLo, pageHi). Pages past the end of the file are left out.
+         */
+        SlottedFileRange scan(int pageLo, int pageHi) const;
+    };
+}
+
+#endif
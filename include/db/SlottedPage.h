@@ -0,0 +1,180 @@
+#ifndef DB_SLOTTEDPAGE_H
+#define DB_SLOTTEDPAGE_H
+
+#include <db/HeapPageId.h>
+#include <db/Page.h>
+#include <db/Tuple.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace db {
+    class SlottedPage;
+
+    class SlottedPageIterator {
+        int slot;
+        const SlottedPage *page;
+    public:
+        SlottedPageIterator(int slot, const SlottedPage *page);
+
+        bool operator!=(const SlottedPageIterator &other) const;
+
+        SlottedPageIterator &operator++();
+
+        const Tuple &operator*() const;
+
+        int getSlot() const { return slot; }
+    };
+
+    /**
+     * SlottedPage stores variable-length records: a string takes its length and its
+     * characters instead of the STRING_LEN bytes of a HeapPage.
+     * <p>
+     * The page starts with a header of two 16-bit words, the number of slots of the directory
+     * and the offset of the first record byte, followed by the slot directory, one (offset,
+     * length) pair of 16-bit words per slot. Records are packed at the end of the page and
+     * grow toward the directory; a free slot has length 0. An all-zero page is an empty page.
+     * <p>
+     * A record holds its fields one after the other: an int in 4 bytes, a string as a 16-bit
+     * length followed by its characters. Deletes compact the records right away, so the free
+     * space of a page is always the gap between the directory and the records. Slot numbers,
+     * and therefore RecordIds, do not change when records move.
+     * <p>
+     * The page keeps its own copy of the image, the frame it was read into keeps the before
+     * image of the write-ahead log. Tuples are decoded when first read.
+     *
+     * @see SlottedFile
+     */
+    class SlottedPage : public Page {
+        friend class SlottedPageIterator;
+
+        static constexpr size_t HEADER_SIZE = 2 * sizeof(uint16_t);
+        static constexpr size_t SLOT_SIZE = 2 * sizeof(uint16_t);
+
+        HeapPageId pid;
+        TupleDesc td;
+        std::vector<uint8_t> image;
+
+        /** A tuple decoded from a slot, with the fields and RecordId it points to */
+        struct Decoded {
+            RecordId rid;
+            std::vector<std::unique_ptr<const Field>> fields;
+            Tuple tuple;
+
+            Decoded(const TupleDesc &td, const HeapPageId *pid, int slot) : rid(pid, slot), tuple(td) {}
+        };
+
+        /** Serializes the decoding of tuples by concurrent readers */
+        mutable std::mutex latch;
+        /** Tuple decoded from each slot of the directory, nullptr until the slot is first read */
+        mutable std::vector<std::unique_ptr<Decoded>> decoded;
+        /** Tuples decoded from slots that were overwritten or removed since, kept for their readers until reclaim */
+        std::vector<std::unique_ptr<Decoded>> retired;
+
+        /**
+         * Retire the tuple decoded from slot, which is about to change, and fit the decoded
+         * tuples to the directory. Requires the latch.
+         */
+        void retire(int slot);
+
+        uint16_t getWord(size_t offset) const;
+
+        void setWord(size_t offset, uint16_t value);
+
+        /** Offset of the first record byte, the page size if there is no record */
+        size_t getDataStart() const;
+
+        size_t getSlotOffset(int slot) const { return getWord(HEADER_SIZE + slot * SLOT_SIZE); }
+
+        size_t getSlotLength(int slot) const { return getWord(HEADER_SIZE + slot * SLOT_SIZE + sizeof(uint16_t)); }
+
+        void setSlot(int slot, size_t offset, size_t length);
+
+        /**
+         * @return the first free slot, getNumSlots() if the directory has to grow
+         */
+        int findFreeSlot() const;
+
+        void writeRecord(uint8_t *data, const Tuple &t) const;
+
+    public:
+        /**
+         * @param data the page as stored on disk, copied
+         */
+        SlottedPage(const HeapPageId &id, const uint8_t *data);
+
+        SlottedPage(const SlottedPage &) = delete;
+
+        ~SlottedPage() override = default;
+
+        const PageId &getId() const override;
+
+        void *getPageData() const override;
+
+        void reclaim() override;
+
+        /**
+         * @return the number of tuples kept for the readers of overwritten or removed slots
+         */
+        size_t getNumRetired() const;
+
+        /**
+         * @return the data of an empty page
+         */
+        static void *createEmptyPageData();
+
+        /** Largest page size the 16-bit offsets can address */
+        static constexpr size_t MAX_PAGE_SIZE = 65536;
+
+        /**
+         * @return the bytes t takes in a page, record and slot
+         */
+        static size_t getRecordSize(const TupleDesc &td, const Tuple &t);
+
+        /**
+         * @return the bytes the largest tuple of td takes in a page, record and slot
+         */
+        static size_t getMaxRecordSize(const TupleDesc &td);
+
+        /**
+         * @return the bytes available for a record and its slot
+         */
+        size_t getFreeSpace() const;
+
+        /**
+         * @return the number of records on the page
+         */
+        int getNumTuples() const;
+
+        /**
+         * @return the number of slots of the directory, used or not
+         */
+        int getNumSlots() const { return getWord(0); }
+
+        bool isSlotUsed(int slot) const;
+
+        /**
+         * Add t to the page and set its RecordId.
+         * @throws std::runtime_error if the page does not have room for it
+         */
+        void insertTuple(Tuple *t);
+
+        /**
+         * Remove t from the page and compact the records.
+         * @throws std::runtime_error if t is not on this page
+         */
+        void deleteTuple(Tuple *t);
+
+        /**
+         * Decode the tuple in slot, once.
+         */
+        const Tuple &getTuple(int slot) const;
+
+        SlottedPageIterator begin() const;
+
+        SlottedPageIterator end() const;
+    };
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef DB_STRINGDICTIONARY_H
+#define DB_STRINGDICTIONARY_H
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace db {
+    /**
+     * StringDictionary maps the distinct strings of a file to integer codes, so that pages
+     * store a 4-byte code instead of a STRING_LEN string. Codes are dense and start at 1, 0
+     * is never a code and stands for no value. A code is assigned once and never changes,
+     * which lets operators compare, group and hash codes across every page of the file.
+     * <p>
+     * The dictionary is kept in a file next to the table, a magic number followed by one
+     * record per code: its 16-bit length and its characters. A new string is appended and
+     * synced when it is encoded, before a page or a log record can hold its code, which costs
+     * one sync per distinct string. A torn record at the end is dropped when the dictionary is
+     * opened.
+     */
+    class StringDictionary {
+        static constexpr char MAGIC[8] = {'D', 'B', 'D', 'I', 'C', 'T', '0', '1'};
+
+        int fd;
+        mutable std::shared_mutex latch;
+        /** String of each code, code i at index i - 1. A deque, so references stay valid as it grows */
+        std::deque<std::string> values;
+        std::unordered_map<std::string_view, int> codes;
+        /** End of the records written to the file */
+        off_t end;
+
+        /**
+         * Read the records of the open file, or write the magic of a new one.
+         */
+        void load();
+
+    public:
+        /**
+         * Open or create the dictionary stored at path.
+         */
+        explicit StringDictionary(const std::string &path);
+
+        StringDictionary(const StringDictionary &) = delete;
+
+        ~StringDictionary();
+
+        /**
+         * @return the code of value, assigned and made durable if value is new
+         */
+        int encode(std::string_view value);
+
+        /**
+         * @return the code of value, std::nullopt if no value was encoded as value; used to
+         *         translate the constant of a filter once instead of decoding every code
+         */
+        std::optional<int> find(std::string_view value) const;
+
+        /**
+         * @return the string of code, valid as long as the dictionary is
+         */
+        std::string_view decode(int code) const;
+
+        /**
+         * @return the number of codes, the largest code
+         */
+        int size() const;
+    };
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef DB_VACUUM_H
+#define DB_VACUUM_H
+
+#include <db/HeapFile.h>
+#include <db/RecordId.h>
+#include <functional>
+
+namespace db {
+    struct VacuumStats {
+        /** Tuples moved to an earlier page */
+        long tuplesMoved;
+        /** Pages of the file when the vacuum started, and when it ended */
+        int pagesBefore;
+        int pagesAfter;
+    };
+
+    /**
+     * Vacuum compacts a HeapFile online: it moves the tuples of the last pages into the free
+     * slots of the first ones, then removes the empty pages at the end of the file, so that a
+     * scan reads as many pages as the live tuples need.
+     * <p>
+     * Tuples are moved through the BufferPool like any update, one transaction per page
+     * emptied: a moved tuple is inserted, the free space map picks the first page with a
+     * free slot, then deleted from its page. Other transactions run meanwhile and wait for
+     * the pages a move locks; scans, which do not lock, may see a tuple twice or miss it
+     * while it moves, as with any concurrent update. Pages are removed under exclusive locks,
+     * once they are empty; a reader still on a removed page keeps it, and pages read past the
+     * new end of the file are empty.
+     * <p>
+     * A moved tuple gets a new RecordId. The relocation callback is called with the old and
+     * the new one, inside the transaction of the move, for anything that refers to tuples by
+     * RecordId, e.g. a secondary index.
+     */
+    class Vacuum {
+        HeapFile &file;
+        std::function<void(const RecordId &, const RecordId &)> onRelocate;
+
+        /**
+         * Move the tuples of page source to the pages before target, in one transaction.
+         * @return false if those pages ran out of free slots, the page may not be empty
+         */
+        bool emptyPage(int source, int target, long &moved);
+
+        /**
+         * Remove the empty pages at the end of the file, down to page target.
+         */
+        void truncate(int target);
+
+    public:
+        explicit Vacuum(HeapFile &file);
+
+        Vacuum(const Vacuum &) = delete;
+
+        /**
+         * @param callback called with the old and the new RecordId of every tuple moved
+         */
+        void setRelocationCallback(std::function<void(const RecordId &, const RecordId &)> callback);
+
+        /**
+         * Compact the file and return once it is done.
+         * @throws std::runtime_error before anything is moved if the file is mapped, since a
+         *         mapped file cannot be truncated
+         * @throws TransactionAbortedException if a move would deadlock with another
+         *         transaction; the move is rolled back, the moves before it are kept
+         */
+        VacuumStats run();
+    };
+}
+
+#endif
@@ -6,6 +6,9 @@
 #include <db/Tuple.h>
 #include <db/IntField.h>
 #include <db/SkeletonFile.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
 int EXAMPLE_VALUES[][2] = {{31933, 862},
                            {29402, 56883},
@@ -112,3 +115,38 @@ TEST(HeapPageReadTest, GetSlot) {
         EXPECT_FALSE(page.isSlotUsed(i));
     }
 }
+
+TEST(HeapPageReadTest, TypedAccessors) {
+    db::HeapPageId pid(-1, -1);
+    db::Database::getCatalog().addTable(new db::SkeletonFile(-1, db::Utility::getTupleDesc(2)),
+                                        db::Utility::generateUUID());
+    // updates are made in place, keep EXAMPLE_DATA intact
+    std::vector<uint8_t> image(EXAMPLE_DATA, EXAMPLE_DATA + sizeof(EXAMPLE_DATA));
+    db::HeapPage page(pid, image.data());
+
+    int row = 0;
+    for (auto it = page.begin(); it != page.end(); ++it) {
+        EXPECT_EQ(EXAMPLE_VALUES[row][0], page.getInt(it.getSlot(), 0));
+        EXPECT_EQ(EXAMPLE_VALUES[row][1], page.getInt(it.getSlot(), 1));
+        ++row;
+    }
+    EXPECT_EQ(row, 20);
+
+    db::Tuple tuple(db::Utility::getTupleDesc(2));
+    tuple.setField(0, new db::IntField(7));
+    tuple.setField(1, new db::IntField(8));
+    page.insertTuple(&tuple);
+    EXPECT_EQ(page.getInt(20, 1), 8);
+    EXPECT_EQ(image[2], 0x1f);
+
+    // the header and the tuple are both in the first sector
+    std::vector<bool> sectors = page.takeUnwrittenSectors();
+    EXPECT_TRUE(sectors[0]);
+    EXPECT_EQ(std::count(sectors.begin(), sectors.end(), true), 1);
+    EXPECT_FALSE(page.takeUnwrittenSectors()[0]);
+
+    std::vector<uint8_t> before(image.size());
+    EXPECT_TRUE(page.takeBeforeImage(before.data()));
+    EXPECT_EQ(0, memcmp(before.data(), EXAMPLE_DATA, sizeof(EXAMPLE_DATA)));
+    EXPECT_FALSE(page.takeBeforeImage(before.data()));
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include <db/SlotBitmap.h>
+#include <random>
+#include <vector>
+
+/**
+ * Compare every scan with a bit at a time scan, on sizes around word boundaries.
+ */
+TEST(SlotBitmapTest, MatchesBitScan) {
+    std::mt19937 random(42);
+    for (int numBits: {1, 7, 63, 64, 65, 127, 504, 992}) {
+        // one more byte, set, to check that the scans stop at numBits
+        std::vector<uint8_t> bitmap((numBits + 7) / 8 + 1, 0xFF);
+        for (int i = 0; i < numBits; i++) {
+            db::SlotBitmap::assign(bitmap.data(), i, random() % 3 == 0);
+        }
+        int count = 0;
+        for (int i = 0; i < numBits; i++) {
+            count += db::SlotBitmap::test(bitmap.data(), i);
+        }
+        EXPECT_EQ(db::SlotBitmap::count(bitmap.data(), numBits), count);
+
+        for (int from = 0; from <= numBits; from++) {
+            for (bool value: {true, false}) {
+                int expected = from;
+                while (expected < numBits && db::SlotBitmap::test(bitmap.data(), expected) != value) {
+                    expected++;
+                }
+                EXPECT_EQ(db::SlotBitmap::next(bitmap.data(), numBits, from, value), expected);
+            }
+            int expected = std::min(from, numBits - 1);
+            while (expected >= 0 && !db::SlotBitmap::test(bitmap.data(), expected)) {
+                expected--;
+            }
+            EXPECT_EQ(db::SlotBitmap::prev(bitmap.data(), numBits, from), expected);
+        }
+    }
+}
+
+TEST(SlotBitmapTest, Assign) {
+    uint8_t bitmap[2] = {0, 0};
+    EXPECT_TRUE(db::SlotBitmap::assign(bitmap, 9, true));
+    EXPECT_FALSE(db::SlotBitmap::assign(bitmap, 9, true));
+    EXPECT_EQ(bitmap[1], 0x02);
+    EXPECT_EQ(db::SlotBitmap::next(bitmap, 16, 0, true), 9);
+    EXPECT_EQ(db::SlotBitmap::next(bitmap, 9, 0, true), 9);
+    EXPECT_TRUE(db::SlotBitmap::assign(bitmap, 9, false));
+    EXPECT_EQ(db::SlotBitmap::prev(bitmap, 16, 15), -1);
+}
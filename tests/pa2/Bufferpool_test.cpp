@@ -2,6 +2,19 @@
 #include <db/Database.h>
 #include <db/SkeletonFile.h>
 #include <db/Utility.h>
+#include <db/HeapFile.h>
+#include <db/FrameArena.h>
+#include <db/IntField.h>
+#include <db/IoBackend.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include "TestUtility.h"
 
 TEST(BufferpoolTest, evictPage) {
     db::Database::reset();
@@ -144,3 +157,587 @@ TEST(BufferpoolTest, flushPages) {
     EXPECT_EQ(bufferpool.getPages().size(), 3);
     EXPECT_EQ(skeletonFile.writes, 2);
 }
+
+TEST(BufferpoolTest, concurrentGetPage) {
+    db::Database::reset();
+    db::Database::resetBufferPool(16, db::BufferPool::DEFAULT_POLICY, 4);
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    db::Catalog &catalog = db::Database::getCatalog();
+    db::SkeletonFile skeletonFile(1, db::Utility::getTupleDesc(2));
+    catalog.addTable(&skeletonFile);
+    std::vector<db::SkeletonPageId> pageIds;
+    for (int i = 0; i < 64; i++) {
+        pageIds.emplace_back(1, i);
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&bufferpool, &pageIds, t] {
+            for (int i = 0; i < 1000; i++) {
+                const db::PageId *pid = &pageIds[(i * 7 + t) % pageIds.size()];
+                // a pinned page cannot be evicted by another thread while it is used
+                db::PageGuard page = bufferpool.fetchPage(pid);
+                EXPECT_EQ(page->getId(), *pid);
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    // no shard may grow beyond its share of the pool
+    auto pages = bufferpool.getPages();
+    EXPECT_LE(pages.size(), 16);
+    for (const auto &[pid, page]: pages) {
+        EXPECT_EQ(*pid, page->getId());
+        EXPECT_EQ(bufferpool.getPage(pid), page);
+    }
+}
+
+TEST(BufferpoolTest, concurrentInserts) {
+    db::Database::reset();
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    test::removeFile("concurrent.dat");
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    db::HeapFile file("concurrent.dat", td);
+    db::Database::getCatalog().addTable(&file);
+
+    // inserts move on from a page another transaction locked instead of waiting for it, no
+    // transaction is aborted
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&bufferpool, &file, &td, t] {
+            for (int i = 0; i < 50; i++) {
+                db::TransactionId tid;
+                for (int j = 0; j < 10; j++) {
+                    db::Tuple tuple(td);
+                    tuple.setField(0, new db::IntField(t));
+                    tuple.setField(1, new db::IntField(i * 10 + j));
+                    EXPECT_NO_THROW(bufferpool.insertTuple(tid, file.getId(), &tuple));
+                }
+                bufferpool.transactionComplete(tid);
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    int rows = 0;
+    for (int pgNo = 0; pgNo < file.getNumPages(); pgNo++) {
+        db::HeapPageId pid(file.getId(), pgNo);
+        db::PageGuard guard = bufferpool.fetchPage(&pid);
+        const auto *page = guard.as<db::HeapPage>();
+        rows += page->getNumTuples() - page->getNumEmptySlots();
+    }
+    EXPECT_EQ(rows, 4 * 50 * 10);
+}
+
+TEST(BufferpoolTest, transactionComplete) {
+    db::Database::reset();
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    db::Catalog &catalog = db::Database::getCatalog();
+    db::SkeletonFile skeletonFile(1, db::Utility::getTupleDesc(2));
+    catalog.addTable(&skeletonFile);
+    db::SkeletonPageId page1(1, 0);
+    db::SkeletonPageId page2(1, 1);
+    db::TransactionId tid1;
+    db::TransactionId tid2;
+
+    bufferpool.getPage(tid1, &page1, db::Permissions::READ_ONLY);
+    bufferpool.getPage(tid2, &page1, db::Permissions::READ_ONLY);
+    auto page = bufferpool.getPage(tid1, &page2, db::Permissions::READ_WRITE);
+    page->markDirty(tid1);
+    EXPECT_TRUE(bufferpool.holdsLock(tid1, &page1));
+    EXPECT_TRUE(bufferpool.holdsLock(tid2, &page1));
+
+    bufferpool.transactionComplete(tid1, false);
+    // the aborted page is discarded and the locks are released
+    EXPECT_EQ(bufferpool.getPages().size(), 1);
+    EXPECT_EQ(skeletonFile.writes, 0);
+    EXPECT_FALSE(bufferpool.holdsLock(tid1, &page1));
+    EXPECT_FALSE(bufferpool.holdsLock(tid1, &page2));
+    EXPECT_TRUE(bufferpool.holdsLock(tid2, &page1));
+}
+
+/**
+ * Write a heap file of numPages pages holding one tuple each.
+ */
+static void writeHeapFile(const char *fname, int numPages) {
+    std::ofstream out(fname, std::ios::binary | std::ios::trunc);
+    std::vector<char> data(db::Database::getBufferPool().getPageSize(), 0);
+    data[0] = 1;
+    for (int i = 0; i < numPages; i++) {
+        out.write(data.data(), data.size());
+    }
+}
+
+TEST(BufferpoolTest, readAhead) {
+    db::Database::reset();
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    db::Catalog &catalog = db::Database::getCatalog();
+    writeHeapFile("readahead.dat", 20);
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    db::HeapFile file("readahead.dat", td);
+    catalog.addTable(&file);
+    db::Prefetcher &prefetcher = bufferpool.getPrefetcher();
+    prefetcher.setWindow(4);
+
+    int tuples = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        tuples++;
+    }
+    prefetcher.drain();
+    EXPECT_EQ(tuples, 20);
+    db::PrefetchStats stats = prefetcher.getStats();
+    // read-ahead starts on the second page and stops at the end of the file
+    EXPECT_EQ(stats.issued, 18);
+    // the scan reads every page the prefetcher read before it
+    EXPECT_EQ(stats.hits, stats.loaded);
+    EXPECT_EQ(stats.wasted, 0);
+
+    db::HeapPageId unused(file.getId(), 0);
+    bufferpool.discardPage(&unused);
+    prefetcher.prefetch(unused);
+    prefetcher.drain();
+    bufferpool.discardPage(&unused);
+    stats = prefetcher.getStats();
+    EXPECT_EQ(stats.loaded, stats.hits + 1);
+    EXPECT_EQ(stats.wasted, 1);
+}
+
+TEST(BufferpoolTest, frameArena) {
+    db::FrameArena arena(8, 4000);
+    EXPECT_EQ(arena.getFrameSize(), 4096);
+    for (size_t i = 0; i < arena.getNumFrames(); i++) {
+        uint8_t *frame = arena.getFrame(i);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(frame) % db::FrameArena::ALIGNMENT, 0);
+        frame[arena.getFrameSize() - 1] = 1;
+    }
+    // falls back to regular pages when no huge page is reserved
+    db::FrameArena huge(8, 4096, true);
+    huge.getFrame(7)[4095] = 1;
+}
+
+TEST(BufferpoolTest, batchedReads) {
+    db::Database::reset();
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    db::Catalog &catalog = db::Database::getCatalog();
+    writeHeapFile("batch.dat", 20);
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    db::HeapFile file("batch.dat", td, db::IoBackendType::IO_URING);
+    catalog.addTable(&file);
+
+    std::vector<db::HeapPageId> pageIds;
+    for (int i = 19; i >= 0; i--) {
+        pageIds.emplace_back(file.getId(), i);
+    }
+    std::vector<const db::PageId *> pids;
+    for (const auto &pid: pageIds) {
+        pids.push_back(&pid);
+    }
+    std::vector<int> read;
+    bufferpool.getPages(pids, [&read](db::Page *page) {
+        auto *heapPage = dynamic_cast<db::HeapPage *>(page);
+        EXPECT_EQ(heapPage->getNumEmptySlots(), heapPage->getNumTuples() - 1);
+        read.push_back(page->getId().pageNumber());
+    });
+    std::sort(read.begin(), read.end());
+    EXPECT_EQ(read.size(), 20);
+    EXPECT_EQ(read.front(), 0);
+    EXPECT_EQ(read.back(), 19);
+    EXPECT_EQ(bufferpool.getPages().size(), 20);
+
+    // writes go through the same backend
+    auto *page = dynamic_cast<db::HeapPage *>(bufferpool.getPage(&pageIds[0]));
+    db::Tuple tuple(td);
+    tuple.setField(0, new db::IntField(1));
+    tuple.setField(1, new db::IntField(2));
+    page->insertTuple(&tuple);
+    db::TransactionId tid;
+    page->markDirty(tid);
+    bufferpool.flushPage(&pageIds[0]);
+    bufferpool.discardPage(&pageIds[0]);
+    page = dynamic_cast<db::HeapPage *>(bufferpool.getPage(&pageIds[0]));
+    EXPECT_EQ(page->getNumEmptySlots(), page->getNumTuples() - 2);
+}
+
+TEST(BufferpoolTest, unalignedDirectWrites) {
+    std::unique_ptr<db::UringIoBackend> io;
+    try {
+        io = std::make_unique<db::UringIoBackend>();
+    } catch (const std::runtime_error &) {
+        GTEST_SKIP() << "io_uring is not available";
+    }
+    int fd = open("unaligned.dat", O_RDWR | O_CREAT | O_TRUNC, 0644);
+    ASSERT_NE(fd, -1);
+    std::vector<uint8_t> pages(2 * db::UringIoBackend::ALIGNMENT, 1);
+    ASSERT_EQ(io->write(fd, pages.data(), pages.size(), 0), static_cast<ssize_t>(pages.size()));
+
+    // padding a sector to the alignment would zero the rest of its page
+    std::vector<uint8_t> sector(512, 2);
+    EXPECT_EQ(io->write(fd, sector.data(), sector.size(), 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+    iovec iov{sector.data(), sector.size()};
+    EXPECT_EQ(io->writev(fd, &iov, 1, db::UringIoBackend::ALIGNMENT), -1);
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_EQ(io->write(fd, pages.data(), db::UringIoBackend::ALIGNMENT, 512), -1);
+
+    std::vector<uint8_t> read(pages.size());
+    ASSERT_EQ(pread(fd, read.data(), read.size(), 0), static_cast<ssize_t>(read.size()));
+    EXPECT_EQ(read, pages);
+    close(fd);
+    std::remove("unaligned.dat");
+}
+
+TEST(BufferpoolTest, unalignedDirectReads) {
+    std::unique_ptr<db::UringIoBackend> io;
+    try {
+        io = std::make_unique<db::UringIoBackend>();
+    } catch (const std::runtime_error &) {
+        GTEST_SKIP() << "io_uring is not available";
+    }
+    std::vector<uint8_t> pages(2 * db::UringIoBackend::ALIGNMENT);
+    for (size_t i = 0; i < pages.size(); i++) {
+        pages[i] = static_cast<uint8_t>(i % 251);
+    }
+    {
+        std::ofstream out("unaligned_read.dat", std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(pages.data()), static_cast<std::streamsize>(pages.size()));
+    }
+    int fd = open("unaligned_read.dat", O_RDONLY | O_DIRECT);
+    if (fd == -1 && errno == EINVAL) {
+        fd = open("unaligned_read.dat", O_RDONLY);
+    }
+    ASSERT_NE(fd, -1);
+
+    // a range across the blocks, at an unaligned offset
+    size_t offset = db::UringIoBackend::ALIGNMENT - 100;
+    std::vector<uint8_t> read(300);
+    ASSERT_EQ(io->read(fd, read.data(), read.size(), static_cast<off_t>(offset)), 300);
+    EXPECT_TRUE(std::equal(read.begin(), read.end(), pages.begin() + static_cast<long>(offset)));
+    // a range running past the end of the file
+    ASSERT_EQ(io->read(fd, read.data(), read.size(), static_cast<off_t>(pages.size() - 100)), 100);
+    EXPECT_TRUE(std::equal(read.begin(), read.begin() + 100, pages.end() - 100));
+
+    std::vector<uint8_t> batched(300);
+    ssize_t result = 0;
+    std::vector<db::IoRequest> requests;
+    requests.push_back({batched.data(), batched.size(), 512, [&result](ssize_t n) { result = n; }});
+    io->readBatch(fd, requests);
+    EXPECT_EQ(result, 300);
+    EXPECT_TRUE(std::equal(batched.begin(), batched.end(), pages.begin() + 512));
+    close(fd);
+    std::remove("unaligned_read.dat");
+}
+
+TEST(BufferpoolTest, backgroundWriter) {
+    db::Database::reset();
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    db::Catalog &catalog = db::Database::getCatalog();
+    writeHeapFile("writer.dat", 20);
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    db::HeapFile file("writer.dat", td);
+    catalog.addTable(&file);
+
+    // dirty two runs of adjacent pages, each written with a single pwritev
+    db::TransactionId tid;
+    for (int i: {0, 1, 2, 3, 10, 11, 12}) {
+        db::HeapPageId pid(file.getId(), i);
+        auto *page = dynamic_cast<db::HeapPage *>(bufferpool.getPage(&pid));
+        db::Tuple tuple(td);
+        tuple.setField(0, new db::IntField(i));
+        tuple.setField(1, new db::IntField(i));
+        page->insertTuple(&tuple);
+        page->markDirty(tid);
+    }
+    EXPECT_EQ(bufferpool.countDirtyPages(), 7);
+
+    db::BackgroundWriter &writer = bufferpool.getBackgroundWriter();
+    writer.setInterval(1);
+    writer.setCleanTarget(1.0);
+    // pages are marked clean before they are written, wait for the writes themselves
+    for (int i = 0; i < 1000 && writer.getStats().pagesWritten < 7; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(writer.getStats().pagesWritten, 7);
+    EXPECT_EQ(bufferpool.countDirtyPages(), 0);
+    EXPECT_EQ(writer.getStats().evictionFlushes, 0);
+
+    for (int i = 0; i < 20; i++) {
+        db::HeapPageId pid(file.getId(), i);
+        bufferpool.discardPage(&pid);
+        auto *page = dynamic_cast<db::HeapPage *>(bufferpool.getPage(&pid));
+        bool written = i <= 3 || (i >= 10 && i <= 12);
+        EXPECT_EQ(page->getNumEmptySlots(), page->getNumTuples() - (written ? 2 : 1));
+    }
+}
+
+TEST(BufferpoolTest, mappedReads) {
+    db::Database::reset();
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    db::Catalog &catalog = db::Database::getCatalog();
+    writeHeapFile("mapped.dat", 20);
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    db::HeapFile file("mapped.dat", td, db::IoBackendType::MMAP);
+    catalog.addTable(&file);
+
+    int tuples = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        tuples++;
+    }
+    EXPECT_EQ(tuples, 20);
+
+    // writes use pwrite and are visible through the mapping
+    db::HeapPageId pid(file.getId(), 5);
+    auto *page = dynamic_cast<db::HeapPage *>(bufferpool.getPage(&pid));
+    db::Tuple tuple(td);
+    tuple.setField(0, new db::IntField(1));
+    tuple.setField(1, new db::IntField(2));
+    page->insertTuple(&tuple);
+    db::TransactionId tid;
+    page->markDirty(tid);
+    bufferpool.flushPage(&pid);
+    bufferpool.discardPage(&pid);
+    page = dynamic_cast<db::HeapPage *>(bufferpool.getPage(&pid));
+    EXPECT_EQ(page->getNumEmptySlots(), page->getNumTuples() - 2);
+}
+
+TEST(BufferpoolTest, stats) {
+    db::Database::reset();
+    db::Database::resetBufferPool(2);
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    db::Catalog &catalog = db::Database::getCatalog();
+    writeHeapFile("stats.dat", 4);
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    db::HeapFile file("stats.dat", td);
+    catalog.addTable(&file);
+
+    db::HeapPageId page0(file.getId(), 0);
+    db::HeapPageId page1(file.getId(), 1);
+    db::HeapPageId page2(file.getId(), 2);
+    db::TransactionId tid;
+    bufferpool.getPage(&page0)->markDirty(tid);
+    bufferpool.getPage(&page1);
+    bufferpool.getPage(&page0);
+    // counters of other threads are summed, including threads that exited
+    std::thread([&bufferpool, &page1] { bufferpool.getPage(&page1); }).join();
+    // evicts page0, the least recently used page with two accesses
+    bufferpool.getPage(&page2);
+
+    db::PageStats stats = bufferpool.getStats().getTableStats(file.getId());
+    EXPECT_EQ(stats.hits, 2);
+    EXPECT_EQ(stats.misses, 3);
+    EXPECT_EQ(stats.reads.count, 3);
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_EQ(stats.dirtyEvictions, 1);
+    EXPECT_EQ(stats.flushes, 1);
+    EXPECT_EQ(stats.writes.count, 1);
+    EXPECT_GE(stats.reads.percentileNs(0.99), stats.reads.percentileNs(0.5));
+
+    auto all = bufferpool.getStats().getStats();
+    ASSERT_EQ(all.size(), 1);
+    EXPECT_EQ(all.begin()->first.second, db::PageCategory::HEAP);
+    std::string json = bufferpool.getStats().toJson();
+    EXPECT_NE(json.find("\"type\":\"heap\""), std::string::npos);
+    EXPECT_NE(json.find("\"dirtyEvictions\":1"), std::string::npos);
+}
+
+TEST(BufferpoolTest, pinPage) {
+    db::Database::reset();
+    db::Database::resetBufferPool(2);
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    db::Catalog &catalog = db::Database::getCatalog();
+    writeHeapFile("pin.dat", 4);
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    db::HeapFile file("pin.dat", td);
+    catalog.addTable(&file);
+    db::HeapPageId page0(file.getId(), 0);
+    db::HeapPageId page1(file.getId(), 1);
+    db::HeapPageId page2(file.getId(), 2);
+    db::HeapPageId page3(file.getId(), 3);
+
+    db::PageGuard guard0 = bufferpool.fetchPage(&page0);
+    EXPECT_EQ(bufferpool.getPinCount(&page0), 1);
+    {
+        db::PageGuard copy = guard0;
+        EXPECT_EQ(copy.get(), guard0.get());
+        EXPECT_EQ(bufferpool.getPinCount(&page0), 2);
+    }
+    EXPECT_EQ(bufferpool.getPinCount(&page0), 1);
+
+    // page0 is the least recently used page but it is pinned, page1 is evicted instead
+    bufferpool.getPage(&page1);
+    bufferpool.getPage(&page2);
+    auto pages = bufferpool.getPages();
+    EXPECT_EQ(pages.count(&page0), 1);
+    EXPECT_EQ(pages.count(&page1), 0);
+    EXPECT_EQ(bufferpool.getPage(&page0), guard0.get());
+
+    // no frame can be evicted while every page is pinned
+    db::Page *pinned = bufferpool.pinPage(&page2);
+    EXPECT_THROW(bufferpool.getPage(&page3), std::runtime_error);
+    bufferpool.unpinPage(pinned);
+    EXPECT_EQ(bufferpool.getPinCount(&page2), 0);
+    EXPECT_THROW(bufferpool.unpinPage(pinned), std::runtime_error);
+    guard0.release();
+    EXPECT_EQ(bufferpool.getPinCount(&page0), 0);
+    EXPECT_NE(bufferpool.getPage(&page3), nullptr);
+}
+
+TEST(BufferpoolTest, dirtyPageIndex) {
+    db::Database::reset();
+    db::Database::resetBufferPool(1);
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    db::Catalog &catalog = db::Database::getCatalog();
+    db::SkeletonFile skeletonFile(1, db::Utility::getTupleDesc(2));
+    catalog.addTable(&skeletonFile);
+    db::SkeletonPageId page1(1, 0);
+    db::SkeletonPageId page2(1, 1);
+    db::TransactionId tid1;
+    db::TransactionId tid2;
+
+    bufferpool.getPage(&page1)->markDirty(tid1);
+    // page1 is written and its frame now holds a page of another transaction
+    bufferpool.getPage(&page2)->markDirty(tid2);
+    EXPECT_EQ(skeletonFile.writes, 1);
+    bufferpool.flushPages(tid1);
+    EXPECT_EQ(skeletonFile.writes, 1);
+    bufferpool.transactionComplete(tid2);
+    EXPECT_EQ(skeletonFile.writes, 2);
+    EXPECT_EQ(skeletonFile.syncs, 1);
+    // the eviction wrote the page of tid1, its commit still syncs the table
+    bufferpool.transactionComplete(tid1);
+    EXPECT_EQ(skeletonFile.writes, 2);
+    EXPECT_EQ(skeletonFile.syncs, 2);
+}
+
+TEST(BufferpoolTest, sectorWrites) {
+    db::Database::reset();
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    db::Catalog &catalog = db::Database::getCatalog();
+    writeHeapFile("sectors.dat", 2);
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    db::HeapFile file("sectors.dat", td);
+    catalog.addTable(&file);
+    file.setSectorWrites(true);
+
+    db::HeapPageId pid(file.getId(), 1);
+    auto *page = dynamic_cast<db::HeapPage *>(bufferpool.getPage(&pid));
+    // changed on disk behind the pool, in a sector the update does not touch
+    size_t pageSize = bufferpool.getPageSize();
+    {
+        std::fstream out("sectors.dat", std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(static_cast<std::streamoff>(2 * pageSize - 1));
+        out.put(7);
+    }
+    db::Tuple tuple(td);
+    tuple.setField(0, new db::IntField(1));
+    tuple.setField(1, new db::IntField(2));
+    page->insertTuple(&tuple);
+    db::TransactionId tid;
+    page->markDirty(tid);
+    bufferpool.flushPage(&pid);
+
+    std::ifstream in("sectors.dat", std::ios::binary);
+    std::vector<char> data(2 * pageSize);
+    in.read(data.data(), static_cast<std::streamsize>(data.size()));
+    EXPECT_EQ(data[pageSize], 3);
+    EXPECT_EQ(data[2 * pageSize - 1], 7);
+
+    // direct I/O only writes whole blocks, the whole page is written instead
+    writeHeapFile("direct_sectors.dat", 1);
+    db::HeapFile direct("direct_sectors.dat", td, db::IoBackendType::IO_URING);
+    catalog.addTable(&direct);
+    direct.setSectorWrites(true);
+    db::HeapPageId directPid(direct.getId(), 0);
+    page = dynamic_cast<db::HeapPage *>(bufferpool.getPage(&directPid));
+    db::Tuple other(td);
+    other.setField(0, new db::IntField(3));
+    other.setField(1, new db::IntField(4));
+    page->insertTuple(&other);
+    page->markDirty(tid);
+    bufferpool.flushPage(&directPid);
+    bufferpool.discardPage(&directPid);
+    page = dynamic_cast<db::HeapPage *>(bufferpool.getPage(&directPid));
+    EXPECT_EQ(page->getNumEmptySlots(), page->getNumTuples() - 2);
+}
+
+TEST(BufferpoolTest, freeSpaceMap) {
+    db::Database::reset();
+    db::Catalog &catalog = db::Database::getCatalog();
+    std::remove("fsm.dat.fsm");
+    {
+        // three full pages
+        std::ofstream out("fsm.dat", std::ios::binary | std::ios::trunc);
+        std::vector<char> data(db::Database::getBufferPool().getPageSize(), static_cast<char>(0xFF));
+        for (int i = 0; i < 3; i++) {
+            out.write(data.data(), data.size());
+        }
+    }
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    db::Tuple tuple(td);
+    tuple.setField(0, new db::IntField(1));
+    tuple.setField(1, new db::IntField(2));
+    {
+        db::HeapFile file("fsm.dat", td);
+        catalog.addTable(&file);
+        db::BufferPool &bufferpool = db::Database::getBufferPool();
+        // a new map has every page marked free, the full ones are found out once
+        db::TransactionId tid1;
+        bufferpool.insertTuple(tid1, file.getId(), &tuple);
+        EXPECT_EQ(file.getNumPages(), 4);
+        bufferpool.transactionComplete(tid1);
+        EXPECT_EQ(bufferpool.getStats().getTableStats(file.getId()).misses, 4);
+        db::TransactionId tid2;
+        bufferpool.insertTuple(tid2, file.getId(), &tuple);
+        bufferpool.transactionComplete(tid2);
+        EXPECT_EQ(bufferpool.getStats().getTableStats(file.getId()).misses, 4);
+    }
+
+    // the saved map is used when the file is opened again
+    db::Database::reset();
+    db::HeapFile file("fsm.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    db::TransactionId tid;
+    bufferpool.insertTuple(tid, file.getId(), &tuple);
+    bufferpool.transactionComplete(tid);
+    EXPECT_EQ(bufferpool.getStats().getTableStats(file.getId()).misses, 1);
+    EXPECT_EQ(file.getNumPages(), 4);
+    db::HeapPageId last(file.getId(), 3);
+    auto *page = dynamic_cast<db::HeapPage *>(bufferpool.getPage(&last));
+    EXPECT_EQ(page->getNumEmptySlots(), page->getNumTuples() - 3);
+}
+
+TEST(BufferpoolTest, decodeChurn) {
+    db::Database::reset();
+    db::BufferPool &bufferpool = db::Database::getBufferPool();
+    test::removeFile("churn.dat");
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    db::HeapFile file("churn.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    db::Tuple tuple(td);
+    tuple.setField(0, new db::IntField(1));
+    tuple.setField(1, new db::IntField(2));
+    db::TransactionId first;
+    bufferpool.insertTuple(first, file.getId(), &tuple);
+    bufferpool.transactionComplete(first);
+
+    // the row is decoded, deleted and inserted again into its slot, over and over
+    db::HeapPageId pid(file.getId(), 0);
+    for (int i = 0; i < 1000; i++) {
+        db::TransactionId tid;
+        db::Tuple row;
+        {
+            db::PageGuard guard = bufferpool.fetchPage(tid, &pid, db::Permissions::READ_WRITE);
+            row = *guard.as<db::HeapPage>()->begin();
+        }
+        bufferpool.deleteTuple(tid, &row);
+        bufferpool.insertTuple(tid, file.getId(), &tuple);
+        bufferpool.transactionComplete(tid);
+    }
+    db::PageGuard guard = bufferpool.fetchPage(&pid);
+    const auto *page = guard.as<db::HeapPage>();
+    EXPECT_EQ(page->getNumEmptySlots(), page->getNumTuples() - 1);
+    // what the readers of the overwritten slot decoded is freed once they unpinned the page
+    EXPECT_EQ(page->getNumRetired(), 0);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <db/BulkLoader.h>
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/IntField.h>
+#include <db/StringField.h>
+#include <db/Utility.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+/**
+ * Remove the heap file at fname and its free space map.
+ */
+static void removeHeapFile(const char *fname) {
+    std::remove(fname);
+    std::remove((std::string(fname) + ".fsm").c_str());
+}
+
+TEST(BulkLoaderTest, csv) {
+    db::Database::reset();
+    db::TupleDesc td = db::Utility::getTupleDesc(3);
+    removeHeapFile("bulk_csv.dat");
+    db::HeapFile file("bulk_csv.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    std::string csv;
+    long expected = 0;
+    for (int i = 0; i < 2000; i++) {
+        csv += std::to_string(i) + "," + std::to_string(2 * i) + "," + std::to_string(-i) + (i % 7 ? "\n" : "\r\n");
+        expected += i;
+    }
+    csv += "\n";
+
+    // small chunks, the rows of every chunk are packed into shared pages
+    db::BulkLoader loader(file, db::BulkFormat::CSV, 4);
+    loader.setChunkSize(1000);
+    db::BulkLoadStats stats = loader.load(reinterpret_cast<const uint8_t *>(csv.data()), csv.size());
+    EXPECT_EQ(stats.rows, 2000);
+    int numSlots = db::Database::getBufferPool().getPageSize() * 8 / (td.getSize() * 8 + 1);
+    EXPECT_EQ(stats.pages, (2000 + numSlots - 1) / numSlots);
+    EXPECT_EQ(file.getNumPages(), stats.pages);
+
+    long rows = 0;
+    long sum = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        int value = dynamic_cast<const db::IntField &>((*it).getField(0)).getValue();
+        EXPECT_EQ(dynamic_cast<const db::IntField &>((*it).getField(1)).getValue(), 2 * value);
+        EXPECT_EQ(dynamic_cast<const db::IntField &>((*it).getField(2)).getValue(), -value);
+        sum += value;
+        rows++;
+    }
+    EXPECT_EQ(rows, 2000);
+    EXPECT_EQ(sum, expected);
+
+    // the free space map knows the last page is the only one with room
+    db::Tuple tuple(td);
+    for (int i = 0; i < 3; i++) {
+        tuple.setField(i, new db::IntField(i));
+    }
+    db::TransactionId tid;
+    db::Database::getBufferPool().insertTuple(tid, file.getId(), &tuple);
+    db::Database::getBufferPool().transactionComplete(tid);
+    EXPECT_EQ(file.getNumPages(), stats.pages);
+}
+
+TEST(BulkLoaderTest, binary) {
+    db::Database::reset();
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE});
+    removeHeapFile("bulk_binary.dat");
+    db::HeapFile file("bulk_binary.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    std::vector<uint8_t> data(1000 * td.getSize());
+    for (int i = 0; i < 1000; i++) {
+        db::IntField(i).serialize(&data[i * td.getSize()]);
+        std::string value = "row" + std::to_string(i);
+        int len = static_cast<int>(value.size());
+        memcpy(&data[i * td.getSize() + 4], &len, sizeof(int));
+        memcpy(&data[i * td.getSize() + 8], value.data(), len);
+    }
+
+    db::BulkLoader loader(file, db::BulkFormat::BINARY, 2);
+    loader.setChunkSize(4096);
+    db::BulkLoadStats stats = loader.load(data.data(), data.size());
+    EXPECT_EQ(stats.rows, 1000);
+
+    int expected = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        EXPECT_EQ(dynamic_cast<const db::IntField &>((*it).getField(0)).getValue(), expected);
+        EXPECT_EQ(dynamic_cast<const db::StringField &>((*it).getField(1)).getValue(), "row" + std::to_string(expected));
+        expected++;
+    }
+    EXPECT_EQ(expected, 1000);
+
+    EXPECT_THROW(loader.load(data.data(), data.size() - 1), std::runtime_error);
+}
+
+TEST(BulkLoaderTest, malformed) {
+    db::Database::reset();
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    removeHeapFile("bulk_malformed.dat");
+    db::HeapFile file("bulk_malformed.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    db::BulkLoader loader(file, db::BulkFormat::CSV, 1);
+    for (std::string csv: {"1,2\n3\n", "1,2,3\n", "1,x\n"}) {
+        EXPECT_THROW(loader.load(reinterpret_cast<const uint8_t *>(csv.data()), csv.size()), std::runtime_error);
+    }
+}
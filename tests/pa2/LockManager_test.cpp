@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <db/LockManager.h>
+#include <db/HeapPageId.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(LockManagerTest, sharedLocks) {
+    db::LockManager lockManager;
+    db::HeapPageId pid(1, 0);
+    db::TransactionId tid1;
+    db::TransactionId tid2;
+    lockManager.acquire(tid1, pid, db::LockMode::SHARED);
+    lockManager.acquire(tid2, pid, db::LockMode::SHARED);
+    EXPECT_TRUE(lockManager.holdsLock(tid1, pid));
+    EXPECT_TRUE(lockManager.holdsLock(tid2, pid));
+    lockManager.releaseAll(tid1);
+    EXPECT_FALSE(lockManager.holdsLock(tid1, pid));
+    EXPECT_TRUE(lockManager.holdsLock(tid2, pid));
+}
+
+TEST(LockManagerTest, exclusiveLockBlocks) {
+    db::LockManager lockManager;
+    db::HeapPageId pid(1, 0);
+    db::TransactionId tid1;
+    db::TransactionId tid2;
+    lockManager.acquire(tid1, pid, db::LockMode::SHARED);
+
+    std::atomic<bool> granted = false;
+    std::thread writer([&] {
+        lockManager.acquire(tid2, pid, db::LockMode::EXCLUSIVE);
+        granted = true;
+    });
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(granted);
+    lockManager.releaseAll(tid1);
+    writer.join();
+    EXPECT_TRUE(granted);
+    EXPECT_TRUE(lockManager.holdsLock(tid2, pid));
+}
+
+TEST(LockManagerTest, upgrade) {
+    db::LockManager lockManager;
+    db::HeapPageId pid(1, 0);
+    db::TransactionId tid1;
+    db::TransactionId tid2;
+    lockManager.acquire(tid1, pid, db::LockMode::SHARED);
+    lockManager.acquire(tid1, pid, db::LockMode::EXCLUSIVE);
+
+    std::atomic<bool> granted = false;
+    std::thread reader([&] {
+        lockManager.acquire(tid2, pid, db::LockMode::SHARED);
+        granted = true;
+    });
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(granted);
+    lockManager.releaseAll(tid1);
+    reader.join();
+    EXPECT_TRUE(granted);
+}
+
+TEST(LockManagerTest, deadlock) {
+    db::LockManager lockManager;
+    db::HeapPageId pid1(1, 0);
+    db::HeapPageId pid2(1, 1);
+    db::TransactionId tid1;
+    db::TransactionId tid2;
+    lockManager.acquire(tid1, pid1, db::LockMode::EXCLUSIVE);
+    lockManager.acquire(tid2, pid2, db::LockMode::EXCLUSIVE);
+
+    std::thread t1([&] {
+        // blocks until tid2 is aborted and releases its locks
+        lockManager.acquire(tid1, pid2, db::LockMode::EXCLUSIVE);
+    });
+    std::this_thread::sleep_for(50ms);
+    EXPECT_THROW(lockManager.acquire(tid2, pid1, db::LockMode::EXCLUSIVE), db::TransactionAbortedException);
+    lockManager.releaseAll(tid2);
+    t1.join();
+    EXPECT_TRUE(lockManager.holdsLock(tid1, pid2));
+}
+
+TEST(LockManagerTest, tryAcquire) {
+    db::LockManager lockManager;
+    db::HeapPageId pid(1, 0);
+    db::TransactionId tid1;
+    db::TransactionId tid2;
+    lockManager.acquire(tid1, pid, db::LockMode::SHARED);
+    lockManager.acquire(tid2, pid, db::LockMode::SHARED);
+
+    // neither upgrade waits for the other, so neither is aborted
+    EXPECT_FALSE(lockManager.tryAcquire(tid1, pid, db::LockMode::EXCLUSIVE));
+    EXPECT_FALSE(lockManager.tryAcquire(tid2, pid, db::LockMode::EXCLUSIVE));
+    EXPECT_TRUE(lockManager.holdsLock(tid1, pid));
+    lockManager.releaseAll(tid2);
+    EXPECT_TRUE(lockManager.tryAcquire(tid1, pid, db::LockMode::EXCLUSIVE));
+    EXPECT_FALSE(lockManager.tryAcquire(tid2, pid, db::LockMode::SHARED));
+    EXPECT_FALSE(lockManager.holdsLock(tid2, pid));
+    lockManager.releaseAll(tid1);
+    EXPECT_TRUE(lockManager.tryAcquire(tid2, pid, db::LockMode::SHARED));
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/IntField.h>
+#include <db/Utility.h>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    /**
+     * An empty heap file registered in a fresh database, with a write-ahead log.
+     */
+    class LogManagerTest : public ::testing::Test {
+    protected:
+        db::TupleDesc td = db::Utility::getTupleDesc(2);
+        std::unique_ptr<db::HeapFile> file;
+
+        void SetUp() override {
+            db::Database::reset();
+            std::ofstream("wal.dat", std::ios::trunc);
+            std::remove("wal.log");
+            file = std::make_unique<db::HeapFile>("wal.dat", td);
+            db::Database::getCatalog().addTable(file.get());
+            db::Database::getBufferPool().openLog("wal.log");
+        }
+
+        void TearDown() override {
+            db::Database::reset();
+        }
+
+        void insert(const db::TransactionId &tid, int value) {
+            db::Tuple tuple(td);
+            tuple.setField(0, new db::IntField(value));
+            tuple.setField(1, new db::IntField(value));
+            db::Database::getBufferPool().insertTuple(tid, file->getId(), &tuple);
+        }
+
+        int count() {
+            int tuples = 0;
+            for (auto it = file->begin(); it != file->end(); ++it) {
+                tuples++;
+            }
+            return tuples;
+        }
+
+        /**
+         * Lose the buffer pool without writing its dirty pages, then recover from the log.
+         */
+        void crash() {
+            db::Database::resetBufferPool(db::BufferPool::DEFAULT_PAGES);
+            db::Database::getBufferPool().openLog("wal.log");
+        }
+    };
+}
+
+TEST_F(LogManagerTest, commitIsDurable) {
+    db::TransactionId tid;
+    for (int i = 0; i < 3; i++) {
+        insert(tid, i);
+    }
+    db::Database::getBufferPool().transactionComplete(tid);
+    // no-force: the page is still dirty, the commit only forced the log
+    EXPECT_EQ(db::Database::getBufferPool().countDirtyPages(), 1);
+    crash();
+    EXPECT_EQ(count(), 3);
+}
+
+TEST_F(LogManagerTest, losersAreUndone) {
+    db::TransactionId committed;
+    insert(committed, 1);
+    db::Database::getBufferPool().transactionComplete(committed);
+    db::TransactionId loser;
+    insert(loser, 2);
+    insert(loser, 3);
+    // steal: the uncommitted changes reach the file
+    db::Database::getBufferPool().flushAllPages();
+    crash();
+    EXPECT_EQ(count(), 1);
+    // recovery truncated the log, recovering again changes nothing
+    crash();
+    EXPECT_EQ(count(), 1);
+}
+
+TEST_F(LogManagerTest, abortRollsBack) {
+    db::TransactionId committed;
+    insert(committed, 1);
+    db::Database::getBufferPool().transactionComplete(committed);
+    db::TransactionId aborted;
+    insert(aborted, 2);
+    db::Database::getBufferPool().flushAllPages();
+    insert(aborted, 3);
+    // the committed insert only reached the file along with an aborted one, it must survive
+    db::Database::getBufferPool().transactionComplete(aborted, false);
+    EXPECT_EQ(count(), 1);
+    crash();
+    EXPECT_EQ(count(), 1);
+}
+
+TEST_F(LogManagerTest, groupCommit) {
+    constexpr int THREADS = 4;
+    std::vector<std::unique_ptr<db::HeapFile>> files;
+    for (int i = 0; i < THREADS; i++) {
+        std::string name = "wal" + std::to_string(i) + ".dat";
+        std::ofstream(name, std::ios::trunc);
+        files.push_back(std::make_unique<db::HeapFile>(name.c_str(), td));
+        db::Database::getCatalog().addTable(files.back().get());
+    }
+    db::LogManager *log = db::Database::getBufferPool().getLog();
+    // the first committer waits for the others, they all share its sync
+    log->setGroupCommit(std::chrono::seconds(1), THREADS);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; i++) {
+        threads.emplace_back([this, &files, i] {
+            db::TransactionId tid;
+            db::Tuple tuple(td);
+            tuple.setField(0, new db::IntField(i));
+            tuple.setField(1, new db::IntField(i));
+            db::Database::getBufferPool().insertTuple(tid, files[i]->getId(), &tuple);
+            db::Database::getBufferPool().transactionComplete(tid);
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    db::LogStats stats = log->getStats();
+    EXPECT_EQ(stats.commits, THREADS);
+    EXPECT_LT(stats.syncs, stats.commits);
+    crash();
+    for (const auto &heapFile: files) {
+        int tuples = 0;
+        for (auto it = heapFile->begin(); it != heapFile->end(); ++it) {
+            tuples++;
+        }
+        EXPECT_EQ(tuples, 1);
+    }
+}
+
+TEST_F(LogManagerTest, checkpoint) {
+    db::TransactionId committed;
+    insert(committed, 1);
+    db::Database::getBufferPool().transactionComplete(committed);
+    db::TransactionId loser;
+    insert(loser, 2);
+    db::Checkpointer &checkpointer = db::Database::getBufferPool().getCheckpointer();
+    ASSERT_TRUE(checkpointer.checkpoint());
+    EXPECT_EQ(db::Database::getBufferPool().countDirtyPages(), 0);
+    EXPECT_EQ(checkpointer.getStats().checkpoints, 1);
+    EXPECT_EQ(checkpointer.getStats().pagesWritten, 1);
+    // the checkpoint wrote the uncommitted insert, recovery still undoes it
+    crash();
+    EXPECT_EQ(count(), 1);
+
+    db::TransactionId before;
+    insert(before, 2);
+    db::Database::getBufferPool().transactionComplete(before);
+    ASSERT_TRUE(db::Database::getBufferPool().getCheckpointer().checkpoint());
+    db::TransactionId after;
+    insert(after, 3);
+    db::Database::getBufferPool().transactionComplete(after);
+    // the updates logged after the checkpoint are redone
+    crash();
+    EXPECT_EQ(count(), 3);
+}
+
+TEST_F(LogManagerTest, checkpointRecyclesLog) {
+    for (int i = 0; i < 100; i++) {
+        db::TransactionId tid;
+        insert(tid, i);
+        db::Database::getBufferPool().transactionComplete(tid);
+    }
+    db::TransactionId loser;
+    insert(loser, 100);
+    for (int i = 101; i < 200; i++) {
+        db::TransactionId tid;
+        insert(tid, i);
+        db::Database::getBufferPool().transactionComplete(tid);
+    }
+    ASSERT_TRUE(db::Database::getBufferPool().getCheckpointer().checkpoint());
+    // the records before the first one of the loser are not needed anymore
+    uint64_t recycled = db::Database::getBufferPool().getLog()->getStats().recycledLsn;
+    EXPECT_GT(recycled, 100 * db::Database::getBufferPool().getPageSize());
+
+    db::TransactionId after;
+    insert(after, 200);
+    db::Database::getBufferPool().transactionComplete(after);
+    // recovery starts at the checkpoint, undoes the loser and redoes the insert logged after
+    crash();
+    std::set<int> keys;
+    for (auto it = file->begin(); it != file->end(); ++it) {
+        keys.insert(dynamic_cast<const db::IntField &>((*it).getField(0)).getValue());
+    }
+    EXPECT_EQ(keys.size(), 200);
+    EXPECT_EQ(keys.count(100), 0);
+    EXPECT_EQ(keys.count(200), 1);
+    // the log started over
+    EXPECT_LT(db::Database::getBufferPool().getLog()->getStats().recycledLsn, recycled);
+}
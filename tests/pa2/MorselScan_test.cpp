@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/IntField.h>
+#include <db/MorselSplitter.h>
+#include <db/SeqScan.h>
+#include <db/Utility.h>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+#include "TestUtility.h"
+
+namespace {
+    int getKey(const db::Tuple &tuple) {
+        return dynamic_cast<const db::IntField &>(tuple.getField(0)).getValue();
+    }
+
+    /**
+     * Set the fields of row i to (i, i).
+     */
+    void setRow(db::Tuple &tuple, int i) {
+        tuple.setField(0, new db::IntField(i));
+        tuple.setField(1, new db::IntField(i));
+    }
+}
+
+TEST(MorselScanTest, pageRange) {
+    db::Database::reset();
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    test::removeFile("morsel.dat");
+    db::HeapFile file("morsel.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    int slotsPerPage = db::Database::getBufferPool().getPageSize() * 8 / (td.getSize() * 8 + 1);
+    test::insertRows(file.getId(), 0, 5 * slotsPerPage, setRow);
+    ASSERT_EQ(file.getNumPages(), 5);
+
+    std::vector<int> keys;
+    for (db::Tuple &tuple: file.scan(1, 3)) {
+        keys.push_back(getKey(tuple));
+    }
+    ASSERT_EQ(keys.size(), 2 * slotsPerPage);
+    EXPECT_EQ(keys.front(), slotsPerPage);
+    EXPECT_EQ(keys.back(), 3 * slotsPerPage - 1);
+
+    // empty ranges, and ranges past the end of the file
+    EXPECT_FALSE(file.scan(2, 2).begin() != file.scan(2, 2).end());
+    EXPECT_FALSE(file.scan(7, 9).begin() != file.scan(7, 9).end());
+    keys.clear();
+    for (db::Tuple &tuple: file.scan(4, 100)) {
+        keys.push_back(getKey(tuple));
+    }
+    EXPECT_EQ(keys.size(), slotsPerPage);
+}
+
+TEST(MorselScanTest, skipsEmptyPages) {
+    db::Database::reset();
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    test::removeFile("morsel_empty.dat");
+    db::HeapFile file("morsel_empty.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    int slotsPerPage = db::Database::getBufferPool().getPageSize() * 8 / (td.getSize() * 8 + 1);
+    test::insertRows(file.getId(), 0, 3 * slotsPerPage, setRow);
+
+    // empty the first two pages
+    db::BufferPool &bufferPool = db::Database::getBufferPool();
+    db::TransactionId tid;
+    for (int pgNo = 0; pgNo < 2; pgNo++) {
+        db::HeapPageId pid(file.getId(), pgNo);
+        auto *page = dynamic_cast<db::HeapPage *>(bufferPool.getPage(tid, &pid, db::Permissions::READ_WRITE));
+        std::vector<db::Tuple> tuples;
+        for (auto it = page->begin(); it != page->end(); ++it) {
+            tuples.push_back(*it);
+        }
+        for (db::Tuple &tuple: tuples) {
+            bufferPool.deleteTuple(tid, &tuple);
+        }
+    }
+    bufferPool.transactionComplete(tid);
+
+    int count = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        EXPECT_GE(getKey(*it), 2 * slotsPerPage);
+        count++;
+    }
+    EXPECT_EQ(count, slotsPerPage);
+}
+
+TEST(MorselScanTest, splitter) {
+    db::MorselSplitter splitter(10, 4);
+    std::vector<std::pair<int, int>> morsels;
+    while (auto morsel = splitter.next()) {
+        morsels.emplace_back(morsel->pageLo, morsel->pageHi);
+    }
+    EXPECT_EQ(morsels, (std::vector<std::pair<int, int>>{{0, 4}, {4, 8}, {8, 10}}));
+    EXPECT_FALSE(splitter.next());
+    EXPECT_FALSE(db::MorselSplitter(0).next());
+}
+
+TEST(MorselScanTest, parallelSeqScans) {
+    db::Database::reset();
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    test::removeFile("morsel_parallel.dat");
+    db::HeapFile file("morsel_parallel.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    constexpr int ROWS = 20000;
+    test::insertRows(file.getId(), 0, ROWS, setRow);
+
+    // every worker scans the morsels it takes, together they return each row once
+    db::MorselSplitter splitter(file.getNumPages(), 3);
+    std::vector<std::vector<int>> keys(4);
+    std::vector<std::thread> workers;
+    for (auto &workerKeys: keys) {
+        workers.emplace_back([&] {
+            std::vector<db::Morsel> taken;
+            while (auto morsel = splitter.next()) {
+                taken.push_back(*morsel);
+            }
+            db::SeqScan seqScan(file.getId(), "t", taken);
+            seqScan.open();
+            while (seqScan.hasNext()) {
+                workerKeys.push_back(getKey(seqScan.next()));
+            }
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    std::multiset<int> all;
+    for (const auto &workerKeys: keys) {
+        all.insert(workerKeys.begin(), workerKeys.end());
+    }
+    ASSERT_EQ(all.size(), ROWS);
+    EXPECT_EQ(std::set<int>(all.begin(), all.end()).size(), ROWS);
+
+    // morsels in any order, rewind replays them
+    db::SeqScan seqScan(file.getId(), "t", {{2, 3}, {0, 1}});
+    seqScan.open();
+    std::vector<int> first;
+    while (seqScan.hasNext()) {
+        first.push_back(getKey(seqScan.next()));
+    }
+    seqScan.rewind();
+    std::vector<int> second;
+    while (seqScan.hasNext()) {
+        second.push_back(getKey(seqScan.next()));
+    }
+    EXPECT_EQ(first, second);
+    int slotsPerPage = db::Database::getBufferPool().getPageSize() * 8 / (td.getSize() * 8 + 1);
+    ASSERT_EQ(first.size(), 2 * slotsPerPage);
+    EXPECT_EQ(first.front(), 2 * slotsPerPage);
+    EXPECT_EQ(first.back(), slotsPerPage - 1);
+}
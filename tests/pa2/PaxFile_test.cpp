@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <db/Database.h>
+#include <db/HeapPage.h>
+#include <db/IntField.h>
+#include <db/PaxFile.h>
+#include <db/SeqScan.h>
+#include <db/StringField.h>
+#include <map>
+#include <string>
+#include "TestUtility.h"
+
+/**
+ * Set the fields of row i to (i, "row" + i, -i).
+ */
+static void setRow(db::Tuple &tuple, int i) {
+    tuple.setField(0, new db::IntField(i));
+    tuple.setField(1, new db::StringField(("row" + std::to_string(i)).c_str()));
+    tuple.setField(2, new db::IntField(-i));
+}
+
+TEST(PaxFileTest, insertAndScan) {
+    db::Database::reset();
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE, db::Types::INT_TYPE});
+    test::removeFile("pax_scan.dat");
+    db::PaxFile file("pax_scan.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    test::insertRows(file.getId(), 0, 500, setRow);
+
+    // as many tuples per page as a HeapPage, give or take the padding of the header
+    int heapSlots = db::Database::getBufferPool().getPageSize() * 8 / (td.getSize() * 8 + 1);
+    EXPECT_LE(file.getNumPages(), (500 + heapSlots - 2) / (heapSlots - 1));
+
+    std::map<int, std::string> rows;
+    db::SeqScan scan(file.getId());
+    scan.open();
+    while (scan.hasNext()) {
+        db::Tuple tuple = scan.next();
+        int key = dynamic_cast<const db::IntField &>(tuple.getField(0)).getValue();
+        EXPECT_EQ(dynamic_cast<const db::IntField &>(tuple.getField(2)).getValue(), -key);
+        rows[key] = dynamic_cast<const db::StringField &>(tuple.getField(1)).getValue();
+    }
+    ASSERT_EQ(rows.size(), 500);
+    for (int i = 0; i < 500; i++) {
+        EXPECT_EQ(rows[i], "row" + std::to_string(i));
+    }
+}
+
+TEST(PaxFileTest, columns) {
+    db::Database::reset();
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE, db::Types::INT_TYPE});
+    test::removeFile("pax_columns.dat");
+    db::PaxFile file("pax_columns.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    test::insertRows(file.getId(), 0, 20, setRow);
+
+    db::TransactionId tid;
+    db::HeapPageId pid(file.getId(), 0);
+    auto *page = dynamic_cast<db::PaxPage *>(db::Database::getBufferPool().getPage(tid, &pid,
+                                                                                   db::Permissions::READ_WRITE));
+    std::vector<db::Tuple> odd;
+    for (const db::Tuple &tuple: *page) {
+        int slot = tuple.getRecordId()->getTupleno();
+        EXPECT_EQ(page->getInt(slot, 0), dynamic_cast<const db::IntField &>(tuple.getField(0)).getValue());
+        EXPECT_EQ(page->getString(slot, 1), "row" + std::to_string(page->getInt(slot, 0)));
+        if (page->getInt(slot, 0) % 2) {
+            odd.push_back(tuple);
+        }
+    }
+    for (db::Tuple &tuple: odd) {
+        for (db::PageGuard &dirty: file.deleteTuple(tid, tuple)) {
+            dirty->markDirty(tid);
+        }
+    }
+
+    // the empty slots of a minipage are 0, an aggregate can run over all of them
+    const int *keys = page->getIntColumn(0);
+    const int *negated = page->getIntColumn(2);
+    long sum = 0;
+    long negatedSum = 0;
+    for (int slot = 0; slot < page->getNumSlots(); slot++) {
+        sum += keys[slot];
+        negatedSum += negated[slot];
+    }
+    EXPECT_EQ(sum, 90);
+    EXPECT_EQ(negatedSum, -90);
+    EXPECT_EQ(page->getNumEmptySlots(), page->getNumSlots() - 10);
+    db::Database::getBufferPool().transactionComplete(tid);
+
+    // the deleted slots are reused
+    test::insertRows(file.getId(), 20, 30, setRow);
+    EXPECT_EQ(file.getNumPages(), 1);
+}
+
+TEST(PaxFileTest, appendDuringScan) {
+    db::Database::reset();
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE, db::Types::INT_TYPE});
+    test::removeFile("pax_append.dat");
+    db::PaxFile file("pax_append.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    test::insertRows(file.getId(), 0, 500, setRow);
+    int numPages = file.getNumPages();
+
+    // INSERT INTO t SELECT * FROM t: the pages appended meanwhile are past the end of the scan
+    db::BufferPool &bufferPool = db::Database::getBufferPool();
+    db::SeqScan scan(file.getId());
+    scan.open();
+    db::TransactionId tid;
+    int rows = 0;
+    while (scan.hasNext()) {
+        scan.next();
+        db::Tuple tuple(td);
+        setRow(tuple, 500 + rows++);
+        bufferPool.insertTuple(tid, file.getId(), &tuple);
+    }
+    bufferPool.transactionComplete(tid);
+    EXPECT_GT(file.getNumPages(), numPages);
+    EXPECT_GE(rows, 500);
+    EXPECT_LT(rows, 2 * 500);
+    EXPECT_FALSE(scan.hasNext());
+}
+
+TEST(PaxFileTest, persistence) {
+    db::Database::reset();
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE, db::Types::INT_TYPE});
+    test::removeFile("pax_persist.dat");
+    {
+        db::PaxFile file("pax_persist.dat", td);
+        db::Database::getCatalog().addTable(&file);
+        test::insertRows(file.getId(), 0, 200, setRow);
+        db::Database::getBufferPool().flushAllPages();
+        db::Database::reset();
+    }
+    db::PaxFile file("pax_persist.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    long sum = 0;
+    int rows = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        sum += dynamic_cast<const db::IntField &>((*it).getField(0)).getValue();
+        rows++;
+    }
+    EXPECT_EQ(rows, 200);
+    EXPECT_EQ(sum, 199 * 200 / 2);
+}
+
+TEST(PaxFileTest, dictionary) {
+    db::Database::reset();
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE, db::Types::INT_TYPE});
+    test::removeFile("pax_dictionary.dat");
+    const char *countries[] = {"France", "Peru", "Japan"};
+    {
+        db::PaxFile file("pax_dictionary.dat", td, db::StringEncoding::DICTIONARY);
+        db::Database::getCatalog().addTable(&file);
+        db::TransactionId tid;
+        for (int i = 0; i < 1000; i++) {
+            db::Tuple tuple(td);
+            tuple.setField(0, new db::IntField(i));
+            tuple.setField(1, new db::StringField(countries[i % 3]));
+            tuple.setField(2, new db::IntField(-i));
+            db::Database::getBufferPool().insertTuple(tid, file.getId(), &tuple);
+        }
+        db::Database::getBufferPool().transactionComplete(tid);
+        // a string takes a code, the tuples are as narrow as three ints
+        int encodedSlots = db::Database::getBufferPool().getPageSize() * 8 / (3 * sizeof(int) * 8 + 1) - 1;
+        EXPECT_LE(file.getNumPages(), (1000 + encodedSlots - 1) / encodedSlots);
+        EXPECT_EQ(file.getDictionary()->size(), 3);
+        db::Database::getBufferPool().flushAllPages();
+        db::Database::reset();
+    }
+    db::PaxFile file("pax_dictionary.dat", td, db::StringEncoding::DICTIONARY);
+    db::Database::getCatalog().addTable(&file);
+
+    // an equality filter on the codes, without decoding
+    int peru = file.getDictionary()->find("Peru").value();
+    int matches = 0;
+    for (int p = 0; p < file.getNumPages(); p++) {
+        db::HeapPageId pid(file.getId(), p);
+        db::PageGuard guard = db::Database::getBufferPool().fetchPage(&pid);
+        const auto *page = guard.as<db::PaxPage>();
+        const int *codes = page->getCodeColumn(1);
+        for (int slot = 0; slot < page->getNumSlots(); slot++) {
+            if (codes[slot] == peru) {
+                EXPECT_EQ(page->getInt(slot, 0) % 3, 1);
+                EXPECT_EQ(page->getString(slot, 1), "Peru");
+                matches++;
+            }
+        }
+    }
+    EXPECT_EQ(matches, 333);
+
+    // tuples are decoded with their strings
+    int rows = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        int key = dynamic_cast<const db::IntField &>((*it).getField(0)).getValue();
+        EXPECT_EQ(dynamic_cast<const db::StringField &>((*it).getField(1)).getValue(), countries[key % 3]);
+        rows++;
+    }
+    EXPECT_EQ(rows, 1000);
+}
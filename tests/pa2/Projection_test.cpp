@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/IntField.h>
+#include <db/SeqScan.h>
+#include <db/SlottedFile.h>
+#include <db/Utility.h>
+#include <string>
+#include <vector>
+#include "TestUtility.h"
+
+namespace {
+    constexpr int FIELDS = 5;
+
+    int getInt(const db::Tuple &tuple, int i) {
+        return dynamic_cast<const db::IntField &>(tuple.getField(i)).getValue();
+    }
+
+    /**
+     * Set field i of the row of key to 10 * key + i.
+     */
+    void setRow(db::Tuple &tuple, int key) {
+        for (int i = 0; i < FIELDS; i++) {
+            tuple.setField(i, new db::IntField(10 * key + i));
+        }
+    }
+
+    /**
+     * @return the rows returned by a scan projecting columns
+     */
+    std::vector<std::vector<int>> scan(int tableId, const std::vector<int> &columns) {
+        db::SeqScan seqScan(tableId);
+        seqScan.setProjection(columns);
+        EXPECT_EQ(seqScan.getTupleDesc().numFields(), columns.size());
+        std::vector<std::vector<int>> rows;
+        seqScan.open();
+        while (seqScan.hasNext()) {
+            db::Tuple tuple = seqScan.next();
+            EXPECT_EQ(tuple.getTupleDesc(), seqScan.getTupleDesc());
+            std::vector<int> row;
+            for (size_t i = 0; i < columns.size(); i++) {
+                row.push_back(getInt(tuple, static_cast<int>(i)));
+            }
+            rows.push_back(row);
+        }
+        return rows;
+    }
+}
+
+TEST(ProjectionTest, heapFile) {
+    db::Database::reset();
+    db::TupleDesc td = db::Utility::getTupleDesc(FIELDS, "f");
+    test::removeFile("projection.dat");
+    db::HeapFile file("projection.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    test::insertRows(file.getId(), 0, 2000, setRow);
+
+    std::vector<std::vector<int>> rows = scan(file.getId(), {3, 0});
+    ASSERT_EQ(rows.size(), 2000);
+    for (const auto &row: rows) {
+        EXPECT_EQ(row[0], row[1] + 3);
+        EXPECT_EQ(row[1] % 10, 0);
+    }
+    db::SeqScan seqScan(file.getId());
+    seqScan.setProjection({4, 1});
+    EXPECT_EQ(seqScan.getTupleDesc().getFieldName(0), td.getFieldName(4));
+    EXPECT_EQ(seqScan.getTupleDesc().getFieldType(1), db::Types::INT_TYPE);
+    EXPECT_THROW(seqScan.setProjection({FIELDS}), std::runtime_error);
+    EXPECT_THROW(seqScan.setProjection({}), std::runtime_error);
+
+    // a full scan after a projected one decodes the other fields
+    db::SeqScan full(file.getId());
+    full.open();
+    int count = 0;
+    while (full.hasNext()) {
+        db::Tuple tuple = full.next();
+        for (int i = 1; i < FIELDS; i++) {
+            EXPECT_EQ(getInt(tuple, i), getInt(tuple, 0) + i);
+        }
+        count++;
+    }
+    EXPECT_EQ(count, 2000);
+}
+
+TEST(ProjectionTest, reusedSlot) {
+    db::Database::reset();
+    db::TupleDesc td = db::Utility::getTupleDesc(FIELDS, "f");
+    test::removeFile("projection_reused.dat");
+    db::HeapFile file("projection_reused.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    test::insertRows(file.getId(), 0, 1, setRow);
+    ASSERT_EQ(scan(file.getId(), {2}), (std::vector<std::vector<int>>{{2}}));
+
+    // the fields decoded from a slot are not returned for the tuple inserted in its place
+    db::SeqScan seqScan(file.getId());
+    seqScan.open();
+    db::Tuple tuple = seqScan.next();
+    seqScan.close();
+    db::TransactionId tid;
+    db::Database::getBufferPool().deleteTuple(tid, &tuple);
+    db::Database::getBufferPool().transactionComplete(tid);
+    test::insertRows(file.getId(), 7, 8, setRow);
+    EXPECT_EQ(scan(file.getId(), {2, 0}), (std::vector<std::vector<int>>{{72, 70}}));
+}
+
+TEST(ProjectionTest, slottedFile) {
+    db::Database::reset();
+    db::TupleDesc td = db::Utility::getTupleDesc(FIELDS, "f");
+    test::removeFile("projection_slotted.dat");
+    db::SlottedFile file("projection_slotted.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    test::insertRows(file.getId(), 0, 100, setRow);
+    std::vector<std::vector<int>> rows = scan(file.getId(), {1});
+    ASSERT_EQ(rows.size(), 100);
+    EXPECT_EQ(rows[0][0] % 10, 1);
+}
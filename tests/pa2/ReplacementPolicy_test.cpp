@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <db/ReplacementPolicy.h>
+#include <db/Database.h>
+#include <db/SkeletonFile.h>
+#include <db/Utility.h>
+
+TEST(ReplacementPolicyTest, clock) {
+    db::ClockPolicy policy(3);
+    for (size_t i = 0; i < 3; i++) {
+        policy.recordAccess(i);
+        policy.setEvictable(i, true);
+    }
+    // every frame gets a second chance, then the hand starts over at frame 0
+    EXPECT_EQ(policy.evict(), 0);
+    policy.recordAccess(1);
+    EXPECT_EQ(policy.evict(), 2);
+    EXPECT_EQ(policy.evict(), 1);
+    EXPECT_EQ(policy.evict(), std::nullopt);
+}
+
+TEST(ReplacementPolicyTest, lruK) {
+    db::LRUKPolicy policy(3, 2);
+    for (size_t i = 0; i < 3; i++) {
+        policy.recordAccess(i);
+        policy.setEvictable(i, true);
+    }
+    policy.recordAccess(0);
+    policy.recordAccess(2);
+    // frame 1 was referenced only once, so its backward 2-distance is infinite
+    EXPECT_EQ(policy.evict(), 1);
+    // frame 0 has the oldest second most recent reference
+    EXPECT_EQ(policy.evict(), 0);
+    policy.setEvictable(2, false);
+    EXPECT_EQ(policy.evict(), std::nullopt);
+}
+
+TEST(ReplacementPolicyTest, twoQ) {
+    db::TwoQPolicy policy(8);
+    for (size_t i = 0; i < 8; i++) {
+        policy.recordAccess(i);
+        policy.setEvictable(i, true);
+    }
+    // frames 0 and 1 are referenced again and promoted out of the FIFO queue
+    policy.recordAccess(0);
+    policy.recordAccess(1);
+    for (size_t expected = 2; expected < 6; expected++) {
+        EXPECT_EQ(policy.evict(), expected);
+    }
+    // the FIFO queue is back to a quarter of the frames
+    EXPECT_EQ(policy.evict(), 0);
+    EXPECT_EQ(policy.evict(), 1);
+    EXPECT_EQ(policy.evict(), 6);
+    EXPECT_EQ(policy.evict(), 7);
+}
+
+TEST(ReplacementPolicyTest, scanResistance) {
+    for (auto type: {db::ReplacementPolicyType::LRU_K, db::ReplacementPolicyType::TWO_Q}) {
+        db::Database::reset();
+        db::Database::resetBufferPool(8, type);
+        db::BufferPool &bufferpool = db::Database::getBufferPool();
+        db::SkeletonFile skeletonFile(1, db::Utility::getTupleDesc(2));
+        db::Database::getCatalog().addTable(&skeletonFile);
+
+        std::vector<db::SkeletonPageId> ids;
+        for (int i = 0; i < 64; i++) {
+            ids.emplace_back(1, i);
+        }
+        // page 0 is hot, the other pages are touched once by a scan
+        bufferpool.getPage(&ids[0]);
+        bufferpool.getPage(&ids[0]);
+        for (int i = 1; i < 64; i++) {
+            bufferpool.getPage(&ids[i]);
+        }
+        EXPECT_EQ(bufferpool.getPages().count(&ids[0]), 1);
+    }
+}
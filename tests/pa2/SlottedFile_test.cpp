@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include <db/Database.h>
+#include <db/HeapPage.h>
+#include <db/IntField.h>
+#include <db/SeqScan.h>
+#include <db/SlottedFile.h>
+#include <db/StringField.h>
+#include <map>
+#include <string>
+#include "TestUtility.h"
+
+/**
+ * Set the fields of row i to (i, "row" + i).
+ */
+static void setRow(db::Tuple &tuple, int i) {
+    tuple.setField(0, new db::IntField(i));
+    tuple.setField(1, new db::StringField(("row" + std::to_string(i)).c_str()));
+}
+
+/**
+ * @return the rows of the table by key, read with a SeqScan
+ */
+static std::map<int, std::string> scanRows(int tableId) {
+    std::map<int, std::string> rows;
+    db::SeqScan scan(tableId);
+    scan.open();
+    while (scan.hasNext()) {
+        db::Tuple tuple = scan.next();
+        int key = dynamic_cast<const db::IntField &>(tuple.getField(0)).getValue();
+        EXPECT_EQ(rows.count(key), 0);
+        rows[key] = dynamic_cast<const db::StringField &>(tuple.getField(1)).getValue();
+    }
+    scan.close();
+    return rows;
+}
+
+TEST(SlottedFileTest, insertAndScan) {
+    db::Database::reset();
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE});
+    test::removeFile("slotted_scan.dat");
+    db::SlottedFile file("slotted_scan.dat", td);
+    db::Database::getCatalog().addTable(&file);
+
+    test::insertRows(file.getId(), 0, 1000, setRow);
+    std::map<int, std::string> rows = scanRows(file.getId());
+    ASSERT_EQ(rows.size(), 1000);
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(rows[i], "row" + std::to_string(i));
+    }
+
+    // short strings take their length, a HeapPage reserves STRING_LEN bytes for each
+    int heapSlots = db::Database::getBufferPool().getPageSize() * 8 / (td.getSize() * 8 + 1);
+    int heapPages = (1000 + heapSlots - 1) / heapSlots;
+    EXPECT_LT(file.getNumPages() * 4, heapPages);
+}
+
+TEST(SlottedFileTest, deleteCompacts) {
+    db::Database::reset();
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE});
+    test::removeFile("slotted_delete.dat");
+    db::SlottedFile file("slotted_delete.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    test::insertRows(file.getId(), 0, 200, setRow);
+    ASSERT_EQ(file.getNumPages(), 1);
+
+    db::TransactionId tid;
+    db::HeapPageId pid(file.getId(), 0);
+    auto *page = dynamic_cast<db::SlottedPage *>(db::Database::getBufferPool().getPage(tid, &pid,
+                                                                                       db::Permissions::READ_WRITE));
+    size_t freeSpace = page->getFreeSpace();
+    std::vector<db::Tuple> deleted;
+    size_t freed = 0;
+    for (const db::Tuple &tuple: *page) {
+        if (dynamic_cast<const db::IntField &>(tuple.getField(0)).getValue() % 2 == 0) {
+            deleted.push_back(tuple);
+            // the slot of a record stays in the directory
+            freed += db::SlottedPage::getRecordSize(td, tuple) - 2 * sizeof(uint16_t);
+        }
+    }
+    for (db::Tuple &tuple: deleted) {
+        for (db::PageGuard &dirty: file.deleteTuple(tid, tuple)) {
+            dirty->markDirty(tid);
+        }
+    }
+    EXPECT_EQ(page->getNumTuples(), 100);
+    // the records were moved together, every freed byte is available at once
+    EXPECT_GE(page->getFreeSpace(), freeSpace + freed);
+    db::Database::getBufferPool().transactionComplete(tid);
+
+    std::map<int, std::string> rows = scanRows(file.getId());
+    ASSERT_EQ(rows.size(), 100);
+    for (int i = 1; i < 200; i += 2) {
+        EXPECT_EQ(rows[i], "row" + std::to_string(i));
+    }
+
+    // the freed slots and bytes are reused
+    test::insertRows(file.getId(), 200, 300, setRow);
+    EXPECT_EQ(file.getNumPages(), 1);
+    EXPECT_EQ(scanRows(file.getId()).size(), 200);
+}
+
+TEST(SlottedFileTest, appendDuringScan) {
+    db::Database::reset();
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE});
+    test::removeFile("slotted_append.dat");
+    db::SlottedFile file("slotted_append.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    test::insertRows(file.getId(), 0, 1000, setRow);
+    int numPages = file.getNumPages();
+
+    // INSERT INTO t SELECT * FROM t: the pages appended meanwhile are past the end of the scan
+    db::BufferPool &bufferPool = db::Database::getBufferPool();
+    db::SeqScan scan(file.getId());
+    scan.open();
+    db::TransactionId tid;
+    int rows = 0;
+    while (scan.hasNext()) {
+        scan.next();
+        db::Tuple tuple(td);
+        setRow(tuple, 1000 + rows++);
+        bufferPool.insertTuple(tid, file.getId(), &tuple);
+    }
+    bufferPool.transactionComplete(tid);
+    EXPECT_GT(file.getNumPages(), numPages);
+    EXPECT_GE(rows, 1000);
+    EXPECT_LT(rows, 2 * 1000);
+    EXPECT_FALSE(scan.hasNext());
+}
+
+TEST(SlottedFileTest, decodeChurn) {
+    db::Database::reset();
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE});
+    test::removeFile("slotted_churn.dat");
+    db::SlottedFile file("slotted_churn.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    test::insertRows(file.getId(), 0, 50, setRow);
+    ASSERT_EQ(file.getNumPages(), 1);
+
+    // the rows are decoded, then the last ones are deleted, shrinking the directory, and
+    // inserted again, growing it back, over and over
+    db::BufferPool &bufferPool = db::Database::getBufferPool();
+    db::HeapPageId pid(file.getId(), 0);
+    for (int i = 0; i < 200; i++) {
+        db::TransactionId tid;
+        std::vector<db::Tuple> rows;
+        {
+            db::PageGuard guard = bufferPool.fetchPage(tid, &pid, db::Permissions::READ_WRITE);
+            for (const db::Tuple &tuple: *guard.as<db::SlottedPage>()) {
+                rows.push_back(tuple);
+            }
+        }
+        ASSERT_EQ(rows.size(), 50);
+        for (auto row = rows.begin() + 40; row != rows.end(); ++row) {
+            bufferPool.deleteTuple(tid, &*row);
+        }
+        for (int key = 40; key < 50; key++) {
+            db::Tuple tuple(td);
+            setRow(tuple, key);
+            bufferPool.insertTuple(tid, file.getId(), &tuple);
+        }
+        bufferPool.transactionComplete(tid);
+    }
+    db::PageGuard guard = bufferPool.fetchPage(&pid);
+    const auto *page = guard.as<db::SlottedPage>();
+    EXPECT_EQ(page->getNumTuples(), 50);
+    EXPECT_EQ(page->end().getSlot(), 50);
+    // what the readers of the deleted slots decoded is freed once they unpinned the page
+    EXPECT_EQ(page->getNumRetired(), 0);
+    std::map<int, std::string> rows = scanRows(file.getId());
+    ASSERT_EQ(rows.size(), 50);
+    for (int i = 0; i < 50; i++) {
+        EXPECT_EQ(rows[i], "row" + std::to_string(i));
+    }
+}
+
+TEST(SlottedFileTest, persistence) {
+    db::Database::reset();
+    db::TupleDesc td({db::Types::INT_TYPE, db::Types::STRING_TYPE});
+    test::removeFile("slotted_persist.dat");
+    {
+        db::SlottedFile file("slotted_persist.dat", td);
+        db::Database::getCatalog().addTable(&file);
+        test::insertRows(file.getId(), 0, 2000, setRow);
+        db::Database::getBufferPool().flushAllPages();
+        db::Database::reset();
+    }
+    db::SlottedFile file("slotted_persist.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    EXPECT_GT(file.getNumPages(), 1);
+    std::map<int, std::string> rows = scanRows(file.getId());
+    ASSERT_EQ(rows.size(), 2000);
+    EXPECT_EQ(rows[0], "row0");
+    EXPECT_EQ(rows[1999], "row1999");
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <db/StringDictionary.h>
+#include <db/Type.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+TEST(StringDictionaryTest, encode) {
+    std::remove("dictionary_encode.dict");
+    db::StringDictionary dictionary("dictionary_encode.dict");
+    EXPECT_EQ(dictionary.size(), 0);
+    EXPECT_EQ(dictionary.find("France"), std::nullopt);
+    int france = dictionary.encode("France");
+    int peru = dictionary.encode("Peru");
+    EXPECT_EQ(france, 1);
+    EXPECT_EQ(peru, 2);
+    EXPECT_EQ(dictionary.encode("France"), france);
+    EXPECT_EQ(dictionary.find("Peru"), peru);
+    EXPECT_EQ(dictionary.decode(france), "France");
+    EXPECT_EQ(dictionary.encode(""), 3);
+    EXPECT_EQ(dictionary.decode(3), "");
+    EXPECT_EQ(dictionary.size(), 3);
+    EXPECT_THROW(dictionary.decode(0), std::runtime_error);
+    EXPECT_THROW(dictionary.decode(4), std::runtime_error);
+    // values are truncated like a StringField
+    std::string longValue(200, 'x');
+    int code = dictionary.encode(longValue);
+    EXPECT_EQ(dictionary.decode(code).size(), db::Types::STRING_LEN - 1);
+    EXPECT_EQ(dictionary.find(longValue), code);
+}
+
+TEST(StringDictionaryTest, reopen) {
+    std::remove("dictionary_reopen.dict");
+    {
+        db::StringDictionary dictionary("dictionary_reopen.dict");
+        for (int i = 0; i < 100; i++) {
+            EXPECT_EQ(dictionary.encode("value" + std::to_string(i)), i + 1);
+        }
+    }
+    struct stat st{};
+    ASSERT_EQ(stat("dictionary_reopen.dict", &st), 0);
+    off_t size = st.st_size;
+    {
+        // a record torn by a crash is dropped, and cut from the file
+        std::ofstream out("dictionary_reopen.dict", std::ios::binary | std::ios::app);
+        out.write("\x10\x00" "abc", 5);
+    }
+    db::StringDictionary dictionary("dictionary_reopen.dict");
+    EXPECT_EQ(dictionary.size(), 100);
+    ASSERT_EQ(stat("dictionary_reopen.dict", &st), 0);
+    EXPECT_EQ(st.st_size, size);
+    EXPECT_EQ(dictionary.decode(42), "value41");
+    EXPECT_EQ(dictionary.find("value99"), 100);
+    EXPECT_EQ(dictionary.encode("new"), 101);
+
+    db::StringDictionary reopened("dictionary_reopen.dict");
+    EXPECT_EQ(reopened.size(), 101);
+    EXPECT_EQ(reopened.decode(101), "new");
+}
+
+TEST(StringDictionaryTest, notADictionary) {
+    {
+        std::ofstream out("dictionary_other.dict", std::ios::binary | std::ios::trunc);
+        out << "something else";
+    }
+    // descriptors are allocated lowest first, a leaked one would be taken again
+    int free = dup(0);
+    close(free);
+    EXPECT_THROW(db::StringDictionary("dictionary_other.dict"), std::runtime_error);
+    int next = dup(0);
+    close(next);
+    EXPECT_EQ(next, free);
+    std::remove("dictionary_other.dict");
+}
@@ -0,0 +1,37 @@
+#ifndef TEST_TESTUTILITY_H
+#define TEST_TESTUTILITY_H
+
+#include <db/Database.h>
+#include <db/Tuple.h>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+namespace test {
+    /**
+     * Insert the rows [from, to) into table tableId in one transaction.
+     * @param setFields sets the fields of the tuple of row i
+     */
+    inline void insertRows(int tableId, int from, int to, const std::function<void(db::Tuple &, int)> &setFields) {
+        db::BufferPool &bufferPool = db::Database::getBufferPool();
+        const db::TupleDesc &td = db::Database::getCatalog().getTupleDesc(tableId);
+        db::TransactionId tid;
+        for (int i = from; i < to; i++) {
+            db::Tuple tuple(td);
+            setFields(tuple, i);
+            bufferPool.insertTuple(tid, tableId, &tuple);
+        }
+        bufferPool.transactionComplete(tid);
+    }
+
+    /**
+     * Remove the file fname, and the free space map and dictionary kept next to it.
+     */
+    inline void removeFile(const std::string &fname) {
+        std::remove(fname.c_str());
+        std::remove((fname + ".fsm").c_str());
+        std::remove((fname + ".dict").c_str());
+    }
+}
+
+#endif
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <db/HeapPage.h>
+#include <db/IntField.h>
+#include <db/Utility.h>
+#include <db/Vacuum.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include "TestUtility.h"
+
+/**
+ * Set the fields of row i to (i, 2 * i).
+ */
+static void setRow(db::Tuple &tuple, int i) {
+    tuple.setField(0, new db::IntField(i));
+    tuple.setField(1, new db::IntField(2 * i));
+}
+
+static int getKey(const db::Tuple &tuple) {
+    return dynamic_cast<const db::IntField &>(tuple.getField(0)).getValue();
+}
+
+TEST(VacuumTest, compact) {
+    db::Database::reset();
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    test::removeFile("vacuum.dat");
+    db::HeapFile file("vacuum.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    db::BufferPool &bufferPool = db::Database::getBufferPool();
+    int slotsPerPage = bufferPool.getPageSize() * 8 / (td.getSize() * 8 + 1);
+    test::insertRows(file.getId(), 0, 10 * slotsPerPage, setRow);
+    ASSERT_EQ(file.getNumPages(), 10);
+
+    // keep one row in ten, spread over every page
+    std::map<int, std::pair<int, int>> kept;
+    for (int pgNo = 0; pgNo < file.getNumPages(); pgNo++) {
+        db::TransactionId tid;
+        db::HeapPageId pid(file.getId(), pgNo);
+        auto *page = dynamic_cast<db::HeapPage *>(bufferPool.getPage(tid, &pid, db::Permissions::READ_WRITE));
+        std::vector<db::Tuple> deleted;
+        for (auto it = page->begin(); it != page->end(); ++it) {
+            if (getKey(*it) % 10 == 0) {
+                kept[getKey(*it)] = {pgNo, it.getSlot()};
+            } else {
+                deleted.push_back(*it);
+            }
+        }
+        for (db::Tuple &tuple: deleted) {
+            bufferPool.deleteTuple(tid, &tuple);
+        }
+        bufferPool.transactionComplete(tid);
+    }
+    ASSERT_EQ(kept.size(), slotsPerPage);
+
+    db::Vacuum vacuum(file);
+    std::map<std::pair<int, int>, std::pair<int, int>> relocated;
+    vacuum.setRelocationCallback([&](const db::RecordId &from, const db::RecordId &to) {
+        relocated[{from.getPageId()->pageNumber(), from.getTupleno()}] = {to.getPageId()->pageNumber(),
+                                                                          to.getTupleno()};
+    });
+    db::VacuumStats stats = vacuum.run();
+    EXPECT_EQ(stats.pagesBefore, 10);
+    EXPECT_EQ(stats.pagesAfter, 1);
+    EXPECT_EQ(file.getNumPages(), 1);
+    // the rows of the first page stay, the others move
+    EXPECT_EQ(stats.tuplesMoved, slotsPerPage - (slotsPerPage + 9) / 10);
+    EXPECT_EQ(relocated.size(), stats.tuplesMoved);
+    struct stat st{};
+    ASSERT_EQ(stat("vacuum.dat", &st), 0);
+    EXPECT_EQ(st.st_size, bufferPool.getPageSize());
+
+    // every row is where the callback said
+    db::HeapPageId first(file.getId(), 0);
+    auto *page = dynamic_cast<db::HeapPage *>(bufferPool.getPage(&first));
+    EXPECT_EQ(page->getNumEmptySlots(), 0);
+    for (const auto &[key, location]: kept) {
+        auto it = relocated.find(location);
+        std::pair<int, int> now = it == relocated.end() ? location : it->second;
+        ASSERT_EQ(now.first, 0);
+        EXPECT_EQ(page->getInt(now.second, 0), key);
+        EXPECT_EQ(page->getInt(now.second, 1), 2 * key);
+    }
+
+    // the free space map forgot the removed pages, the file grows again from its new end
+    test::insertRows(file.getId(), 0, 10, setRow);
+    EXPECT_EQ(file.getNumPages(), 2);
+    std::set<int> keys;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        keys.insert(getKey(*it));
+    }
+    EXPECT_EQ(keys.size(), slotsPerPage + 9);
+}
+
+TEST(VacuumTest, nothingToDo) {
+    db::Database::reset();
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    test::removeFile("vacuum_dense.dat");
+    db::HeapFile file("vacuum_dense.dat", td);
+    db::Database::getCatalog().addTable(&file);
+    EXPECT_EQ(db::Vacuum(file).run().pagesAfter, 0);
+    test::insertRows(file.getId(), 0, 1000, setRow);
+    int numPages = file.getNumPages();
+    db::VacuumStats stats = db::Vacuum(file).run();
+    EXPECT_EQ(stats.tuplesMoved, 0);
+    EXPECT_EQ(stats.pagesAfter, numPages);
+}
+
+TEST(VacuumTest, mappedFile) {
+    db::Database::reset();
+    db::TupleDesc td = db::Utility::getTupleDesc(2);
+    test::removeFile("vacuum_mapped.dat");
+    {
+        db::HeapFile file("vacuum_mapped.dat", td);
+        db::Database::getCatalog().addTable(&file);
+        test::insertRows(file.getId(), 0, 1000, setRow);
+        db::Database::getBufferPool().flushAllPages();
+    }
+    db::Database::reset();
+    db::HeapFile file("vacuum_mapped.dat", td, db::IoBackendType::MMAP);
+    db::Database::getCatalog().addTable(&file);
+    ASSERT_TRUE(file.isMapped());
+    int numPages = file.getNumPages();
+    ASSERT_GT(numPages, 1);
+
+    // empty the first page, the tuples of the last one would be moved there
+    db::BufferPool &bufferPool = db::Database::getBufferPool();
+    db::TransactionId tid;
+    db::HeapPageId pid(file.getId(), 0);
+    std::vector<db::Tuple> deleted;
+    {
+        db::PageGuard guard = bufferPool.fetchPage(tid, &pid, db::Permissions::READ_WRITE);
+        for (const db::Tuple &tuple: *guard.as<db::HeapPage>()) {
+            deleted.push_back(tuple);
+        }
+    }
+    for (db::Tuple &tuple: deleted) {
+        bufferPool.deleteTuple(tid, &tuple);
+    }
+    bufferPool.transactionComplete(tid);
+
+    // refused before any tuple is moved
+    EXPECT_THROW(db::Vacuum(file).run(), std::runtime_error);
+    EXPECT_EQ(file.getNumPages(), numPages);
+    db::HeapPageId last(file.getId(), numPages - 1);
+    db::PageGuard guard = bufferPool.fetchPage(&last);
+    const auto *page = guard.as<db::HeapPage>();
+    EXPECT_EQ(page->getNumTuples() - page->getNumEmptySlots(), 1000 - (numPages - 1) * page->getNumTuples());
+}
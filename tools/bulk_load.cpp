@@ -0,0 +1,91 @@
+#include <db/BulkLoader.h>
+#include <db/Database.h>
+#include <db/HeapFile.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+/**
+ * Append the rows of a CSV or binary file to a heap file.
+ *
+ *   bulk_load [-f csv|binary] [-t threads] [-c chunk MB] <table file> <input file> <types>
+ *
+ * types lists the types of the fields, e.g. int,int,string. The input is split in chunks
+ * parsed by threads workers, one per hardware thread by default.
+ */
+
+namespace {
+    void usage() {
+        fprintf(stderr, "usage: bulk_load [-f csv|binary] [-t threads] [-c chunk MB] <table file> <input file> <types>\n");
+        exit(2);
+    }
+
+    std::vector<db::Types::Type> parseTypes(const std::string &types) {
+        std::vector<db::Types::Type> parsed;
+        size_t first = 0;
+        while (first <= types.size()) {
+            size_t last = std::min(types.find(',', first), types.size());
+            std::string type = types.substr(first, last - first);
+            if (type == "int") {
+                parsed.push_back(db::Types::INT_TYPE);
+            } else if (type == "string") {
+                parsed.push_back(db::Types::STRING_TYPE);
+            } else {
+                fprintf(stderr, "unknown type '%s'\n", type.c_str());
+                usage();
+            }
+            first = last + 1;
+        }
+        return parsed;
+    }
+}
+
+int main(int argc, char **argv) {
+    db::BulkFormat format = db::BulkFormat::CSV;
+    int threads = 0;
+    size_t chunkSize = db::BulkLoader::DEFAULT_CHUNK_SIZE;
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+        if (strcmp(argv[arg], "-f") == 0 && strcmp(argv[arg + 1], "csv") == 0) {
+            format = db::BulkFormat::CSV;
+        } else if (strcmp(argv[arg], "-f") == 0 && strcmp(argv[arg + 1], "binary") == 0) {
+            format = db::BulkFormat::BINARY;
+        } else if (strcmp(argv[arg], "-t") == 0) {
+            threads = atoi(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "-c") == 0) {
+            chunkSize = static_cast<size_t>(atol(argv[arg + 1])) << 20;
+        } else {
+            usage();
+        }
+    }
+    if (argc - arg != 3) {
+        usage();
+    }
+
+    db::TupleDesc td(parseTypes(argv[arg + 2]));
+    db::HeapFile file(argv[arg], td);
+    db::Database::getCatalog().addTable(&file);
+    db::BulkLoader loader(file, format, threads);
+    loader.setChunkSize(chunkSize);
+
+    struct stat st{};
+    stat(argv[arg + 1], &st);
+    auto start = std::chrono::steady_clock::now();
+    db::BulkLoadStats stats;
+    try {
+        stats = loader.load(argv[arg + 1]);
+    } catch (const std::exception &e) {
+        fprintf(stderr, "bulk_load: %s\n", e.what());
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double written = static_cast<double>(stats.pages) * db::Database::getBufferPool().getPageSize();
+    printf("%ld rows, %d pages in %.2f s: %.1f MB/s read, %.1f MB/s written\n", stats.rows, stats.pages, seconds,
+           st.st_size / seconds / 1e6, written / seconds / 1e6);
+    return 0;
+}